@@ -0,0 +1,394 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "codegen.h"
+
+#include <clog/clog.h>
+#include <flood/out_stream.h>
+#include <stdarg.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+/// A pointer inside a baked memory block, pointing to another emitted symbol.
+typedef struct BakeSlot {
+    size_t offset;
+    int symbolIndex;
+} BakeSlot;
+
+/// The inline memory of a value (or of all list items), with the pointers kept apart from the octets.
+typedef struct BakeImage {
+    uint8_t* octets;
+    size_t octetCount;
+    size_t align;
+    BakeSlot* slots;
+    size_t slotCount;
+    size_t slotCapacity;
+} BakeImage;
+
+typedef struct Bake {
+    FldOutStream* out;
+    const char* symbolName;
+    int symbolCount;
+    int writeError;
+} Bake;
+
+/// A failed write is remembered, so an output buffer that is too small fails the bake instead of truncating it.
+static void writef(Bake* self, const char* format, ...)
+{
+    va_list pl;
+
+    va_start(pl, format);
+    if (fldOutStreamWritevf(self->out, format, pl) < 0) {
+        self->writeError = -1;
+    }
+    va_end(pl);
+}
+
+static void writeOctets(Bake* self, const uint8_t* octets, size_t count)
+{
+    if (fldOutStreamWriteOctets(self->out, octets, count) < 0) {
+        self->writeError = -1;
+    }
+}
+
+static void writeOctet(Bake* self, uint8_t octet)
+{
+    writeOctets(self, &octet, 1);
+}
+
+static int bakeRegion(Bake* self, BakeImage* image, const uint8_t* v, size_t offset, const SwtiType* type);
+
+static void bakeImageInit(BakeImage* self, size_t octetCount, size_t align)
+{
+    self->octetCount = octetCount;
+    self->octets = tc_malloc(octetCount == 0 ? 1 : octetCount);
+    tc_mem_clear(self->octets, octetCount);
+    self->align = align;
+    self->slotCount = 0;
+    self->slotCapacity = 8;
+    self->slots = tc_malloc_type_count(BakeSlot, self->slotCapacity);
+}
+
+static void bakeImageDestroy(BakeImage* self)
+{
+    tc_free(self->octets);
+    tc_free(self->slots);
+}
+
+static void bakeImageAddSlot(BakeImage* self, size_t offset, int symbolIndex)
+{
+    if (self->slotCount == self->slotCapacity) {
+        self->slotCapacity *= 2;
+        self->slots = tc_realloc(self->slots, sizeof(BakeSlot) * self->slotCapacity);
+    }
+
+    // Fields are visited in declaration order, which is not necessarily memory order
+    size_t insertAt = self->slotCount;
+    while (insertAt > 0 && self->slots[insertAt - 1].offset > offset) {
+        self->slots[insertAt] = self->slots[insertAt - 1];
+        insertAt--;
+    }
+    self->slots[insertAt].offset = offset;
+    self->slots[insertAt].symbolIndex = symbolIndex;
+    self->slotCount++;
+}
+
+static void writeOctetList(Bake* self, const uint8_t* octets, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if ((i % 16) == 0) {
+            writeOctets(self, (const uint8_t*) "\n    ", 5);
+        }
+        writef(self, "0x%02X,", octets[i]);
+    }
+}
+
+static void writeStringLiteral(Bake* self, const char* characters, size_t count)
+{
+    writeOctet(self, '"');
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t ch = (uint8_t) characters[i];
+        if (ch == '"' || ch == '\\') {
+            writeOctet(self, '\\');
+            writeOctet(self, ch);
+        } else if (ch < 32 || ch > 126) {
+            // Octal escapes never swallow a following hex digit, unlike \x
+            writef(self, "\\%03o", ch);
+        } else {
+            writeOctet(self, ch);
+        }
+    }
+    writeOctet(self, '"');
+}
+
+static void writeImage(Bake* self, const BakeImage* image, int symbolIndex, const char* suffix)
+{
+    size_t align = image->align;
+    if (image->slotCount > 0 && align < sizeof(void*)) {
+        align = sizeof(void*);
+    }
+
+    writef(self, "static const struct %s_%d%s_layout {\n", self->symbolName, symbolIndex, suffix);
+    size_t pos = 0;
+    for (size_t i = 0; i <= image->slotCount; ++i) {
+        size_t runEnd = i < image->slotCount ? image->slots[i].offset : image->octetCount;
+        if (runEnd > pos) {
+            writef(self, "    uint8_t o%zu[%zu];\n", pos, runEnd - pos);
+        }
+        if (i < image->slotCount) {
+            writef(self, "    const void* p%zu;\n", runEnd);
+            pos = runEnd + sizeof(void*);
+        }
+    }
+    if (image->octetCount == 0) {
+        writef(self, "    uint8_t empty;\n");
+    }
+    writef(self, "} __attribute__((aligned(%zu))) %s_%d%s = {", align, self->symbolName, symbolIndex, suffix);
+
+    pos = 0;
+    for (size_t i = 0; i <= image->slotCount; ++i) {
+        size_t runEnd = i < image->slotCount ? image->slots[i].offset : image->octetCount;
+        if (runEnd > pos) {
+            writef(self, "\n    {");
+            writeOctetList(self, image->octets + pos, runEnd - pos);
+            writef(self, "\n    },");
+        }
+        if (i < image->slotCount) {
+            writef(self, "\n    &%s_%d,", self->symbolName, image->slots[i].symbolIndex);
+            pos = runEnd + sizeof(void*);
+        }
+    }
+    if (image->octetCount == 0) {
+        writef(self, "0");
+    }
+    writef(self, "\n};\n");
+
+    // Fails to compile if the compiler would lay out the struct differently than the runtime expects
+    writef(self, "typedef char %s_%d%s_layout_check[sizeof(%s_%d%s) == %zu", self->symbolName, symbolIndex, suffix,
+           self->symbolName, symbolIndex, suffix, image->octetCount == 0 ? 1 : image->octetCount);
+    pos = 0;
+    for (size_t i = 0; i <= image->slotCount; ++i) {
+        size_t runEnd = i < image->slotCount ? image->slots[i].offset : image->octetCount;
+        if (runEnd > pos) {
+            writef(self, " && offsetof(struct %s_%d%s_layout, o%zu) == %zu", self->symbolName, symbolIndex, suffix,
+                   pos, pos);
+        }
+        if (i < image->slotCount) {
+            writef(self, " && offsetof(struct %s_%d%s_layout, p%zu) == %zu", self->symbolName, symbolIndex, suffix,
+                   runEnd, runEnd);
+            pos = runEnd + sizeof(void*);
+        }
+    }
+    writef(self, " ? 1 : -1];\n\n");
+}
+
+static int bakeString(Bake* self, const SwampString* string)
+{
+    int symbolIndex = self->symbolCount++;
+
+    writef(self, "static const char %s_%d_characters[] = ", self->symbolName, symbolIndex);
+    writeStringLiteral(self, string->characters, string->characterCount);
+    writef(self, ";\n");
+    writef(self, "static const SwampString %s_%d = {.characters = %s_%d_characters, .characterCount = %zu};\n\n",
+           self->symbolName, symbolIndex, self->symbolName, symbolIndex, string->characterCount);
+
+    return symbolIndex;
+}
+
+static int bakeBlob(Bake* self, const SwampBlob* blob)
+{
+    int symbolIndex = self->symbolCount++;
+
+    if (blob->octetCount > 0) {
+        writef(self, "static const uint8_t %s_%d_octets[] = {", self->symbolName, symbolIndex);
+        writeOctetList(self, blob->octets, blob->octetCount);
+        writef(self, "\n};\n");
+        writef(self, "static const SwampBlob %s_%d = {.octets = %s_%d_octets, .octetCount = %zu};\n\n",
+               self->symbolName, symbolIndex, self->symbolName, symbolIndex, blob->octetCount);
+    } else {
+        writef(self, "static const SwampBlob %s_%d = {.octets = 0, .octetCount = 0};\n\n", self->symbolName,
+               symbolIndex);
+    }
+
+    return symbolIndex;
+}
+
+static int bakeList(Bake* self, const SwampList* list, const SwtiType* itemType, SwtiMemoryInfo itemInfo,
+                    const char* collectionName)
+{
+    int symbolIndex = self->symbolCount++;
+
+    if (list->count > 0) {
+        BakeImage items;
+        bakeImageInit(&items, list->count * list->itemSize, itemInfo.memoryAlign);
+        for (size_t i = 0; i < list->count; ++i) {
+            int errorCode = bakeRegion(self, &items, (const uint8_t*) list->value + i * list->itemSize,
+                                       i * list->itemSize, itemType);
+            if (errorCode < 0) {
+                bakeImageDestroy(&items);
+                return errorCode;
+            }
+        }
+        writeImage(self, &items, symbolIndex, "_items");
+        bakeImageDestroy(&items);
+
+        writef(self,
+               "static const Swamp%s %s_%d = {.count = %zu, .itemSize = %zu, .itemAlign = %zu, .value = &%s_%d_items};"
+               "\n\n",
+               collectionName, self->symbolName, symbolIndex, list->count, list->itemSize,
+               (size_t) itemInfo.memoryAlign, self->symbolName, symbolIndex);
+    } else {
+        writef(self, "static const Swamp%s %s_%d = {.count = 0, .itemSize = %zu, .itemAlign = %zu, .value = 0};\n\n",
+               collectionName, self->symbolName, symbolIndex, (size_t) itemInfo.memorySize,
+               (size_t) itemInfo.memoryAlign);
+    }
+
+    return symbolIndex;
+}
+
+static int bakeRegion(Bake* self, BakeImage* image, const uint8_t* v, size_t offset, const SwtiType* type)
+{
+    switch (type->type) {
+        case SwtiTypeBoolean:
+            tc_memcpy_octets(image->octets + offset, v, sizeof(SwampBool));
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+        case SwtiTypeChar:
+            tc_memcpy_octets(image->octets + offset, v, sizeof(SwampInt32));
+            break;
+        case SwtiTypeRecord: {
+            const SwtiRecordType* record = (const SwtiRecordType*) type;
+            for (size_t i = 0; i < record->fieldCount; ++i) {
+                const SwtiRecordTypeField* field = &record->fields[i];
+                size_t fieldOffset = field->memoryOffsetInfo.memoryOffset;
+                int errorCode = bakeRegion(self, image, v + fieldOffset, offset + fieldOffset, field->fieldType);
+                if (errorCode < 0) {
+                    return errorCode;
+                }
+            }
+        } break;
+        case SwtiTypeTuple: {
+            const SwtiTupleType* tuple = (const SwtiTupleType*) type;
+            for (size_t i = 0; i < tuple->fieldCount; ++i) {
+                const SwtiTupleTypeField* field = &tuple->fields[i];
+                size_t fieldOffset = field->memoryOffsetInfo.memoryOffset;
+                int errorCode = bakeRegion(self, image, v + fieldOffset, offset + fieldOffset, field->fieldType);
+                if (errorCode < 0) {
+                    return errorCode;
+                }
+            }
+        } break;
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            uint8_t variantIndex = *v;
+            if (variantIndex >= custom->variantCount) {
+                CLOG_SOFT_ERROR("bake: illegal variant index %d", variantIndex)
+                return -2;
+            }
+            image->octets[offset] = variantIndex;
+            const SwtiCustomTypeVariant* variant = custom->variantTypes[variantIndex];
+            for (size_t i = 0; i < variant->paramCount; ++i) {
+                const SwtiCustomTypeVariantField* field = &variant->fields[i];
+                size_t fieldOffset = field->memoryOffsetInfo.memoryOffset;
+                int errorCode = bakeRegion(self, image, v + fieldOffset, offset + fieldOffset, field->fieldType);
+                if (errorCode < 0) {
+                    return errorCode;
+                }
+            }
+        } break;
+        case SwtiTypeAlias:
+            return bakeRegion(self, image, v, offset, ((const SwtiAliasType*) type)->targetType);
+        case SwtiTypeString:
+            bakeImageAddSlot(image, offset, bakeString(self, *(const SwampString**) v));
+            break;
+        case SwtiTypeBlob:
+            bakeImageAddSlot(image, offset, bakeBlob(self, *(const SwampBlob**) v));
+            break;
+        case SwtiTypeList: {
+            const SwtiListType* listType = (const SwtiListType*) type;
+            int symbolIndex = bakeList(self, *(const SwampList**) v, listType->itemType, listType->memoryInfo, "List");
+            if (symbolIndex < 0) {
+                return symbolIndex;
+            }
+            bakeImageAddSlot(image, offset, symbolIndex);
+        } break;
+        case SwtiTypeArray: {
+            const SwtiArrayType* arrayType = (const SwtiArrayType*) type;
+            int symbolIndex = bakeList(self, *(const SwampList**) v, arrayType->itemType, arrayType->memoryInfo,
+                                       "Array");
+            if (symbolIndex < 0) {
+                return symbolIndex;
+            }
+            bakeImageAddSlot(image, offset, symbolIndex);
+        } break;
+        default:
+            CLOG_SOFT_ERROR("bake: type %d can not be baked into a constant", type->type)
+            return -1;
+    }
+
+    return 0;
+}
+
+static size_t memoryAlign(const SwtiType* type)
+{
+    switch (type->type) {
+        case SwtiTypeBoolean:
+            return sizeof(SwampBool);
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+        case SwtiTypeChar:
+            return sizeof(SwampInt32);
+        case SwtiTypeRecord:
+            return ((const SwtiRecordType*) type)->memoryInfo.memoryAlign;
+        case SwtiTypeTuple:
+            return ((const SwtiTupleType*) type)->memoryInfo.memoryAlign;
+        case SwtiTypeCustom:
+            return ((const SwtiCustomType*) type)->memoryInfo.memoryAlign;
+        case SwtiTypeAlias:
+            return memoryAlign(((const SwtiAliasType*) type)->targetType);
+        default:
+            return sizeof(void*);
+    }
+}
+
+int swampDumpCodegenBake(FldOutStream* out, const void* v, const SwtiType* type, const char* symbolName)
+{
+    Bake self;
+    self.out = out;
+    self.symbolName = symbolName;
+    self.symbolCount = 0;
+    self.writeError = 0;
+
+    writef(&self, "// Generated by swamp_dump_codegen. Do not edit.\n");
+    writef(&self, "// Memory layout of '%s' for a %zu-bit, host-endian target.\n", type->name ? type->name : "",
+           sizeof(void*) * 8);
+    writef(&self, "#include <stddef.h>\n");
+    writef(&self, "#include <stdint.h>\n");
+    writef(&self, "#include <swamp-runtime/types.h>\n\n");
+
+    BakeImage root;
+    bakeImageInit(&root, swtiGetMemorySize(type), memoryAlign(type));
+    int errorCode = bakeRegion(&self, &root, (const uint8_t*) v, 0, type);
+    if (errorCode < 0) {
+        bakeImageDestroy(&root);
+        return errorCode;
+    }
+
+    int rootIndex = self.symbolCount++;
+    writeImage(&self, &root, rootIndex, "");
+    bakeImageDestroy(&root);
+
+    writef(&self, "// extern const void* const %s;\n", symbolName);
+    writef(&self, "const void* const %s = &%s_%d;\n", symbolName, symbolName, rootIndex);
+    if (self.writeError < 0) {
+        CLOG_SOFT_ERROR("bake: '%s' does not fit in %zu octets", symbolName, out->size)
+        return self.writeError;
+    }
+
+    return 0;
+}
@@ -0,0 +1,778 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "codegen.h"
+
+#include <clog/clog.h>
+#include <flood/out_stream.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+typedef struct Codegen {
+    FldOutStream* out;
+    const SwtiChunk* chunk;
+    const char* prefix;
+    int indentation;
+    size_t constantOctetCount;
+    int writeError;
+} Codegen;
+
+/// A failed write is remembered, so an output buffer that is too small fails the generation instead of truncating it.
+static void emit(Codegen* self, const char* format, ...)
+{
+    va_list pl;
+
+    for (int i = 0; i < self->indentation; ++i) {
+        if (fldOutStreamWriteOctets(self->out, (const uint8_t*) "    ", 4) < 0) {
+            self->writeError = -1;
+        }
+    }
+
+    va_start(pl, format);
+    if (fldOutStreamWritevf(self->out, format, pl) < 0) {
+        self->writeError = -1;
+    }
+    va_end(pl);
+
+    if (fldOutStreamWriteUInt8(self->out, '\n') < 0) {
+        self->writeError = -1;
+    }
+}
+
+/// Emits a stream write, and a return of -1 when it fails.
+static void emitWrite(Codegen* self, const char* format, ...)
+{
+    char call[256];
+    va_list pl;
+
+    va_start(pl, format);
+    vsnprintf(call, sizeof(call), format, pl);
+    va_end(pl);
+
+    emit(self, "if (%s < 0) {", call);
+    emit(self, "    return -1;");
+    emit(self, "}");
+}
+
+static int checkWriteError(const Codegen* self, const char* what)
+{
+    if (self->writeError < 0) {
+        CLOG_SOFT_ERROR("codegen: the %s for '%s' does not fit in %zu octets", what, self->prefix, self->out->size)
+        return self->writeError;
+    }
+
+    return 0;
+}
+
+static void openBlock(Codegen* self)
+{
+    emit(self, "{");
+    self->indentation++;
+}
+
+static void closeBlock(Codegen* self)
+{
+    self->indentation--;
+    emit(self, "}");
+}
+
+static int typeIndex(const Codegen* self, const SwtiType* type)
+{
+    for (size_t i = 0; i < self->chunk->typeCount; ++i) {
+        if (self->chunk->types[i] == type) {
+            return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+static int isSerializable(const SwtiType* type)
+{
+    switch (type->type) {
+        case SwtiTypeBoolean:
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+        case SwtiTypeString:
+        case SwtiTypeRecord:
+        case SwtiTypeTuple:
+        case SwtiTypeList:
+        case SwtiTypeArray:
+        case SwtiTypeCustom:
+        case SwtiTypeBlob:
+        case SwtiTypeUnmanaged:
+            return 1;
+        case SwtiTypeAlias:
+            return isSerializable(((const SwtiAliasType*) type)->targetType);
+        default:
+            return 0;
+    }
+}
+
+static int isIdentifier(const char* name)
+{
+    if (name == 0 || name[0] == 0) {
+        return 0;
+    }
+
+    for (const char* p = name; *p; ++p) {
+        char ch = *p;
+        int isAlpha = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_';
+        int isNumber = ch >= '0' && ch <= '9';
+        if (!isAlpha && !(isNumber && p != name)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/// Uses the type name when it is unique within the chunk, otherwise falls back to the chunk index.
+static const char* publicName(const Codegen* self, int index)
+{
+    static char buf[128];
+    const char* name = self->chunk->types[index]->name;
+
+    int isUnique = isIdentifier(name);
+    for (size_t i = 0; isUnique && i < self->chunk->typeCount; ++i) {
+        const char* otherName = self->chunk->types[i]->name;
+        if ((int) i != index && otherName != 0 && tc_str_equal(otherName, name)) {
+            isUnique = 0;
+        }
+    }
+
+    if (isUnique) {
+        snprintf(buf, sizeof(buf), "%s", name);
+    } else {
+        snprintf(buf, sizeof(buf), "Type%d", index);
+    }
+
+    return buf;
+}
+
+/// Returns the encoded size if it never depends on the value, otherwise -1.
+static int fixedOctetSize(const SwtiType* type)
+{
+    size_t octetCount;
+
+    return swampDumpFixedOctetCount(type, &octetCount) ? (int) octetCount : -1;
+}
+
+/// Lists and custom types call into the functions generated for their item and variant types.
+static int canCall(const Codegen* self, const SwtiType* type)
+{
+    if (isSerializable(type) && typeIndex(self, type) >= 0) {
+        return 1;
+    }
+
+    emit((Codegen*) self, "return -1; // type '%s' is not serializable or not part of the chunk",
+         type->name ? type->name : "");
+
+    return 0;
+}
+
+static void emitEncode(Codegen* self, const SwtiType* type, size_t offset)
+{
+    switch (type->type) {
+        case SwtiTypeBoolean:
+            emitWrite(self, "fldOutStreamWriteUInt8(stream, *(const SwampBool*) (v + %zu))", offset);
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            emitWrite(self, "fldOutStreamWriteInt32(stream, *(const SwampInt32*) (v + %zu))", offset);
+            break;
+        case SwtiTypeString:
+            openBlock(self);
+            emit(self, "const SwampString* p = *(const SwampString**) (v + %zu);", offset);
+            emitWrite(self, "fldOutStreamWriteUInt8(stream, (uint8_t) (p->characterCount + 1))");
+            emitWrite(self, "fldOutStreamWriteOctets(stream, (const uint8_t*) p->characters, p->characterCount + 1)");
+            closeBlock(self);
+            break;
+        case SwtiTypeRecord: {
+            const SwtiRecordType* record = (const SwtiRecordType*) type;
+            for (size_t i = 0; i < record->fieldCount; ++i) {
+                const SwtiRecordTypeField* field = &record->fields[i];
+                emitEncode(self, field->fieldType, offset + field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeTuple: {
+            const SwtiTupleType* tuple = (const SwtiTupleType*) type;
+            for (size_t i = 0; i < tuple->fieldCount; ++i) {
+                const SwtiTupleTypeField* field = &tuple->fields[i];
+                emitEncode(self, field->fieldType, offset + field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeAlias:
+            emitEncode(self, ((const SwtiAliasType*) type)->targetType, offset);
+            break;
+        case SwtiTypeList:
+        case SwtiTypeArray: {
+            const SwtiType* itemType = type->type == SwtiTypeList ? ((const SwtiListType*) type)->itemType
+                                                                   : ((const SwtiArrayType*) type)->itemType;
+            if (!canCall(self, itemType)) {
+                break;
+            }
+            openBlock(self);
+            emit(self, "const SwampList* list = *(const SwampList**) (v + %zu);", offset);
+            emitWrite(self, "fldOutStreamWriteUInt8(stream, (uint8_t) list->count)");
+            emit(self, "for (size_t i = 0; i < list->count; ++i) {");
+            emit(self, "    int errorCode = %sEncode%d(stream, (const uint8_t*) list->value + i * list->itemSize);",
+                 self->prefix, typeIndex(self, itemType));
+            emit(self, "    if (errorCode < 0) {");
+            emit(self, "        return errorCode;");
+            emit(self, "    }");
+            emit(self, "}");
+            closeBlock(self);
+        } break;
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            if (!canCall(self, type)) {
+                break;
+            }
+            openBlock(self);
+            emit(self, "const uint8_t variantIndex = *(v + %zu);", offset);
+            emit(self, "if (variantIndex >= %zu) {", custom->variantCount);
+            emit(self, "    return -1;");
+            emit(self, "}");
+            emit(self, "int errorCode = %sEncodeVariants%d[variantIndex](stream, v + %zu);", self->prefix,
+                 typeIndex(self, type), offset);
+            emit(self, "if (errorCode < 0) {");
+            emit(self, "    return errorCode;");
+            emit(self, "}");
+            closeBlock(self);
+        } break;
+        case SwtiTypeBlob:
+            openBlock(self);
+            emit(self, "const SwampBlob* blob = *(const SwampBlob**) (v + %zu);", offset);
+            emitWrite(self, "fldOutStreamWriteUInt32(stream, (uint32_t) blob->octetCount)");
+            emitWrite(self, "fldOutStreamWriteOctets(stream, blob->octets, blob->octetCount)");
+            closeBlock(self);
+            break;
+        case SwtiTypeUnmanaged:
+            openBlock(self);
+            emit(self, "const SwampUnmanaged* unmanagedValue = *(const SwampUnmanaged**) (v + %zu);", offset);
+            emit(self, "int serializeErr = unmanagedValue->serialize(unmanagedValue->ptr, stream->p, stream->size - "
+                       "stream->pos);");
+            emit(self, "if (serializeErr < 0) {");
+            emit(self, "    return serializeErr;");
+            emit(self, "}");
+            emit(self, "stream->p += serializeErr;");
+            emit(self, "stream->pos += serializeErr;");
+            closeBlock(self);
+            break;
+        default:
+            emit(self, "return -1; // type %d can not be serialized", type->type);
+            break;
+    }
+}
+
+static void emitDecode(Codegen* self, const SwtiType* type, size_t offset)
+{
+    switch (type->type) {
+        case SwtiTypeBoolean:
+            emit(self, "if (fldInStreamReadOctets(inStream, target + %zu, sizeof(SwampBool)) < 0) {", offset);
+            emit(self, "    return -1;");
+            emit(self, "}");
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            emit(self, "if (fldInStreamReadInt32(inStream, (SwampInt32*) (target + %zu)) < 0) {", offset);
+            emit(self, "    return -1;");
+            emit(self, "}");
+            break;
+        case SwtiTypeString:
+            openBlock(self);
+            emit(self, "uint8_t stringLengthIncludingTerminator;");
+            emit(self, "int errorCode = fldInStreamReadUInt8(inStream, &stringLengthIncludingTerminator);");
+            emit(self, "if (errorCode < 0) {");
+            emit(self, "    return errorCode;");
+            emit(self, "}");
+            emit(self, "if (stringLengthIncludingTerminator == 0 || stringLengthIncludingTerminator > inStream->size - "
+                       "inStream->pos) {");
+            emit(self, "    return -1;");
+            emit(self, "}");
+            emit(self, "*(const SwampString**) (target + %zu) = swampStringAllocateWithSize(memory, (const char*) "
+                       "inStream->p, stringLengthIncludingTerminator - 1);",
+                 offset);
+            emit(self, "inStream->p += stringLengthIncludingTerminator;");
+            emit(self, "inStream->pos += stringLengthIncludingTerminator;");
+            closeBlock(self);
+            break;
+        case SwtiTypeRecord: {
+            const SwtiRecordType* record = (const SwtiRecordType*) type;
+            for (size_t i = 0; i < record->fieldCount; ++i) {
+                const SwtiRecordTypeField* field = &record->fields[i];
+                emitDecode(self, field->fieldType, offset + field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeTuple: {
+            const SwtiTupleType* tuple = (const SwtiTupleType*) type;
+            for (size_t i = 0; i < tuple->fieldCount; ++i) {
+                const SwtiTupleTypeField* field = &tuple->fields[i];
+                emitDecode(self, field->fieldType, offset + field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeAlias:
+            emitDecode(self, ((const SwtiAliasType*) type)->targetType, offset);
+            break;
+        case SwtiTypeList:
+        case SwtiTypeArray: {
+            int isList = type->type == SwtiTypeList;
+            const SwtiType* itemType = isList ? ((const SwtiListType*) type)->itemType
+                                              : ((const SwtiArrayType*) type)->itemType;
+            SwtiMemoryInfo itemInfo = isList ? ((const SwtiListType*) type)->memoryInfo
+                                             : ((const SwtiArrayType*) type)->memoryInfo;
+            const char* collectionName = isList ? "List" : "Array";
+            if (!canCall(self, itemType)) {
+                break;
+            }
+            openBlock(self);
+            emit(self, "uint8_t listLength;");
+            emit(self, "if (fldInStreamReadUInt8(inStream, &listLength) < 0) {");
+            emit(self, "    return -1;");
+            emit(self, "}");
+            emit(self, "Swamp%s* list = swamp%sAllocatePrepare(memory, listLength, %d, %d);", collectionName,
+                 collectionName, itemInfo.memorySize, itemInfo.memoryAlign);
+            emit(self, "for (size_t i = 0; i < listLength; ++i) {");
+            emit(self, "    int errorCode = %sDecode%d(inStream, creator, context, (uint8_t*) list->value + i * "
+                       "list->itemSize, memory, targetUnmanagedMemory);",
+                 self->prefix, typeIndex(self, itemType));
+            emit(self, "    if (errorCode < 0) {");
+            emit(self, "        return errorCode;");
+            emit(self, "    }");
+            emit(self, "}");
+            emit(self, "*(const Swamp%s**) (target + %zu) = list;", collectionName, offset);
+            closeBlock(self);
+        } break;
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            if (!canCall(self, type)) {
+                break;
+            }
+            openBlock(self);
+            emit(self, "uint8_t variantIndex;");
+            emit(self, "if (fldInStreamReadUInt8(inStream, &variantIndex) < 0 || variantIndex >= %zu) {",
+                 custom->variantCount);
+            emit(self, "    return -1;");
+            emit(self, "}");
+            emit(self, "*(target + %zu) = variantIndex;", offset);
+            emit(self,
+                 "int errorCode = %sDecodeVariants%d[variantIndex](inStream, creator, context, target + %zu, memory, "
+                 "targetUnmanagedMemory);",
+                 self->prefix, typeIndex(self, type), offset);
+            emit(self, "if (errorCode < 0) {");
+            emit(self, "    return errorCode;");
+            emit(self, "}");
+            closeBlock(self);
+        } break;
+        case SwtiTypeBlob:
+            openBlock(self);
+            emit(self, "uint32_t octetCount;");
+            emit(self, "int errorCode = fldInStreamReadUInt32(inStream, &octetCount);");
+            emit(self, "if (errorCode < 0) {");
+            emit(self, "    return errorCode;");
+            emit(self, "}");
+            emit(self, "if (octetCount > inStream->size - inStream->pos) {");
+            emit(self, "    return -1;");
+            emit(self, "}");
+            emit(self, "*(const SwampBlob**) (target + %zu) = swampBlobAllocate(memory, octetCount == 0 ? 0 : "
+                       "inStream->p, octetCount);",
+                 offset);
+            emit(self, "inStream->p += octetCount;");
+            emit(self, "inStream->pos += octetCount;");
+            closeBlock(self);
+            break;
+        case SwtiTypeUnmanaged:
+            openBlock(self);
+            emit(self, "if (creator == 0) {");
+            emit(self, "    return -2;");
+            emit(self, "}");
+            emit(self, "SwampUnmanaged* unmanagedValue = swampUnmanagedMemoryAllocate(targetUnmanagedMemory, "
+                       "%sUnmanaged%d.internal.name);",
+                 self->prefix, typeIndex(self, type));
+            emit(self, "creator(context, &%sUnmanaged%d, unmanagedValue);", self->prefix, typeIndex(self, type));
+            emit(self, "int errorCode = unmanagedValue->deSerialize(unmanagedValue->ptr, inStream->p, inStream->size "
+                       "- inStream->pos);");
+            emit(self, "if (errorCode < 0) {");
+            emit(self, "    return errorCode;");
+            emit(self, "}");
+            emit(self, "inStream->p += errorCode;");
+            emit(self, "inStream->pos += errorCode;");
+            emit(self, "*(const SwampUnmanaged**) (target + %zu) = unmanagedValue;", offset);
+            closeBlock(self);
+            break;
+        default:
+            emit(self, "return -1; // type %d can not be serialized", type->type);
+            break;
+    }
+}
+
+/// Folds everything that does not depend on the value into constantOctetCount.
+static void emitMeasure(Codegen* self, const SwtiType* type, size_t offset)
+{
+    int fixedSize = fixedOctetSize(type);
+    if (fixedSize >= 0) {
+        self->constantOctetCount += fixedSize;
+        return;
+    }
+
+    switch (type->type) {
+        case SwtiTypeString:
+            self->constantOctetCount += 1;
+            emit(self, "octetCount += (int) (*(const SwampString**) (v + %zu))->characterCount + 1;", offset);
+            break;
+        case SwtiTypeRecord: {
+            const SwtiRecordType* record = (const SwtiRecordType*) type;
+            for (size_t i = 0; i < record->fieldCount; ++i) {
+                const SwtiRecordTypeField* field = &record->fields[i];
+                emitMeasure(self, field->fieldType, offset + field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeTuple: {
+            const SwtiTupleType* tuple = (const SwtiTupleType*) type;
+            for (size_t i = 0; i < tuple->fieldCount; ++i) {
+                const SwtiTupleTypeField* field = &tuple->fields[i];
+                emitMeasure(self, field->fieldType, offset + field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeAlias:
+            emitMeasure(self, ((const SwtiAliasType*) type)->targetType, offset);
+            break;
+        case SwtiTypeList:
+        case SwtiTypeArray: {
+            const SwtiType* itemType = type->type == SwtiTypeList ? ((const SwtiListType*) type)->itemType
+                                                                   : ((const SwtiArrayType*) type)->itemType;
+            int itemOctetCount = fixedOctetSize(itemType);
+            self->constantOctetCount += 1;
+            if (itemOctetCount < 0 && !canCall(self, itemType)) {
+                break;
+            }
+            openBlock(self);
+            emit(self, "const SwampList* list = *(const SwampList**) (v + %zu);", offset);
+            if (itemOctetCount >= 0) {
+                emit(self, "octetCount += (int) list->count * %d;", itemOctetCount);
+            } else {
+                emit(self, "for (size_t i = 0; i < list->count; ++i) {");
+                emit(self, "    int itemOctetCount = %sMeasure%d((const uint8_t*) list->value + i * list->itemSize);",
+                     self->prefix, typeIndex(self, itemType));
+                emit(self, "    if (itemOctetCount < 0) {");
+                emit(self, "        return itemOctetCount;");
+                emit(self, "    }");
+                emit(self, "    octetCount += itemOctetCount;");
+                emit(self, "}");
+            }
+            closeBlock(self);
+        } break;
+        case SwtiTypeCustom:
+            if (!canCall(self, type)) {
+                break;
+            }
+            openBlock(self);
+            emit(self, "const uint8_t variantIndex = *(v + %zu);", offset);
+            emit(self, "if (variantIndex >= %zu) {", ((const SwtiCustomType*) type)->variantCount);
+            emit(self, "    return -1;");
+            emit(self, "}");
+            emit(self, "int variantOctetCount = %sMeasureVariants%d[variantIndex](v + %zu);", self->prefix,
+                 typeIndex(self, type), offset);
+            emit(self, "if (variantOctetCount < 0) {");
+            emit(self, "    return variantOctetCount;");
+            emit(self, "}");
+            emit(self, "octetCount += variantOctetCount;");
+            closeBlock(self);
+            break;
+        case SwtiTypeBlob:
+            self->constantOctetCount += 4;
+            emit(self, "octetCount += (int) (*(const SwampBlob**) (v + %zu))->octetCount;", offset);
+            break;
+        default:
+            emit(self, "return -1; // type %d can not be measured without serializing it", type->type);
+            break;
+    }
+}
+
+static const char* encodeSignature = "(FldOutStream* stream, const uint8_t* v)";
+static const char* decodeSignature = "(FldInStream* inStream, unmanagedTypeCreator creator, void* context, uint8_t* "
+                                     "target, SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)";
+static const char* measureSignature = "(const uint8_t* v)";
+
+static void emitPrototypes(Codegen* self, size_t index)
+{
+    const SwtiType* type = self->chunk->types[index];
+
+    emit(self, "static int %sEncode%zu%s;", self->prefix, index, encodeSignature);
+    emit(self, "static int %sDecode%zu%s;", self->prefix, index, decodeSignature);
+    emit(self, "static int %sMeasure%zu%s;", self->prefix, index, measureSignature);
+
+    if (type->type == SwtiTypeCustom) {
+        const SwtiCustomType* custom = (const SwtiCustomType*) type;
+        for (size_t i = 0; i < custom->variantCount; ++i) {
+            emit(self, "static int %sEncode%zu_%zu%s;", self->prefix, index, i, encodeSignature);
+            emit(self, "static int %sDecode%zu_%zu%s;", self->prefix, index, i, decodeSignature);
+            emit(self, "static int %sMeasure%zu_%zu%s;", self->prefix, index, i, measureSignature);
+        }
+    }
+}
+
+static void emitVariantTable(Codegen* self, size_t index, const char* kind, const char* signature)
+{
+    const SwtiCustomType* custom = (const SwtiCustomType*) self->chunk->types[index];
+
+    emit(self, "static int (*const %s%sVariants%zu[])%s = {", self->prefix, kind, index, signature);
+    for (size_t i = 0; i < custom->variantCount; ++i) {
+        emit(self, "    %s%s%zu_%zu,", self->prefix, kind, index, i);
+    }
+    emit(self, "};");
+}
+
+static void emitUnmanagedType(Codegen* self, size_t index)
+{
+    const SwtiType* type = self->chunk->types[index];
+
+    emit(self,
+         "static const SwtiUnmanagedType %sUnmanaged%zu = {.internal = {.type = SwtiTypeUnmanaged, .name = \"%s\"}};",
+         self->prefix, index, isIdentifier(type->name) ? type->name : "");
+}
+
+static void emitFunctions(Codegen* self, size_t index)
+{
+    const SwtiType* type = self->chunk->types[index];
+
+    emit(self, "// %s (%zu)", type->name ? type->name : "", index);
+    emit(self, "static int %sEncode%zu%s", self->prefix, index, encodeSignature);
+    openBlock(self);
+    emitEncode(self, type, 0);
+    emit(self, "return 0;");
+    closeBlock(self);
+    emit(self, "");
+
+    emit(self, "static int %sDecode%zu%s", self->prefix, index, decodeSignature);
+    openBlock(self);
+    emitDecode(self, type, 0);
+    emit(self, "return 0;");
+    closeBlock(self);
+    emit(self, "");
+
+    emit(self, "static int %sMeasure%zu%s", self->prefix, index, measureSignature);
+    openBlock(self);
+    emit(self, "int octetCount = 0;");
+    self->constantOctetCount = 0;
+    emitMeasure(self, type, 0);
+    emit(self, "return octetCount + %zu;", self->constantOctetCount);
+    closeBlock(self);
+    emit(self, "");
+
+    if (type->type != SwtiTypeCustom) {
+        return;
+    }
+
+    const SwtiCustomType* custom = (const SwtiCustomType*) type;
+    for (size_t i = 0; i < custom->variantCount; ++i) {
+        const SwtiCustomTypeVariant* variant = custom->variantTypes[i];
+
+        emit(self, "// %s", variant->name);
+        emit(self, "static int %sEncode%zu_%zu%s", self->prefix, index, i, encodeSignature);
+        openBlock(self);
+        emitWrite(self, "fldOutStreamWriteUInt8(stream, %zu)", i);
+        for (size_t j = 0; j < variant->paramCount; ++j) {
+            emitEncode(self, variant->fields[j].fieldType, variant->fields[j].memoryOffsetInfo.memoryOffset);
+        }
+        emit(self, "return 0;");
+        closeBlock(self);
+        emit(self, "");
+
+        emit(self, "static int %sDecode%zu_%zu%s", self->prefix, index, i, decodeSignature);
+        openBlock(self);
+        for (size_t j = 0; j < variant->paramCount; ++j) {
+            emitDecode(self, variant->fields[j].fieldType, variant->fields[j].memoryOffsetInfo.memoryOffset);
+        }
+        emit(self, "return 0;");
+        closeBlock(self);
+        emit(self, "");
+
+        emit(self, "static int %sMeasure%zu_%zu%s", self->prefix, index, i, measureSignature);
+        openBlock(self);
+        emit(self, "int octetCount = 0;");
+        self->constantOctetCount = 1;
+        for (size_t j = 0; j < variant->paramCount; ++j) {
+            emitMeasure(self, variant->fields[j].fieldType, variant->fields[j].memoryOffsetInfo.memoryOffset);
+        }
+        emit(self, "return octetCount + %zu;", self->constantOctetCount);
+        closeBlock(self);
+        emit(self, "");
+    }
+}
+
+static void emitPublicPrototypes(Codegen* self, size_t index, const char* terminator)
+{
+    const char* name = publicName(self, (int) index);
+
+    emit(self, "int %s%sToOctets(struct FldOutStream* stream, const void* v)%s", self->prefix, name, terminator);
+    emit(self, "int %s%sToOctetsRaw(struct FldOutStream* stream, const void* v)%s", self->prefix, name, terminator);
+    emit(self,
+         "int %s%sFromOctets(struct FldInStream* inStream, unmanagedTypeCreator creator, void* context, void* target, "
+         "struct SwampDynamicMemory* memory, struct SwampUnmanagedMemory* targetUnmanagedMemory)%s",
+         self->prefix, name, terminator);
+    emit(self,
+         "int %s%sFromOctetsRaw(struct FldInStream* inStream, unmanagedTypeCreator creator, void* context, void* "
+         "target, struct SwampDynamicMemory* memory, struct SwampUnmanagedMemory* targetUnmanagedMemory)%s",
+         self->prefix, name, terminator);
+    emit(self, "int %s%sOctetCount(const void* v)%s", self->prefix, name, terminator);
+}
+
+static void emitPublicFunctions(Codegen* self, size_t index)
+{
+    const char* name = publicName(self, (int) index);
+    const char* prefix = self->prefix;
+
+    emit(self, "int %s%sToOctets(FldOutStream* stream, const void* v)", prefix, name);
+    openBlock(self);
+    emit(self, "if (fldOutStreamWriteUInt8(stream, 0) < 0 || fldOutStreamWriteUInt8(stream, 1) < 0 || "
+               "fldOutStreamWriteUInt8(stream, 0) < 0) {");
+    emit(self, "    return -1;");
+    emit(self, "}");
+    emit(self, "return %sEncode%zu(stream, (const uint8_t*) v);", prefix, index);
+    closeBlock(self);
+    emit(self, "");
+
+    emit(self, "int %s%sToOctetsRaw(FldOutStream* stream, const void* v)", prefix, name);
+    openBlock(self);
+    emit(self, "return %sEncode%zu(stream, (const uint8_t*) v);", prefix, index);
+    closeBlock(self);
+    emit(self, "");
+
+    emit(self,
+         "int %s%sFromOctets(FldInStream* inStream, unmanagedTypeCreator creator, void* context, void* target, "
+         "SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)",
+         prefix, name);
+    openBlock(self);
+    emit(self, "uint8_t major, minor, patch;");
+    emit(self, "if (fldInStreamReadUInt8(inStream, &major) < 0 || fldInStreamReadUInt8(inStream, &minor) < 0 || "
+               "fldInStreamReadUInt8(inStream, &patch) < 0) {");
+    emit(self, "    return -1;");
+    emit(self, "}");
+    emit(self, "if (major != 0 || minor != 1) {");
+    emit(self, "    return -1;");
+    emit(self, "}");
+    emit(self, "return %sDecode%zu(inStream, creator, context, (uint8_t*) target, memory, targetUnmanagedMemory);",
+         prefix, index);
+    closeBlock(self);
+    emit(self, "");
+
+    emit(self,
+         "int %s%sFromOctetsRaw(FldInStream* inStream, unmanagedTypeCreator creator, void* context, void* target, "
+         "SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)",
+         prefix, name);
+    openBlock(self);
+    emit(self, "return %sDecode%zu(inStream, creator, context, (uint8_t*) target, memory, targetUnmanagedMemory);",
+         prefix, index);
+    closeBlock(self);
+    emit(self, "");
+
+    emit(self, "int %s%sOctetCount(const void* v)", prefix, name);
+    openBlock(self);
+    emit(self, "int octetCount = %sMeasure%zu((const uint8_t*) v);", prefix, index);
+    emit(self, "return octetCount < 0 ? octetCount : octetCount + 3;");
+    closeBlock(self);
+    emit(self, "");
+}
+
+int swampDumpCodegenHeader(FldOutStream* out, const SwtiChunk* chunk, const char* prefix)
+{
+    Codegen self;
+    self.out = out;
+    self.chunk = chunk;
+    self.prefix = prefix;
+    self.indentation = 0;
+    self.writeError = 0;
+
+    emit(&self, "// Generated by swamp_dump_codegen. Do not edit.");
+    emit(&self, "#ifndef SWAMP_DUMP_GENERATED_%s_H", prefix);
+    emit(&self, "#define SWAMP_DUMP_GENERATED_%s_H", prefix);
+    emit(&self, "");
+    emit(&self, "#include <swamp-dump/dump_unmanaged.h>");
+    emit(&self, "");
+    emit(&self, "struct FldInStream;");
+    emit(&self, "struct FldOutStream;");
+    emit(&self, "struct SwampDynamicMemory;");
+    emit(&self, "struct SwampUnmanagedMemory;");
+    emit(&self, "");
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        if (!isSerializable(chunk->types[i])) {
+            continue;
+        }
+        emitPublicPrototypes(&self, i, ";");
+    }
+    emit(&self, "");
+    emit(&self, "#endif");
+
+    return checkWriteError(&self, "header");
+}
+
+int swampDumpCodegenSource(FldOutStream* out, const SwtiChunk* chunk, const char* prefix, const char* headerName)
+{
+    Codegen self;
+    self.out = out;
+    self.chunk = chunk;
+    self.prefix = prefix;
+    self.indentation = 0;
+    self.writeError = 0;
+
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        if (isSerializable(chunk->types[i]) && typeIndex(&self, chunk->types[i]) != (int) i) {
+            CLOG_SOFT_ERROR("codegen: type %zu is listed twice in chunk", i)
+            return -1;
+        }
+    }
+
+    emit(&self, "// Generated by swamp_dump_codegen. Do not edit.");
+    emit(&self, "#include \"%s\"", headerName);
+    emit(&self, "");
+    emit(&self, "#include <flood/in_stream.h>");
+    emit(&self, "#include <flood/out_stream.h>");
+    emit(&self, "#include <swamp-runtime/dynamic_memory.h>");
+    emit(&self, "#include <swamp-runtime/swamp_allocate.h>");
+    emit(&self, "#include <swamp-runtime/types.h>");
+    emit(&self, "#include <swamp-typeinfo/typeinfo.h>");
+    emit(&self, "");
+
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        if (isSerializable(chunk->types[i])) {
+            emitPrototypes(&self, i);
+        }
+    }
+    emit(&self, "");
+
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        const SwtiType* type = chunk->types[i];
+        if (type->type == SwtiTypeCustom) {
+            emitVariantTable(&self, i, "Encode", encodeSignature);
+            emitVariantTable(&self, i, "Decode", decodeSignature);
+            emitVariantTable(&self, i, "Measure", measureSignature);
+        } else if (type->type == SwtiTypeUnmanaged) {
+            emitUnmanagedType(&self, i);
+        }
+    }
+    emit(&self, "");
+
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        if (isSerializable(chunk->types[i])) {
+            emitFunctions(&self, i);
+        }
+    }
+
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        if (isSerializable(chunk->types[i])) {
+            emitPublicFunctions(&self, i);
+        }
+    }
+
+    return checkWriteError(&self, "source");
+}
@@ -0,0 +1,19 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_CODEGEN_H
+#define SWAMP_DUMP_CODEGEN_H
+
+struct FldOutStream;
+struct SwtiChunk;
+struct SwtiType;
+
+int swampDumpCodegenSource(struct FldOutStream* out, const struct SwtiChunk* chunk, const char* prefix,
+                           const char* headerName);
+int swampDumpCodegenHeader(struct FldOutStream* out, const struct SwtiChunk* chunk, const char* prefix);
+
+/// Emits `v` as static const initializers with the exact memory layout the runtime expects.
+int swampDumpCodegenBake(struct FldOutStream* out, const void* v, const struct SwtiType* type, const char* symbolName);
+
+#endif
@@ -0,0 +1,220 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "codegen.h"
+
+#include <clog/clog.h>
+#include <clog/console.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <swamp-dump/dump_yaml.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/deserialize.h>
+#include <tiny-libc/tiny_libc.h>
+
+clog_config g_clog;
+
+#define MAX_OUTPUT_OCTET_COUNT (4 * 1024 * 1024)
+#define MAX_BAKE_MEMORY_OCTET_COUNT (16 * 1024 * 1024)
+
+static int readFile(const char* filename, uint8_t** octets, size_t* octetCount)
+{
+    FILE* fp = fopen(filename, "rb");
+    if (fp == 0) {
+        CLOG_SOFT_ERROR("could not open '%s'", filename)
+        return -1;
+    }
+
+    long size = -1;
+    if (fseek(fp, 0, SEEK_END) == 0) {
+        size = ftell(fp);
+    }
+    if (size < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        CLOG_SOFT_ERROR("could not find the size of '%s'", filename)
+        fclose(fp);
+        return -1;
+    }
+
+    *octets = tc_malloc(size == 0 ? 1 : (size_t) size);
+    *octetCount = fread(*octets, 1, (size_t) size, fp);
+    fclose(fp);
+    if (*octetCount != (size_t) size) {
+        CLOG_SOFT_ERROR("could only read %zu of %ld octets from '%s'", *octetCount, size, filename)
+        tc_free(*octets);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int writeFile(const char* filename, const FldOutStream* stream)
+{
+    FILE* fp = fopen(filename, "wb");
+    if (fp == 0) {
+        CLOG_SOFT_ERROR("could not write '%s'", filename)
+        return -1;
+    }
+
+    size_t writtenCount = fwrite(stream->octets, 1, stream->pos, fp);
+    if (fclose(fp) != 0 || writtenCount != stream->pos) {
+        CLOG_SOFT_ERROR("could not write all %zu octets to '%s'", stream->pos, filename)
+        return -1;
+    }
+
+    return 0;
+}
+
+static const char* baseName(const char* path)
+{
+    const char* last = path;
+    for (const char* p = path; *p; ++p) {
+        if (*p == '/' || *p == '\\') {
+            last = p + 1;
+        }
+    }
+
+    return last;
+}
+
+static int readChunk(const char* filename, SwtiChunk* chunk)
+{
+    uint8_t* typeOctets;
+    size_t typeOctetCount;
+    if (readFile(filename, &typeOctets, &typeOctetCount) < 0) {
+        return -2;
+    }
+
+    int error = swtiDeserialize(typeOctets, typeOctetCount, chunk);
+    tc_free(typeOctets);
+    if (error < 0) {
+        CLOG_SOFT_ERROR("could not deserialize type information '%s' %d", filename, error)
+        return error;
+    }
+
+    return 0;
+}
+
+static const SwtiType* findType(const SwtiChunk* chunk, const char* nameOrIndex)
+{
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        const char* name = chunk->types[i]->name;
+        if (name != 0 && tc_str_equal(name, nameOrIndex)) {
+            return chunk->types[i];
+        }
+    }
+
+    int index = atoi(nameOrIndex);
+    if (nameOrIndex[0] >= '0' && nameOrIndex[0] <= '9' && index >= 0 && (size_t) index < chunk->typeCount) {
+        return chunk->types[index];
+    }
+
+    return 0;
+}
+
+static int bake(const char* typesFilename, const char* typeName, const char* yamlFilename, const char* outputFilename,
+                const char* symbolName)
+{
+    SwtiChunk chunk;
+    int error = readChunk(typesFilename, &chunk);
+    if (error < 0) {
+        return error;
+    }
+
+    const SwtiType* type = findType(&chunk, typeName);
+    if (type == 0) {
+        CLOG_SOFT_ERROR("could not find type '%s' in '%s'", typeName, typesFilename)
+        return -3;
+    }
+
+    uint8_t* yamlOctets;
+    size_t yamlOctetCount;
+    if ((error = readFile(yamlFilename, &yamlOctets, &yamlOctetCount)) < 0) {
+        return error;
+    }
+
+    SwampDynamicMemory memory;
+    void* memoryOctets = tc_malloc(MAX_BAKE_MEMORY_OCTET_COUNT);
+    swampDynamicMemoryInit(&memory, memoryOctets, MAX_BAKE_MEMORY_OCTET_COUNT);
+
+    void* value = swampDynamicMemoryAlloc(&memory, 1, swtiGetMemorySize(type));
+    FldInStream yamlStream;
+    fldInStreamInit(&yamlStream, yamlOctets, yamlOctetCount);
+    if ((error = swampDumpFromYaml(&yamlStream, type, &memory, value)) < 0) {
+        CLOG_SOFT_ERROR("could not read '%s' as '%s' %d", yamlFilename, typeName, error)
+        return error;
+    }
+
+    uint8_t* outputOctets = tc_malloc(MAX_OUTPUT_OCTET_COUNT);
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, outputOctets, MAX_OUTPUT_OCTET_COUNT);
+    error = swampDumpCodegenBake(&outStream, value, type, symbolName);
+    if (error < 0) {
+        fprintf(stderr, "swamp_dump_codegen: could not bake '%s', nothing was written to '%s'\n", yamlFilename,
+                outputFilename);
+    } else {
+        error = writeFile(outputFilename, &outStream);
+    }
+
+    tc_free(outputOctets);
+    tc_free(memoryOctets);
+    tc_free(yamlOctets);
+
+    return error;
+}
+
+int main(int argc, const char* argv[])
+{
+    g_clog.log = clog_console;
+
+    if (argc >= 2 && tc_str_equal(argv[1], "--bake")) {
+        if (argc < 7) {
+            fprintf(stderr, "usage: swamp_dump_codegen --bake <types.swti> <type> <value.yaml> <output.c> <symbol>\n");
+            return 1;
+        }
+        return bake(argv[2], argv[3], argv[4], argv[5], argv[6]) < 0 ? 1 : 0;
+    }
+
+    if (argc < 4) {
+        fprintf(stderr, "usage: swamp_dump_codegen <types.swti> <output.c> <output.h> [prefix]\n");
+        fprintf(stderr, "       swamp_dump_codegen --bake <types.swti> <type> <value.yaml> <output.c> <symbol>\n");
+        return 1;
+    }
+
+    const char* prefix = argc > 4 ? argv[4] : "swampGenerated";
+
+    SwtiChunk chunk;
+    int error = readChunk(argv[1], &chunk);
+    if (error < 0) {
+        fprintf(stderr, "swamp_dump_codegen: could not read the types in '%s'\n", argv[1]);
+        return 1;
+    }
+
+    uint8_t* outputOctets = tc_malloc(MAX_OUTPUT_OCTET_COUNT);
+    FldOutStream outStream;
+
+    fldOutStreamInit(&outStream, outputOctets, MAX_OUTPUT_OCTET_COUNT);
+    error = swampDumpCodegenSource(&outStream, &chunk, prefix, baseName(argv[3]));
+    if (error < 0) {
+        fprintf(stderr, "swamp_dump_codegen: could not generate '%s'\n", argv[2]);
+    } else {
+        error = writeFile(argv[2], &outStream);
+    }
+
+    if (error >= 0) {
+        fldOutStreamInit(&outStream, outputOctets, MAX_OUTPUT_OCTET_COUNT);
+        error = swampDumpCodegenHeader(&outStream, &chunk, prefix);
+        if (error < 0) {
+            fprintf(stderr, "swamp_dump_codegen: could not generate '%s'\n", argv[3]);
+        } else {
+            error = writeFile(argv[3], &outStream);
+        }
+    }
+
+    tc_free(outputOctets);
+
+    return error < 0 ? 1 : 0;
+}
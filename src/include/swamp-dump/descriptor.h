@@ -0,0 +1,84 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_DESCRIPTOR_H
+#define SWAMP_DUMP_DESCRIPTOR_H
+
+#include <stddef.h>
+
+struct SwtiType;
+struct SwtiChunk;
+struct SwampDumpTypeDescriptor;
+
+typedef struct SwampDumpFieldDescriptor {
+    const char* name;
+    size_t nameLength;
+    size_t memoryOffset;
+    const struct SwampDumpTypeDescriptor* descriptor; ///< zero if the field type is not part of the chunk
+} SwampDumpFieldDescriptor;
+
+/// Facts about a type that the formats would otherwise derive on every call.
+/// Record and Tuple fields, variant parameters, the alias target and the List/Array item are all in `fields`.
+typedef struct SwampDumpTypeDescriptor {
+    const struct SwtiType* type;
+    const struct SwtiType* unaliased;
+    size_t nameLength;
+    int isSimple;
+    int isPointerFree;
+    int hasFixedOctetCount;
+    size_t fixedOctetCount;
+
+    const SwampDumpFieldDescriptor* fields;
+    size_t fieldCount;
+    const struct SwampDumpTypeDescriptor* const* variants;
+    size_t variantCount;
+} SwampDumpTypeDescriptor;
+
+typedef struct SwampDumpDescriptorCacheEntry {
+    const struct SwtiType* type;
+    const SwampDumpTypeDescriptor* descriptor;
+} SwampDumpDescriptorCacheEntry;
+
+/// Immutable after swampDumpDescriptorCacheInit(), so any number of threads can read it without locks.
+typedef struct SwampDumpDescriptorCache {
+    SwampDumpDescriptorCacheEntry* entries;
+    size_t capacity;
+    SwampDumpTypeDescriptor* descriptors;
+    size_t descriptorCount;
+    SwampDumpFieldDescriptor* fields;
+    const SwampDumpTypeDescriptor** variants;
+    struct SwampDumpDescriptorCache* nextPublished;
+    int isPublished;
+} SwampDumpDescriptorCache;
+
+/// Returns -3 when out of memory.
+int swampDumpDescriptorCacheInit(SwampDumpDescriptorCache* self, const struct SwtiChunk* chunk);
+void swampDumpDescriptorCacheDestroy(SwampDumpDescriptorCache* self);
+const SwampDumpTypeDescriptor* swampDumpDescriptorCacheFind(const SwampDumpDescriptorCache* self,
+                                                           const struct SwtiType* type);
+
+/// Makes the cache visible to swampDumpDescriptorFind() and all dump and undump functions. Lookups run without locks,
+/// so a published cache, and the chunk it was made from, must live until it is unpublished. Destroying a published
+/// cache asserts and leaves it untouched.
+void swampDumpDescriptorCachePublish(SwampDumpDescriptorCache* self);
+
+/// Takes the cache back out, so it can be destroyed. Nothing may dump, undump, publish or unpublish on any other
+/// thread while it runs, e.g. call it at shutdown or when a chunk is reloaded between frames.
+void swampDumpDescriptorCacheUnpublish(SwampDumpDescriptorCache* self);
+const SwampDumpTypeDescriptor* swampDumpDescriptorFind(const struct SwtiType* type);
+
+/// Booleans, integers, fixed point numbers and strings fit on the line of their field name.
+int swampDumpTypeIsSimple(const struct SwtiType* type);
+
+/// The children that descriptors keep in `fields`: Record and Tuple fields, variant parameters, the alias target and
+/// the List/Array item. A custom type has none, its variants are not fields.
+size_t swampDumpFieldCount(const struct SwtiType* type);
+const struct SwtiType* swampDumpFieldType(const struct SwtiType* type, size_t index);
+
+/// Returns 1 and sets `octetCount` if every encoded value of `type` has the same size, i.e. it has no strings, blobs,
+/// lists, arrays or unmanaged values and all variants of a custom type encode to the same size. Uses the published
+/// descriptors when there are any, and derives it the same way the cache does when there are none.
+int swampDumpFixedOctetCount(const struct SwtiType* type, size_t* octetCount);
+
+#endif
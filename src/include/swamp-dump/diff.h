@@ -0,0 +1,21 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_DIFF_H
+#define SWAMP_DUMP_DIFF_H
+
+struct SwtiType;
+struct FldOutStream;
+struct SwampDumpAsciiBudget;
+
+/// Walks both values together and writes one line per difference, "path: old -> new", using the same paths as
+/// swampDumpQueryCompile(). Subtrees with identical memory, and so identical pointers, are skipped without being
+/// visited. Each old and new value is printed within `valueBudget`, which can be zero.
+/// Returns the number of differences.
+int swampDumpDiffToAscii(const void* a, const void* b, const struct SwtiType* type, int flags,
+                         const struct SwampDumpAsciiBudget* valueBudget, struct FldOutStream* fp);
+int swampDumpDiffToAsciiNoColor(const void* a, const void* b, const struct SwtiType* type, int flags,
+                                const struct SwampDumpAsciiBudget* valueBudget, struct FldOutStream* fp);
+
+#endif
@@ -0,0 +1,47 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_DIRTY_H
+#define SWAMP_DUMP_DIRTY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <swamp-dump/dump_unmanaged.h>
+
+struct SwtiType;
+struct SwtiRecordType;
+struct FldInStream;
+struct FldOutStream;
+struct SwampDynamicMemory;
+struct SwampUnmanagedMemory;
+
+typedef enum SwampDumpFieldChange {
+    SwampDumpFieldChanged,
+    SwampDumpFieldDescend, ///< only for record fields, asks about the fields of the inner record
+} SwampDumpFieldChange;
+
+/// Returns the index of the first changed field at or after `fieldIndex` and sets `change` for it, or returns the
+/// field count of the record when none of the remaining fields changed.
+typedef size_t (*swampDumpNextChangedFieldFn)(void* context, const struct SwtiRecordType* recordType,
+                                              const void* record, size_t fieldIndex, SwampDumpFieldChange* change);
+
+/// Writes only the record fields that `nextChanged` reports, each record prefixed with a presence mask of one bit
+/// per field. `nextChanged` is called once per changed field, plus once per visited record to find that nothing more
+/// changed, so the time spent depends on the number of changes and not on the size of the value.
+int swampDumpToOctetsDirty(struct FldOutStream* stream, const void* v, const struct SwtiType* type,
+                           swampDumpNextChangedFieldFn nextChanged, void* context);
+
+/// Same as swampDumpToOctetsDirty(), with bit `i` of `dirtyMask` (least significant bit first) set for every
+/// changed field of the outermost record.
+int swampDumpToOctetsDirtyMask(struct FldOutStream* stream, const void* v, const struct SwtiType* type,
+                               const uint8_t* dirtyMask);
+
+/// Merges the fields written by swampDumpToOctetsDirty() into an existing value. Fields that are not in the dump are
+/// left as they are.
+int swampDumpFromOctetsDirtyMerge(struct FldInStream* inStream, const struct SwtiType* type,
+                                  unmanagedTypeCreator creator, void* context, void* target,
+                                  struct SwampDynamicMemory* memory,
+                                  struct SwampUnmanagedMemory* targetUnmanagedMemory);
+
+#endif
@@ -23,4 +23,17 @@ int swampDumpFromOctets(struct FldInStream* inStream, const struct SwtiType* tiT
                         void* context, void* target, struct SwampDynamicMemory* memory, struct SwampUnmanagedMemory* targetUnmanagedMemory);
 int swampDumpFromOctetsRaw(struct FldInStream* inStream, const struct SwtiType* tiType, unmanagedTypeCreator creator,
                            void* context,void* target, struct SwampDynamicMemory* memory, struct SwampUnmanagedMemory* targetUnmanagedMemory);
+
+/// Decodes into a `target` that already holds a decoded value, or is zeroed. Strings and blobs with the same octets
+/// and lists and arrays with the same count are kept, so only values that changed shape are allocated. The lists
+/// and arrays in `target` are overwritten in place and must not be shared with other values.
+int swampDumpFromOctetsReuse(struct FldInStream* inStream, const struct SwtiType* tiType, unmanagedTypeCreator creator,
+                             void* context, void* target, struct SwampDynamicMemory* memory,
+                             struct SwampUnmanagedMemory* targetUnmanagedMemory);
+int swampDumpFromOctetsReuseRaw(struct FldInStream* inStream, const struct SwtiType* tiType,
+                                unmanagedTypeCreator creator, void* context, void* target,
+                                struct SwampDynamicMemory* memory, struct SwampUnmanagedMemory* targetUnmanagedMemory);
+
+/// Moves past one raw value of `tiType` without decoding it. Unmanaged values can not be skipped.
+int swampDumpSkipOctetsRaw(struct FldInStream* inStream, const struct SwtiType* tiType);
 #endif
@@ -9,8 +9,65 @@
 #include <swamp-typeinfo/typeinfo.h>
 struct FldOutStream;
 
+typedef enum SwampDumpAsciiToken {
+    SwampDumpAsciiTokenKeyword,
+    SwampDumpAsciiTokenNumber,
+    SwampDumpAsciiTokenText,
+    SwampDumpAsciiTokenBracket,
+    SwampDumpAsciiTokenSeparator,
+    SwampDumpAsciiTokenFieldName,
+    SwampDumpAsciiTokenAssign,
+    SwampDumpAsciiTokenColon,
+    SwampDumpAsciiTokenVariant,
+    SwampDumpAsciiTokenBlobText,
+    SwampDumpAsciiTokenBlobHex,
+    SwampDumpAsciiTokenCount
+} SwampDumpAsciiToken;
+
+/// How the ASCII dump looks. Colors are ANSI foreground codes and are ignored by the no-color dumpers.
+typedef struct SwampDumpAsciiStyle {
+    int colors[SwampDumpAsciiTokenCount];
+    const char* indentation;
+    const char* blobIndentation;
+    const char* separator;
+    const char* assign;
+    /// Expanded blobs only show this many octets.
+    size_t blobOctetLimit;
+} SwampDumpAsciiStyle;
+
+extern const SwampDumpAsciiStyle swampDumpAsciiStyleDefault;
+
+/// The color that is active before anything is written.
+#define SWAMP_DUMP_ASCII_COLOR_UNKNOWN (-1)
+
+/// Writes the escape sequence for the ANSI foreground `color`, unless it is `*activeColor` already.
+void swampDumpAsciiWriteColor(struct FldOutStream* fp, int* activeColor, int color);
+
+/// Writes the escape sequence that resets the terminal to its own colors.
+void swampDumpAsciiResetColor(struct FldOutStream* fp, int* activeColor);
+
+/// Limits on how much of a value is printed. Zero means no limit. The walk stops as soon as `maxOctetCount` is
+/// reached, so the cost of a dump is bounded by the budget and not by the size of the value.
+typedef struct SwampDumpAsciiBudget {
+    size_t maxDepth; ///< nested Records, Tuples, Lists and Arrays. Custom types do not add a level.
+    size_t maxItemCount; ///< per list and array, the rest is summarized as "... N more"
+    size_t maxPreviewLength; ///< characters of strings and octets of expanded blobs
+    size_t maxOctetCount;
+} SwampDumpAsciiBudget;
+
+/// `budget` can be zero for an unlimited dump.
+int swampDumpToAsciiStyled(const uint8_t* v, const SwtiType* type, int flags, int indentation,
+                           const SwampDumpAsciiStyle* style, const SwampDumpAsciiBudget* budget,
+                           struct FldOutStream* fp);
+int swampDumpToAsciiStyledNoColor(const uint8_t* v, const SwtiType* type, int flags, int indentation,
+                                  const SwampDumpAsciiStyle* style, const SwampDumpAsciiBudget* budget,
+                                  struct FldOutStream* fp);
 
 int swampDumpToAscii(const uint8_t* v, const SwtiType* type, int flags, int indentation, struct FldOutStream* fp);
+/// Stops formatting when `target` is full.
 const char* swampDumpToAsciiString(const uint8_t * v, const SwtiType* type, int flags, char* target, size_t maxCount);
+/// `budget` can be zero, the size of `target` is always a limit.
+const char* swampDumpToAsciiStringBudgeted(const uint8_t* v, const SwtiType* type, int flags,
+                                           const SwampDumpAsciiBudget* budget, char* target, size_t maxCount);
 
 #endif
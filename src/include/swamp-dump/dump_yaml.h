@@ -8,7 +8,7 @@
 struct FldInStream;
 struct FldOutStream;
 struct SwtiType;
-struct SwtiType;
+struct SwtiCustomTypeVariant;
 struct SwampDynamicMemory;
 
 #include <stddef.h>
@@ -16,7 +16,17 @@ struct SwampDynamicMemory;
 int swampDumpFromYaml(struct FldInStream* inStream, const struct SwtiType* tiType,
     struct SwampDynamicMemory* memory, void* target);
 
+/// Writes the value in the format that swampDumpFromYaml() reads: record fields as "name: value", List, Array and
+/// Tuple items as "- value", custom types as the variant name followed by its parameters and blobs as a ">" block of
+/// text rows, or a ">x" block of hex rows if the blob is not printable. Returns -2 for strings that can not be written
+/// as a plain scalar (line breaks or a leading space) and -1 for types that can not be written or if `fp` is full.
 int swampDumpToYaml(const void* v, const struct SwtiType* type, int flags, int indentation, struct FldOutStream* fp);
+
+/// Writes a "%YAML 1.2" document with a terminating zero. Returns zero if the value could not be written or did not fit.
 const char* swampDumpToYamlString(const void* v, const struct SwtiType* type, int flags, char* target, size_t maxCount);
 
+/// Variants with one parameter, or with only Bool, Int, Fixed and RefId parameters, write their parameters on the
+/// variant line ("Just 42", "Move 1 -2"). Other variants write each parameter as a "- " item below the variant name.
+int swampDumpYamlVariantIsInline(const struct SwtiCustomTypeVariant* variant);
+
 #endif // SWAMP_DUMP_DUMP_YAML_H
@@ -0,0 +1,20 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_ENTROPY_H
+#define SWAMP_DUMP_ENTROPY_H
+
+struct SwtiType;
+struct FldInStream;
+struct FldOutStream;
+struct SwampDynamicMemory;
+
+/// Range coded dump. The field path from the root decides which adaptive model codes each part: variant indices,
+/// list and string lengths, integers as deltas from the previous value of the same field, and string and blob
+/// octets with the previous octet as context. Unmanaged values are not supported. Both return -3 when out of memory.
+int swampDumpToOctetsEntropy(struct FldOutStream* stream, const void* v, const struct SwtiType* type);
+int swampDumpFromOctetsEntropy(struct FldInStream* inStream, const struct SwtiType* type, void* target,
+                               struct SwampDynamicMemory* memory);
+
+#endif
@@ -0,0 +1,36 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_FORMAT_H
+#define SWAMP_DUMP_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Enough for "-2147483.648", the longest Int or Fixed. No terminating zero is written.
+#define SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT (12)
+
+size_t swampDumpFormatUInt32(char* target, uint32_t value);
+size_t swampDumpFormatInt32(char* target, int32_t value);
+
+/// Always writes all three decimals, so the text parses back to the exact same value.
+size_t swampDumpFormatFixed32(char* target, int32_t value);
+
+/// Trailing spaces are allowed. Returns -1 if the text is malformed and -2 if the value does not fit.
+int swampDumpParseInt32(const char* s, size_t count, int32_t* value);
+
+/// Accepts "12", "-12.5" and "0.125". Decimals beyond the third must be zero.
+int swampDumpParseFixed32(const char* s, size_t count, int32_t* value);
+
+/// Returns 1 if all octets are in the printable ASCII range (32 to 126).
+int swampDumpOctetsArePrintable(const uint8_t* octets, size_t count);
+
+/// Writes two upper case hex digits per octet, 2 * `count` characters in total.
+void swampDumpFormatHexPairs(char* target, const uint8_t* octets, size_t count);
+
+/// Reads hex digit pairs, spaces between pairs are skipped. Returns the number of octets written to `target` or -1
+/// if the text is malformed. `target` must have room for `count / 2` octets.
+int swampDumpParseHexPairs(const char* s, size_t count, uint8_t* target);
+
+#endif
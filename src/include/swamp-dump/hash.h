@@ -0,0 +1,25 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_HASH_H
+#define SWAMP_DUMP_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct SwtiType;
+
+/// The raw octet format is the canonical encoding: padding and unused variant memory are never written, so equal
+/// values always encode to the same octets. The hash is defined over those octets, but is computed while walking
+/// the value, without encoding it.
+uint64_t swampDumpHash(const void* v, const struct SwtiType* type);
+
+/// Same hash for a value that is already encoded with swampDumpToOctetsRaw().
+uint64_t swampDumpHashOctets(const uint8_t* octets, size_t octetCount);
+
+/// Returns 1 if the values are equal. Lists and arrays of items without pointers or padding are compared with a
+/// single memcmp.
+int swampDumpEqual(const void* a, const void* b, const struct SwtiType* type);
+
+#endif
@@ -0,0 +1,65 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_LOG_RING_H
+#define SWAMP_DUMP_LOG_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct SwtiType;
+struct SwampDynamicMemory;
+struct FldOutStream;
+
+#define SWAMP_DUMP_LOG_RING_CACHE_LINE (64)
+
+/// Single producer, single consumer ring of values in the raw octet format. The producer (the simulation thread)
+/// only encodes the value into the ring, the consumer (a logging thread) decodes and formats it later.
+typedef struct SwampDumpLogRing {
+    uint8_t* octets;
+    size_t capacity;
+
+    /// Written by the producer only. Other threads read the counters with swampDumpLogRingPushedCount() and
+    /// swampDumpLogRingDroppedCount().
+    size_t head;
+    size_t pushedCount;
+    size_t droppedCount;
+    uint8_t producerPadding[SWAMP_DUMP_LOG_RING_CACHE_LINE];
+
+    /// Written by the consumer only
+    size_t tail;
+    uint8_t consumerPadding[SWAMP_DUMP_LOG_RING_CACHE_LINE];
+} SwampDumpLogRing;
+
+typedef struct SwampDumpLogEntry {
+    const struct SwtiType* type;
+    int flags;
+    const uint8_t* octets;
+    size_t octetCount;
+} SwampDumpLogEntry;
+
+/// `octets` must be aligned to eight octets, since the entry headers are written in place. `capacity` is rounded
+/// down to a multiple of eight octets.
+void swampDumpLogRingInit(SwampDumpLogRing* self, uint8_t* octets, size_t capacity);
+
+/// Producer side. Returns -1 and counts a drop if the ring is full, the value is never waited for.
+/// `flags` are the ASCII dump flags used when the entry is rendered.
+int swampDumpLogRingPush(SwampDumpLogRing* self, const void* v, const struct SwtiType* type, int flags);
+
+/// Consumer side. Returns 1 and fills in `entry` if there is an entry, 0 if the ring is empty. The entry stays
+/// valid until swampDumpLogRingRelease() is called.
+int swampDumpLogRingPeek(SwampDumpLogRing* self, SwampDumpLogEntry* entry);
+void swampDumpLogRingRelease(SwampDumpLogRing* self);
+
+/// Safe to call from any thread while the producer pushes.
+size_t swampDumpLogRingPushedCount(const SwampDumpLogRing* self);
+size_t swampDumpLogRingDroppedCount(const SwampDumpLogRing* self);
+
+/// Decodes the oldest entry into `memory` and writes it as ASCII to `out`. Returns 1 if an entry was rendered and
+/// 0 if the ring is empty. The caller resets `memory` when it sees fit.
+int swampDumpLogRingRender(SwampDumpLogRing* self, struct SwampDynamicMemory* memory, struct FldOutStream* out);
+int swampDumpLogRingRenderNoColor(SwampDumpLogRing* self, struct SwampDynamicMemory* memory,
+                                  struct FldOutStream* out);
+
+#endif
@@ -0,0 +1,97 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_MIGRATE_H
+#define SWAMP_DUMP_MIGRATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <swamp-dump/dump_unmanaged.h>
+
+struct SwtiType;
+struct FldInStream;
+struct FldOutStream;
+struct SwampDynamicMemory;
+struct SwampUnmanagedMemory;
+struct SwampDumpMigrationNode;
+
+typedef enum SwampDumpMigrationKind {
+    SwampDumpMigrationCopy,    ///< same structure on both sides, decoded as is
+    SwampDumpMigrationSkip,    ///< only the writer has it
+    SwampDumpMigrationDefault, ///< only the reader has it
+    SwampDumpMigrationRecord,
+    SwampDumpMigrationCustom,
+    SwampDumpMigrationList,
+} SwampDumpMigrationKind;
+
+typedef struct SwampDumpMigrationField {
+    const struct SwampDumpMigrationNode* node;
+    size_t readerOffset;
+} SwampDumpMigrationField;
+
+typedef struct SwampDumpMigrationVariant {
+    int readerVariantIndex; ///< -1 if the reader removed the variant
+    SwampDumpMigrationField* fields;
+    size_t fieldCount;
+    SwampDumpMigrationField* defaults;
+    size_t defaultCount;
+} SwampDumpMigrationVariant;
+
+typedef struct SwampDumpMigrationNode {
+    SwampDumpMigrationKind kind;
+    const struct SwtiType* writerType;
+    const struct SwtiType* readerType;
+
+    /// Record and Tuple: one entry per writer field, in writer order.
+    SwampDumpMigrationField* fields;
+    size_t fieldCount;
+    SwampDumpMigrationField* defaults;
+    size_t defaultCount;
+
+    /// Custom: one entry per writer variant.
+    SwampDumpMigrationVariant* variants;
+    size_t variantCount;
+
+    /// List and Array
+    const struct SwampDumpMigrationNode* item;
+
+    struct SwampDumpMigrationNode* next;
+} SwampDumpMigrationNode;
+
+/// Compiled once per writer and reader type pair. Fields are matched by name, variants by name and variant
+/// parameters by position.
+typedef struct SwampDumpMigrationPlan {
+    const struct SwtiType* writerType;
+    const struct SwtiType* readerType;
+    uint64_t writerFingerprint;
+    const SwampDumpMigrationNode* root;
+    SwampDumpMigrationNode* nodes;
+} SwampDumpMigrationPlan;
+
+uint64_t swampDumpTypeFingerprint(const struct SwtiType* type);
+
+int swampDumpMigrationPlanInit(SwampDumpMigrationPlan* self, const struct SwtiType* writerType,
+                               const struct SwtiType* readerType);
+void swampDumpMigrationPlanDestroy(SwampDumpMigrationPlan* self);
+
+/// Writes the value prefixed with the fingerprint of `type`, so readers can pick a migration plan.
+int swampDumpToOctetsWithSchema(struct FldOutStream* stream, const void* v, const struct SwtiType* type);
+
+/// Reads a raw value that was written with `plan->writerType` into the memory layout of `plan->readerType`.
+int swampDumpFromOctetsMigrateRaw(struct FldInStream* inStream, const SwampDumpMigrationPlan* plan,
+                                  unmanagedTypeCreator creator, void* context, void* target,
+                                  struct SwampDynamicMemory* memory,
+                                  struct SwampUnmanagedMemory* targetUnmanagedMemory);
+
+/// Reads dumps from swampDumpToOctetsWithSchema() or swampDumpToOctets() into `readerType`. A dump with a writer
+/// fingerprint that differs from `readerType` is decoded with the plan that has the same writer fingerprint.
+/// A dump from swampDumpToOctets() has no fingerprint, so nothing can be checked: it is decoded as `readerType`,
+/// and the caller must know that it was written with that very type.
+int swampDumpFromOctetsWithSchema(struct FldInStream* inStream, const struct SwtiType* readerType,
+                                  const SwampDumpMigrationPlan* const* plans, size_t planCount,
+                                  unmanagedTypeCreator creator, void* context, void* target,
+                                  struct SwampDynamicMemory* memory,
+                                  struct SwampUnmanagedMemory* targetUnmanagedMemory);
+
+#endif
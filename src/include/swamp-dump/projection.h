@@ -0,0 +1,59 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_PROJECTION_H
+#define SWAMP_DUMP_PROJECTION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <swamp-dump/dump_unmanaged.h>
+
+struct SwtiType;
+struct FldInStream;
+struct SwampDynamicMemory;
+struct SwampUnmanagedMemory;
+
+typedef enum SwampDumpProjectionSelection {
+    SwampDumpProjectionSkipped,
+    SwampDumpProjectionWhole,
+    SwampDumpProjectionPartial,
+} SwampDumpProjectionSelection;
+
+/// Selection for the children of one record, tuple, custom type, variant, list or array. Lists and arrays have a
+/// single child, the item. The children of a custom type are its variants, and those of a variant its parameters.
+typedef struct SwampDumpProjectionNode {
+    const struct SwtiType* type;
+    uint8_t* selections;
+    struct SwampDumpProjectionNode** children;
+    size_t childCount;
+} SwampDumpProjectionNode;
+
+typedef struct SwampDumpProjection {
+    const struct SwtiType* type;
+    SwampDumpProjectionNode* root;
+} SwampDumpProjection;
+
+typedef enum SwampDumpProjectionFill {
+    SwampDumpProjectionFillUntouched,
+    SwampDumpProjectionFillZero,
+} SwampDumpProjectionFill;
+
+/// Paths are field names separated by '.', where `[*]` after a name selects every item, e.g. "pos.x" or "ar[*].y".
+/// A custom type is followed by a variant name and a parameter index, e.g. "ma.Just.0". A path that ends at a
+/// record, list, custom type or variant selects all of it.
+int swampDumpProjectionInit(SwampDumpProjection* self, const struct SwtiType* type, const char* const* paths,
+                            size_t pathCount);
+void swampDumpProjectionDestroy(SwampDumpProjection* self);
+
+/// Decodes only the selected fields. Everything else is skipped in the stream without being allocated.
+int swampDumpFromOctetsProjected(struct FldInStream* inStream, const SwampDumpProjection* projection,
+                                 SwampDumpProjectionFill fill, unmanagedTypeCreator creator, void* context,
+                                 void* target, struct SwampDynamicMemory* memory,
+                                 struct SwampUnmanagedMemory* targetUnmanagedMemory);
+int swampDumpFromOctetsProjectedRaw(struct FldInStream* inStream, const SwampDumpProjection* projection,
+                                    SwampDumpProjectionFill fill, unmanagedTypeCreator creator, void* context,
+                                    void* target, struct SwampDynamicMemory* memory,
+                                    struct SwampUnmanagedMemory* targetUnmanagedMemory);
+
+#endif
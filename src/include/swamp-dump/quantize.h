@@ -0,0 +1,53 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_QUANTIZE_H
+#define SWAMP_DUMP_QUANTIZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct SwtiType;
+struct FldInStream;
+struct FldOutStream;
+struct SwampDynamicMemory;
+
+/// Encoding annotation for an Int or Fixed record field. `min`, `max` and `step` are in the raw int32 units of the
+/// field, so a Fixed in 0..4095 at 1/16 precision is {0, 4095000, 62}. Values are clamped to [min, max] and rounded
+/// to the nearest step. `min + maxStepCount * step` can be larger than `max` when the range is not a multiple of
+/// `step`, that last step decodes as `max`, so a decoded value is always within [min, max].
+typedef struct SwampDumpQuantizedField {
+    const struct SwtiType* recordType;
+    const char* fieldName;
+    int32_t min;
+    int32_t max;
+    int32_t step;
+} SwampDumpQuantizedField;
+
+typedef struct SwampDumpQuantizedEntry {
+    const struct SwtiType* recordType;
+    size_t fieldIndex;
+    int32_t min;
+    int32_t max;
+    int32_t step;
+    uint32_t maxStepCount;
+    int bitCount;
+} SwampDumpQuantizedEntry;
+
+typedef struct SwampDumpQuantization {
+    SwampDumpQuantizedEntry* entries;
+    size_t entryCount;
+} SwampDumpQuantization;
+
+int swampDumpQuantizationInit(SwampDumpQuantization* self, const SwampDumpQuantizedField* fields, size_t fieldCount);
+void swampDumpQuantizationDestroy(SwampDumpQuantization* self);
+
+/// Bit packed dump. Annotated fields use the fewest bits that hold their range and are clamped to it, booleans use
+/// one bit and variant indices as many as the variant count needs. Strings and blobs start on an octet boundary.
+int swampDumpToBits(struct FldOutStream* stream, const void* v, const struct SwtiType* type,
+                    const SwampDumpQuantization* quantization);
+int swampDumpFromBits(struct FldInStream* inStream, const struct SwtiType* type,
+                      const SwampDumpQuantization* quantization, void* target, struct SwampDynamicMemory* memory);
+
+#endif
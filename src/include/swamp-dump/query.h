@@ -0,0 +1,82 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_QUERY_H
+#define SWAMP_DUMP_QUERY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct SwtiType;
+
+#define SWAMP_DUMP_QUERY_MAX_STEPS (16)
+
+typedef enum SwampDumpQueryStepKind {
+    SwampDumpQueryField,   ///< record or tuple field, or variant parameter
+    SwampDumpQueryItem,    ///< list or array item
+    SwampDumpQueryVariant, ///< matches only if the custom type has this variant
+} SwampDumpQueryStepKind;
+
+typedef struct SwampDumpQueryStep {
+    SwampDumpQueryStepKind kind;
+    const struct SwtiType* type; ///< the unaliased record, tuple, variant, list, array or custom the step is in
+    size_t index;
+    int hasFixedSkip;
+    size_t fixedSkipOctetCount; ///< Field: octets before the field. Item: octets per item.
+} SwampDumpQueryStep;
+
+/// A compiled path. It holds no allocations and can be shared between threads.
+typedef struct SwampDumpQuery {
+    const struct SwtiType* type;
+    SwampDumpQueryStep steps[SWAMP_DUMP_QUERY_MAX_STEPS];
+    size_t stepCount;
+} SwampDumpQuery;
+
+typedef struct SwampDumpQueryResult {
+    const struct SwtiType* type; ///< type of the value at the path
+    const uint8_t* octets;       ///< the encoded value, inside the queried buffer
+    size_t octetCount;
+    int32_t value; ///< Bool, Int, Fixed and RefId value, or the variant index of a Custom
+} SwampDumpQueryResult;
+
+/// Paths are names separated by '.'. A name is a record or tuple field, a variant name or a variant parameter index,
+/// and can be followed by item indices, e.g. "pos.x", "ar[2].y" or "ma.Just.0".
+int swampDumpQueryCompile(SwampDumpQuery* self, const struct SwtiType* type, const char* path);
+
+/// Finds the value in an encoded buffer without decoding or allocating. Returns 0 if found, 1 if the value does not
+/// have that path (another variant or too few items) and a negative error if the octets are malformed.
+int swampDumpQueryOctets(const SwampDumpQuery* self, const uint8_t* octets, size_t octetCount,
+                         SwampDumpQueryResult* result);
+int swampDumpQueryOctetsRaw(const SwampDumpQuery* self, const uint8_t* octets, size_t octetCount,
+                            SwampDumpQueryResult* result);
+
+/// Overwrites a Bool, Int, Fixed or RefId at the path in place. For a Custom it changes the variant index, which is
+/// only allowed when both variants have the same parameter types, so the encoded parameters stay valid.
+int swampDumpPatchOctets(const SwampDumpQuery* query, uint8_t* octets, size_t octetCount, int32_t value);
+
+/// Replaces the value at the path with `replacement`, a raw encoding from swampDumpToOctetsRaw() of the same type.
+/// The octets after it are moved, which needs `capacity` to fit the new size.
+int swampDumpSpliceOctets(const SwampDumpQuery* query, uint8_t* octets, size_t octetCount, size_t capacity,
+                          const uint8_t* replacement, size_t replacementOctetCount, size_t* newOctetCount);
+
+/// An encoded list or array whose items all have the same size, so item `n` is found without reading the ones
+/// before it.
+typedef struct SwampDumpFixedStrideList {
+    const struct SwtiType* itemType;
+    size_t itemMemorySize;
+    const uint8_t* items;
+    size_t count;
+    size_t stride;
+} SwampDumpFixedStrideList;
+
+/// `octets` is an encoded list or array, e.g. the result of a query.
+int swampDumpFixedStrideListInit(SwampDumpFixedStrideList* self, const struct SwtiType* listType,
+                                 const uint8_t* octets, size_t octetCount);
+const uint8_t* swampDumpFixedStrideListItem(const SwampDumpFixedStrideList* self, size_t index);
+
+/// Decodes items [first, first + count) into `items`. Fixed size items never need dynamic memory, so separate
+/// ranges can be decoded on separate threads.
+int swampDumpFixedStrideListDecode(const SwampDumpFixedStrideList* self, size_t first, size_t count, void* items);
+
+#endif
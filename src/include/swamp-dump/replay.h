@@ -0,0 +1,72 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_REPLAY_H
+#define SWAMP_DUMP_REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <swamp-dump/dump_unmanaged.h>
+
+struct SwtiType;
+struct FldOutStream;
+struct SwampDynamicMemory;
+struct SwampUnmanagedMemory;
+
+/// Records one value per tick. Every `keyframeInterval` entries a full keyframe (swampDumpToOctets) is written,
+/// the entries in between only hold the octets that changed compared to the previous entry.
+/// swampDumpReplayRecorderFinish() appends the keyframe positions as a seek table, so a player does not have to read
+/// every entry. A recording that was never finished can still be played.
+/// The recorder and the player return -4 when they run out of memory.
+typedef struct SwampDumpReplayRecorder {
+    struct FldOutStream* stream;
+    const struct SwtiType* type;
+    size_t keyframeInterval;
+    size_t entryCount;
+
+    uint32_t* keyframePositions;
+    size_t keyframeCount;
+    size_t keyframeCapacity;
+
+    uint8_t* previousState;
+    size_t previousStateOctetCount;
+    uint8_t* currentState;
+    size_t maxStateOctetCount;
+} SwampDumpReplayRecorder;
+
+int swampDumpReplayRecorderInit(SwampDumpReplayRecorder* self, struct FldOutStream* stream, const struct SwtiType* type,
+                                size_t keyframeInterval, size_t maxStateOctetCount);
+void swampDumpReplayRecorderDestroy(SwampDumpReplayRecorder* self);
+int swampDumpReplayRecorderAdd(SwampDumpReplayRecorder* self, const void* v);
+/// Ends the recording with the seek table. No entries can be added after it.
+int swampDumpReplayRecorderFinish(SwampDumpReplayRecorder* self);
+
+/// Reconstructs the value at any tick from the nearest keyframe and at most `keyframeInterval - 1` deltas.
+typedef struct SwampDumpReplayPlayer {
+    const uint8_t* octets;
+    size_t octetCount;
+    const struct SwtiType* type;
+    size_t keyframeInterval;
+    size_t entryCount;
+
+    uint32_t* keyframePositions;
+    size_t keyframeCount;
+    size_t entriesEnd; ///< where the seek table starts, or the end of the recording
+
+    uint8_t* state;
+    size_t stateOctetCount;
+    size_t maxStateOctetCount;
+    size_t stateTick;
+    size_t stateNextPosition;
+    int hasState;
+} SwampDumpReplayPlayer;
+
+int swampDumpReplayPlayerInit(SwampDumpReplayPlayer* self, const uint8_t* octets, size_t octetCount,
+                              const struct SwtiType* type, size_t maxStateOctetCount);
+void swampDumpReplayPlayerDestroy(SwampDumpReplayPlayer* self);
+int swampDumpReplayPlayerSeek(SwampDumpReplayPlayer* self, size_t tick, unmanagedTypeCreator creator, void* context,
+                              void* target, struct SwampDynamicMemory* memory,
+                              struct SwampUnmanagedMemory* targetUnmanagedMemory);
+
+#endif
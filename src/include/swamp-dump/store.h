@@ -0,0 +1,47 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_STORE_H
+#define SWAMP_DUMP_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct SwtiType;
+struct SwampDynamicMemory;
+
+/// An encoded value, addressed by a hash of its octets, the swampDumpTypeFingerprint() of its type and the store
+/// threshold. Sub-values that are large enough are not inside the octets, but referenced by their hash.
+typedef struct SwampDumpStoreChunk {
+    uint64_t hash;
+    uint8_t* octets;
+    size_t octetCount;
+} SwampDumpStoreChunk;
+
+typedef struct SwampDumpStore {
+    SwampDumpStoreChunk* chunks;
+    size_t capacity;
+    size_t chunkCount;
+    size_t threshold;
+    size_t storedOctetCount;
+} SwampDumpStore;
+
+/// Lists, arrays, records and blobs that encode to at least `threshold` octets are stored as chunks of their own.
+int swampDumpStoreInit(SwampDumpStore* self, size_t initialCapacity, size_t threshold);
+void swampDumpStoreDestroy(SwampDumpStore* self);
+
+const SwampDumpStoreChunk* swampDumpStoreFind(const SwampDumpStore* self, uint64_t hash);
+
+/// Adds a chunk that was persisted earlier. The octets are copied.
+int swampDumpStoreAdd(SwampDumpStore* self, uint64_t hash, const uint8_t* octets, size_t octetCount);
+
+/// Stores a snapshot in a single walk. Only chunks that the store does not already have are added.
+/// Like Init and Add it returns -3 when it runs out of memory, and the chunks it added before that are kept.
+int swampDumpStoreWrite(SwampDumpStore* self, const void* v, const struct SwtiType* type, uint64_t* rootHash);
+
+/// Reassembles a snapshot from its chunks.
+int swampDumpStoreRead(const SwampDumpStore* self, uint64_t rootHash, const struct SwtiType* type, void* target,
+                       struct SwampDynamicMemory* memory);
+
+#endif
@@ -0,0 +1,76 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_WALK_H
+#define SWAMP_DUMP_WALK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct SwtiType;
+struct SwampDumpTypeDescriptor;
+
+/// Frames a caller usually keeps on its own stack. Deeper values move the frames to the heap.
+#define SWAMP_DUMP_WALK_INLINE_DEPTH (16)
+
+typedef enum SwampDumpWalkResult {
+    SwampDumpWalkContinue = 0,
+    SwampDumpWalkSkip = 1, ///< returned from item(): do not visit this child
+    SwampDumpWalkDone = 2, ///< returned from item(): the composite has no more children
+} SwampDumpWalkResult;
+
+/// One level of the walk. Record, Tuple, Custom, CustomVariant, List and Array are composites and get a frame on
+/// the stack, everything else is a scalar. Aliases are resolved in place and never get a frame of their own.
+typedef struct SwampDumpWalkFrame {
+    const struct SwtiType* type; ///< never an alias
+    const struct SwtiType* alias; ///< the outermost alias that `type` was reached through, zero if none
+    uint8_t* value;
+    const struct SwampDumpTypeDescriptor* descriptor; ///< zero if no published cache knows the type
+
+    /// List and Array items. Filled in from the value when the visitor reads values, otherwise set by enter().
+    uint8_t* items;
+    size_t itemSize;
+
+    size_t count;
+    size_t index;
+    uint8_t variant;
+
+    /// Format state, copied from the parent before item() is called.
+    int flags;
+    int indentation;
+    void* userPointer;
+} SwampDumpWalkFrame;
+
+typedef int (*swampDumpWalkScalarFn)(void* self, SwampDumpWalkFrame* frame);
+typedef int (*swampDumpWalkEnterFn)(void* self, SwampDumpWalkFrame* frame);
+typedef int (*swampDumpWalkItemFn)(void* self, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child);
+typedef int (*swampDumpWalkLeaveFn)(void* self, SwampDumpWalkFrame* frame);
+
+typedef struct SwampDumpWalkVisitor {
+    swampDumpWalkScalarFn scalar;
+    swampDumpWalkEnterFn enter;
+    swampDumpWalkItemFn item;
+    swampDumpWalkLeaveFn leave;
+
+    /// Set when the value memory is initialized (dumping). Cleared when the visitor is filling it in (undumping).
+    int readsValues;
+} SwampDumpWalkVisitor;
+
+typedef struct SwampDumpWalker {
+    const SwampDumpWalkVisitor* visitor;
+    void* self;
+    void* rootUserPointer;
+    SwampDumpWalkFrame* frames;
+    size_t capacity;
+    size_t depth;
+    int ownsFrames;
+} SwampDumpWalker;
+
+/// `frames` is the initial stack, it can be zero. The stack doubles on the heap when a value is nested deeper.
+void swampDumpWalkerInit(SwampDumpWalker* self, SwampDumpWalkFrame* frames, size_t capacity,
+                         const SwampDumpWalkVisitor* visitor, void* visitorSelf);
+void swampDumpWalkerDestroy(SwampDumpWalker* self);
+int swampDumpWalk(SwampDumpWalker* self, const struct SwtiType* type, void* value, int flags, int indentation);
+
+#endif
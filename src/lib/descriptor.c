@@ -0,0 +1,487 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define loadAcquire(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define compareExchange(p, expected, desired)                                                                          \
+    __atomic_compare_exchange_n(p, expected, desired, 1, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)
+#elif defined(_MSC_VER)
+#include <intrin.h>
+// MSVC gives volatile accesses acquire and release semantics (/volatile:ms), interlocked functions are full barriers
+#define loadAcquire(p) (*(SwampDumpDescriptorCache* volatile*) (p))
+static int compareExchange(SwampDumpDescriptorCache** p, SwampDumpDescriptorCache** expected,
+                           SwampDumpDescriptorCache* desired)
+{
+    void* previous = _InterlockedCompareExchangePointer((void* volatile*) p, desired, *expected);
+    if (previous == *expected) {
+        return 1;
+    }
+    *expected = (SwampDumpDescriptorCache*) previous;
+    return 0;
+}
+#else
+#error "swampDumpDescriptorCachePublish needs atomic load and compare exchange"
+#endif
+
+static SwampDumpDescriptorCache* g_publishedCaches;
+
+static size_t hashType(const SwtiType* type)
+{
+    uint64_t v = (uint64_t) (uintptr_t) type;
+    v = (v >> 3) * 0x9E3779B97F4A7C15ull;
+    return (size_t) (v >> 32);
+}
+
+static SwampDumpDescriptorCacheEntry* findEntry(const SwampDumpDescriptorCache* self, const SwtiType* type)
+{
+    size_t mask = self->capacity - 1;
+    size_t index = hashType(type) & mask;
+
+    while (1) {
+        SwampDumpDescriptorCacheEntry* entry = &self->entries[index];
+        if (entry->type == type || entry->type == 0) {
+            return entry;
+        }
+        index = (index + 1) & mask;
+    }
+}
+
+static void insert(SwampDumpDescriptorCache* self, const SwtiType* type)
+{
+    SwampDumpDescriptorCacheEntry* entry = findEntry(self, type);
+    if (entry->type != 0) {
+        return;
+    }
+
+    SwampDumpTypeDescriptor* descriptor = &self->descriptors[self->descriptorCount++];
+    tc_mem_clear_type(descriptor);
+    descriptor->type = type;
+    entry->type = type;
+    entry->descriptor = descriptor;
+}
+
+size_t swampDumpFieldCount(const SwtiType* type)
+{
+    switch (type->type) {
+        case SwtiTypeRecord:
+            return ((const SwtiRecordType*) type)->fieldCount;
+        case SwtiTypeTuple:
+            return ((const SwtiTupleType*) type)->fieldCount;
+        case SwtiTypeCustomVariant:
+            return ((const SwtiCustomTypeVariant*) type)->paramCount;
+        case SwtiTypeAlias:
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+const SwtiType* swampDumpFieldType(const SwtiType* type, size_t index)
+{
+    switch (type->type) {
+        case SwtiTypeRecord:
+            return ((const SwtiRecordType*) type)->fields[index].fieldType;
+        case SwtiTypeTuple:
+            return ((const SwtiTupleType*) type)->fields[index].fieldType;
+        case SwtiTypeCustomVariant:
+            return ((const SwtiCustomTypeVariant*) type)->fields[index].fieldType;
+        case SwtiTypeAlias:
+            return ((const SwtiAliasType*) type)->targetType;
+        case SwtiTypeList:
+            return ((const SwtiListType*) type)->itemType;
+        case SwtiTypeArray:
+            return ((const SwtiArrayType*) type)->itemType;
+        default:
+            return 0;
+    }
+}
+
+/// The types from the one being sized up to the root. A type that contains itself has no fixed size.
+typedef struct FixedOctetPath {
+    const SwtiType* type;
+    const struct FixedOctetPath* parent;
+} FixedOctetPath;
+
+/// With a cache, each size is stored in the descriptor of the type as soon as it is known and `sized` marks it, so
+/// every type is only visited once.
+typedef struct FixedOctetCounter {
+    SwampDumpDescriptorCache* cache;
+    uint8_t* sized;
+} FixedOctetCounter;
+
+static int countFixedOctets(const FixedOctetCounter* self, const SwtiType* type, const FixedOctetPath* parent,
+                            size_t* octetCount)
+{
+    *octetCount = 0;
+    for (const FixedOctetPath* path = parent; path != 0; path = path->parent) {
+        if (path->type == type) {
+            return 0;
+        }
+    }
+
+    const SwampDumpTypeDescriptor* found = self->cache == 0 ? 0 : swampDumpDescriptorCacheFind(self->cache, type);
+    SwampDumpTypeDescriptor* descriptor = found == 0 ? 0 : &self->cache->descriptors[found - self->cache->descriptors];
+    if (descriptor != 0 && self->sized[descriptor - self->cache->descriptors]) {
+        *octetCount = descriptor->fixedOctetCount;
+        return descriptor->hasFixedOctetCount;
+    }
+
+    FixedOctetPath path = {type, parent};
+    int hasFixedOctetCount = 1;
+    size_t total = 0;
+    size_t childOctetCount;
+    switch (type->type) {
+        case SwtiTypeBoolean:
+            total = sizeof(uint8_t);
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            total = sizeof(int32_t);
+            break;
+        case SwtiTypeRecord:
+        case SwtiTypeTuple:
+        case SwtiTypeCustomVariant:
+        case SwtiTypeAlias:
+            for (size_t i = 0; i < swampDumpFieldCount(type) && hasFixedOctetCount; ++i) {
+                hasFixedOctetCount = countFixedOctets(self, swampDumpFieldType(type, i), &path, &childOctetCount);
+                total += childOctetCount;
+            }
+            break;
+        case SwtiTypeCustom: {
+            // Every variant has to encode to the same size after the variant index
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            for (size_t i = 0; i < custom->variantCount && hasFixedOctetCount; ++i) {
+                hasFixedOctetCount = countFixedOctets(self, &custom->variantTypes[i]->internal, &path,
+                                                      &childOctetCount) &&
+                                     (i == 0 || childOctetCount == total);
+                total = childOctetCount;
+            }
+            total += sizeof(uint8_t);
+        } break;
+        default:
+            hasFixedOctetCount = 0;
+            break;
+    }
+
+    if (!hasFixedOctetCount) {
+        total = 0;
+    }
+    if (descriptor != 0) {
+        descriptor->hasFixedOctetCount = hasFixedOctetCount;
+        descriptor->fixedOctetCount = total;
+        self->sized[descriptor - self->cache->descriptors] = 1;
+    }
+    *octetCount = total;
+
+    return hasFixedOctetCount;
+}
+
+int swampDumpTypeIsSimple(const SwtiType* type)
+{
+    enum SwtiTypeValue v = type->type;
+    return (v == SwtiTypeBoolean) || (v == SwtiTypeInt) || (v == SwtiTypeFixed) || (v == SwtiTypeString);
+}
+
+static void setField(const SwampDumpDescriptorCache* self, SwampDumpFieldDescriptor* field, const char* name,
+                     const SwtiType* type, size_t memoryOffset)
+{
+    field->name = name;
+    field->nameLength = name == 0 ? 0 : tc_strlen(name);
+    field->memoryOffset = memoryOffset;
+    field->descriptor = swampDumpDescriptorCacheFind(self, type);
+}
+
+static void fillFields(const SwampDumpDescriptorCache* self, SwampDumpTypeDescriptor* descriptor,
+                       SwampDumpFieldDescriptor* fields)
+{
+    const SwtiType* type = descriptor->type;
+
+    descriptor->fields = fields;
+    descriptor->fieldCount = swampDumpFieldCount(type);
+
+    switch (type->type) {
+        case SwtiTypeRecord: {
+            const SwtiRecordType* record = (const SwtiRecordType*) type;
+            for (size_t i = 0; i < record->fieldCount; ++i) {
+                const SwtiRecordTypeField* field = &record->fields[i];
+                setField(self, &fields[i], field->name, field->fieldType, field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeTuple: {
+            const SwtiTupleType* tuple = (const SwtiTupleType*) type;
+            for (size_t i = 0; i < tuple->fieldCount; ++i) {
+                const SwtiTupleTypeField* field = &tuple->fields[i];
+                setField(self, &fields[i], field->name, field->fieldType, field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeCustomVariant: {
+            const SwtiCustomTypeVariant* variant = (const SwtiCustomTypeVariant*) type;
+            for (size_t i = 0; i < variant->paramCount; ++i) {
+                const SwtiCustomTypeVariantField* field = &variant->fields[i];
+                setField(self, &fields[i], 0, field->fieldType, field->memoryOffsetInfo.memoryOffset);
+            }
+        } break;
+        case SwtiTypeAlias:
+            setField(self, &fields[0], 0, ((const SwtiAliasType*) type)->targetType, 0);
+            break;
+        case SwtiTypeList:
+            setField(self, &fields[0], 0, ((const SwtiListType*) type)->itemType, 0);
+            break;
+        case SwtiTypeArray:
+            setField(self, &fields[0], 0, ((const SwtiArrayType*) type)->itemType, 0);
+            break;
+        default:
+            break;
+    }
+}
+
+/// Returns 1 when the pointer-free flag of the descriptor could be decided, 0 if it depends on a descriptor that is
+/// not resolved yet.
+static int resolve(SwampDumpTypeDescriptor* descriptor, const uint8_t* resolved,
+                   const SwampDumpDescriptorCache* self)
+{
+    switch (descriptor->type->type) {
+        case SwtiTypeBoolean:
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+        case SwtiTypeChar:
+            descriptor->isPointerFree = 1;
+            return 1;
+        case SwtiTypeRecord:
+        case SwtiTypeTuple:
+        case SwtiTypeCustomVariant:
+        case SwtiTypeAlias: {
+            int isPointerFree = 1;
+            for (size_t i = 0; i < descriptor->fieldCount; ++i) {
+                const SwampDumpTypeDescriptor* field = descriptor->fields[i].descriptor;
+                if (field == 0) {
+                    return 1;
+                }
+                if (!resolved[field - self->descriptors]) {
+                    return 0;
+                }
+                isPointerFree = isPointerFree && field->isPointerFree;
+            }
+            descriptor->isPointerFree = isPointerFree;
+            return 1;
+        }
+        case SwtiTypeCustom: {
+            int isPointerFree = 1;
+            for (size_t i = 0; i < descriptor->variantCount; ++i) {
+                const SwampDumpTypeDescriptor* variant = descriptor->variants[i];
+                if (!resolved[variant - self->descriptors]) {
+                    return 0;
+                }
+                isPointerFree = isPointerFree && variant->isPointerFree;
+            }
+            descriptor->isPointerFree = isPointerFree;
+            return 1;
+        }
+        default:
+            return 1;
+    }
+}
+
+static int resolveAll(SwampDumpDescriptorCache* self)
+{
+    uint8_t* resolved = tc_malloc(self->descriptorCount == 0 ? 1 : self->descriptorCount);
+    if (resolved == 0) {
+        return -3;
+    }
+    tc_mem_clear(resolved, self->descriptorCount);
+
+    int progress = 1;
+    while (progress) {
+        progress = 0;
+        for (size_t i = 0; i < self->descriptorCount; ++i) {
+            if (!resolved[i] && resolve(&self->descriptors[i], resolved, self)) {
+                resolved[i] = 1;
+                progress = 1;
+            }
+        }
+    }
+
+    // Whatever is left refers to itself and can not be pointer free
+    tc_mem_clear(resolved, self->descriptorCount);
+    FixedOctetCounter counter = {self, resolved};
+    for (size_t i = 0; i < self->descriptorCount; ++i) {
+        size_t octetCount;
+        countFixedOctets(&counter, self->descriptors[i].type, 0, &octetCount);
+    }
+    tc_free(resolved);
+
+    return 0;
+}
+
+int swampDumpDescriptorCacheInit(SwampDumpDescriptorCache* self, const SwtiChunk* chunk)
+{
+    size_t maxDescriptorCount = chunk->typeCount;
+    size_t variantCount = 0;
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        const SwtiType* type = chunk->types[i];
+        if (type->type == SwtiTypeCustom) {
+            variantCount += ((const SwtiCustomType*) type)->variantCount;
+        }
+    }
+    maxDescriptorCount += variantCount;
+
+    self->capacity = 8;
+    while (self->capacity < maxDescriptorCount * 2) {
+        self->capacity *= 2;
+    }
+    self->entries = tc_malloc_type_count(SwampDumpDescriptorCacheEntry, self->capacity);
+    self->descriptors = tc_malloc_type_count(SwampDumpTypeDescriptor, maxDescriptorCount == 0 ? 1 : maxDescriptorCount);
+    self->descriptorCount = 0;
+    self->fields = 0;
+    self->variants = tc_malloc_type_count(const SwampDumpTypeDescriptor*, variantCount == 0 ? 1 : variantCount);
+    self->nextPublished = 0;
+    self->isPublished = 0;
+    if (self->entries == 0 || self->descriptors == 0 || self->variants == 0) {
+        CLOG_SOFT_ERROR("swampDumpDescriptorCacheInit: out of memory for %zu descriptors", maxDescriptorCount)
+        swampDumpDescriptorCacheDestroy(self);
+        return -3;
+    }
+    tc_mem_clear_type_n(self->entries, self->capacity);
+
+    for (size_t i = 0; i < chunk->typeCount; ++i) {
+        const SwtiType* type = chunk->types[i];
+        insert(self, type);
+        if (type->type == SwtiTypeCustom) {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            for (size_t j = 0; j < custom->variantCount; ++j) {
+                insert(self, &custom->variantTypes[j]->internal);
+            }
+        }
+    }
+
+    size_t totalFieldCount = 0;
+    for (size_t i = 0; i < self->descriptorCount; ++i) {
+        totalFieldCount += swampDumpFieldCount(self->descriptors[i].type);
+    }
+    self->fields = tc_malloc_type_count(SwampDumpFieldDescriptor, totalFieldCount == 0 ? 1 : totalFieldCount);
+    if (self->fields == 0) {
+        CLOG_SOFT_ERROR("swampDumpDescriptorCacheInit: out of memory for %zu fields", totalFieldCount)
+        swampDumpDescriptorCacheDestroy(self);
+        return -3;
+    }
+
+    SwampDumpFieldDescriptor* fields = self->fields;
+    const SwampDumpTypeDescriptor** variants = self->variants;
+    for (size_t i = 0; i < self->descriptorCount; ++i) {
+        SwampDumpTypeDescriptor* descriptor = &self->descriptors[i];
+        const SwtiType* type = descriptor->type;
+
+        descriptor->unaliased = swtiUnalias(type);
+        descriptor->nameLength = type->name == 0 ? 0 : tc_strlen(type->name);
+        descriptor->isSimple = swampDumpTypeIsSimple(type);
+
+        fillFields(self, descriptor, fields);
+        fields += descriptor->fieldCount;
+
+        if (type->type == SwtiTypeCustom) {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            descriptor->variants = variants;
+            descriptor->variantCount = custom->variantCount;
+            for (size_t j = 0; j < custom->variantCount; ++j) {
+                *variants++ = swampDumpDescriptorCacheFind(self, &custom->variantTypes[j]->internal);
+            }
+        }
+    }
+
+    if (resolveAll(self) < 0) {
+        CLOG_SOFT_ERROR("swampDumpDescriptorCacheInit: out of memory while resolving %zu descriptors",
+                        self->descriptorCount)
+        swampDumpDescriptorCacheDestroy(self);
+        return -3;
+    }
+
+    return 0;
+}
+
+void swampDumpDescriptorCacheDestroy(SwampDumpDescriptorCache* self)
+{
+    CLOG_ASSERT(!self->isPublished, "swampDumpDescriptorCacheDestroy: call swampDumpDescriptorCacheUnpublish() first")
+    if (self->isPublished) {
+        return;
+    }
+
+    tc_free(self->entries);
+    tc_free(self->descriptors);
+    tc_free(self->fields);
+    tc_free(self->variants);
+    self->entries = 0;
+    self->descriptors = 0;
+    self->fields = 0;
+    self->variants = 0;
+}
+
+const SwampDumpTypeDescriptor* swampDumpDescriptorCacheFind(const SwampDumpDescriptorCache* self, const SwtiType* type)
+{
+    return findEntry(self, type)->descriptor;
+}
+
+void swampDumpDescriptorCachePublish(SwampDumpDescriptorCache* self)
+{
+    if (self->isPublished) {
+        return;
+    }
+    self->isPublished = 1;
+
+    SwampDumpDescriptorCache* head = loadAcquire(&g_publishedCaches);
+    do {
+        self->nextPublished = head;
+    } while (!compareExchange(&g_publishedCaches, &head, self));
+}
+
+void swampDumpDescriptorCacheUnpublish(SwampDumpDescriptorCache* self)
+{
+    if (!self->isPublished) {
+        return;
+    }
+
+    // Nothing else touches the list now, so plain stores are enough
+    SwampDumpDescriptorCache** link = &g_publishedCaches;
+    while (*link != self) {
+        link = &(*link)->nextPublished;
+    }
+    *link = self->nextPublished;
+    self->nextPublished = 0;
+    self->isPublished = 0;
+}
+
+const SwampDumpTypeDescriptor* swampDumpDescriptorFind(const SwtiType* type)
+{
+    for (const SwampDumpDescriptorCache* cache = loadAcquire(&g_publishedCaches); cache != 0;
+         cache = cache->nextPublished) {
+        const SwampDumpTypeDescriptor* descriptor = swampDumpDescriptorCacheFind(cache, type);
+        if (descriptor != 0) {
+            return descriptor;
+        }
+    }
+
+    return 0;
+}
+
+int swampDumpFixedOctetCount(const SwtiType* type, size_t* octetCount)
+{
+    const SwampDumpTypeDescriptor* descriptor = swampDumpDescriptorFind(type);
+    if (descriptor != 0) {
+        *octetCount = descriptor->fixedOctetCount;
+        return descriptor->hasFixedOctetCount;
+    }
+
+    FixedOctetCounter counter = {0, 0};
+
+    return countFixedOctets(&counter, type, 0, octetCount);
+}
@@ -0,0 +1,299 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/diff.h>
+#include <swamp-dump/dump_ascii.h>
+#include <swamp-dump/format.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+#define DIFF_MAX_PATH_LENGTH (256)
+
+/// Every level below the root appends at least two characters to the path, so all deeper levels have a full path
+/// and can share the last slot.
+#define DIFF_MAX_PATH_DEPTH (DIFF_MAX_PATH_LENGTH / 2 + 2)
+
+typedef struct Differ {
+    FldOutStream* fp;
+    int useColor;
+    int color;
+    const SwampDumpAsciiBudget* valueBudget;
+    char path[DIFF_MAX_PATH_LENGTH];
+    size_t pathLength;
+    size_t pathLengths[DIFF_MAX_PATH_DEPTH];
+    size_t depth;
+    int differenceCount;
+} Differ;
+
+static size_t* pathLengthAt(Differ* self, size_t depth)
+{
+    return &self->pathLengths[depth < DIFF_MAX_PATH_DEPTH ? depth : DIFF_MAX_PATH_DEPTH - 1];
+}
+
+static void appendPath(Differ* self, const char* s, size_t length)
+{
+    if (self->pathLength + length > DIFF_MAX_PATH_LENGTH) {
+        length = DIFF_MAX_PATH_LENGTH - self->pathLength;
+    }
+    tc_memcpy_octets(self->path + self->pathLength, s, length);
+    self->pathLength += length;
+}
+
+static void appendIndex(Differ* self, const char* prefix, size_t index, const char* suffix)
+{
+    char digits[SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT];
+
+    appendPath(self, prefix, tc_strlen(prefix));
+    appendPath(self, digits, swampDumpFormatUInt32(digits, (uint32_t) index));
+    appendPath(self, suffix, tc_strlen(suffix));
+}
+
+static void printToken(Differ* self, SwampDumpAsciiToken token, const char* s, size_t length)
+{
+    if (self->useColor) {
+        swampDumpAsciiWriteColor(self->fp, &self->color, swampDumpAsciiStyleDefault.colors[token]);
+    }
+    fldOutStreamWriteOctets(self->fp, (const uint8_t*) s, length);
+}
+
+static int printValue(Differ* self, const void* v, const SwtiType* type, int flags)
+{
+    if (self->useColor) {
+        // The value leaves whatever color it ended with
+        self->color = SWAMP_DUMP_ASCII_COLOR_UNKNOWN;
+        return swampDumpToAsciiStyled(v, type, flags, 0, &swampDumpAsciiStyleDefault, self->valueBudget, self->fp);
+    }
+
+    return swampDumpToAsciiStyledNoColor(v, type, flags, 0, &swampDumpAsciiStyleDefault, self->valueBudget,
+                                         self->fp);
+}
+
+/// Writes "path: a -> b". A zero value is a missing list item and is left out.
+static int printChange(Differ* self, const void* a, const void* b, const SwtiType* type, int flags)
+{
+    self->differenceCount++;
+
+    printToken(self, SwampDumpAsciiTokenFieldName, self->path, self->pathLength);
+    printToken(self, SwampDumpAsciiTokenAssign, ": ", 2);
+
+    int error = 0;
+    if (a == 0) {
+        printToken(self, SwampDumpAsciiTokenSeparator, "+ ", 2);
+        error = printValue(self, b, type, flags);
+    } else if (b == 0) {
+        printToken(self, SwampDumpAsciiTokenSeparator, "- ", 2);
+        error = printValue(self, a, type, flags);
+    } else if ((error = printValue(self, a, type, flags)) >= 0) {
+        printToken(self, SwampDumpAsciiTokenSeparator, " -> ", 4);
+        error = printValue(self, b, type, flags);
+    }
+
+    printToken(self, SwampDumpAsciiTokenSeparator, "\n", 1);
+
+    return error < 0 ? error : 0;
+}
+
+static const SwtiType* itemTypeOf(const SwtiType* type)
+{
+    return type->type == SwtiTypeList ? ((const SwtiListType*) type)->itemType
+                                      : ((const SwtiArrayType*) type)->itemType;
+}
+
+/// Walks `a`. The userPointer of each frame is the matching value in `b`.
+static int diffScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    Differ* self = (Differ*) voidSelf;
+
+    if (swampDumpEqual(frame->value, frame->userPointer, frame->type)) {
+        return 0;
+    }
+
+    return printChange(self, frame->value, frame->userPointer, frame->type, frame->flags);
+}
+
+static int diffEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    Differ* self = (Differ*) voidSelf;
+
+    switch (frame->type->type) {
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) frame->type;
+            if (frame->variant < custom->variantCount) {
+                const char* name = custom->variantTypes[frame->variant]->name;
+                appendPath(self, ".", 1);
+                appendPath(self, name, tc_strlen(name));
+            }
+            break;
+        }
+        case SwtiTypeList:
+        case SwtiTypeArray: {
+            // SwampArray has the same layout as SwampList
+            const SwampList* listB = *(const SwampList**) frame->userPointer;
+            if (frame->count != listB->count) {
+                self->differenceCount++;
+                printToken(self, SwampDumpAsciiTokenFieldName, self->path, self->pathLength);
+                printToken(self, SwampDumpAsciiTokenAssign, ": ", 2);
+                char digits[SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT];
+                printToken(self, SwampDumpAsciiTokenNumber, digits, swampDumpFormatUInt32(digits, frame->count));
+                printToken(self, SwampDumpAsciiTokenSeparator, " -> ", 4);
+                printToken(self, SwampDumpAsciiTokenNumber, digits, swampDumpFormatUInt32(digits, listB->count));
+                printToken(self, SwampDumpAsciiTokenSeparator, " items\n", 7);
+                if (listB->count < frame->count) {
+                    frame->count = listB->count;
+                }
+            } else if (frame->count == 0 || tc_memcmp(frame->items, listB->value, frame->count * frame->itemSize) == 0) {
+                frame->count = 0;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    self->depth++;
+    *pathLengthAt(self, self->depth) = self->pathLength;
+
+    return 0;
+}
+
+static int diffItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    Differ* self = (Differ*) voidSelf;
+    const uint8_t* parentB = (const uint8_t*) parent->userPointer;
+    size_t i = parent->index;
+
+    if (parent->type->type == SwtiTypeList || parent->type->type == SwtiTypeArray) {
+        const SwampList* listB = *(const SwampList**) parentB;
+        child->userPointer = (uint8_t*) listB->value + i * parent->itemSize;
+    } else {
+        child->userPointer = (uint8_t*) parentB + (child->value - parent->value);
+    }
+
+    // Checked before the path is built, so equal items cost a single memcmp
+    if (tc_memcmp(child->value, child->userPointer, swtiGetMemorySize(child->type)) == 0) {
+        return SwampDumpWalkSkip;
+    }
+
+    self->pathLength = *pathLengthAt(self, self->depth);
+
+    switch (parent->type->type) {
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            appendIndex(self, "[", i, "]");
+            break;
+        case SwtiTypeRecord: {
+            const char* name = ((const SwtiRecordType*) parent->type)->fields[i].name;
+            appendPath(self, ".", 1);
+            appendPath(self, name, tc_strlen(name));
+            break;
+        }
+        case SwtiTypeTuple:
+        case SwtiTypeCustom:
+        case SwtiTypeCustomVariant:
+            appendIndex(self, ".", i, "");
+            break;
+        default:
+            break;
+    }
+
+    if (child->type->type == SwtiTypeCustom && *child->value != *(const uint8_t*) child->userPointer) {
+        int error = printChange(self, child->value, child->userPointer, child->type, child->flags);
+        return error < 0 ? error : SwampDumpWalkSkip;
+    }
+
+    return SwampDumpWalkContinue;
+}
+
+static int diffLeave(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    Differ* self = (Differ*) voidSelf;
+    size_t basePathLength = *pathLengthAt(self, self->depth);
+
+    self->depth--;
+
+    if (frame->type->type != SwtiTypeList && frame->type->type != SwtiTypeArray) {
+        return 0;
+    }
+
+    const SwampList* listA = *(const SwampList**) frame->value;
+    const SwampList* listB = *(const SwampList**) frame->userPointer;
+    if (listA->count == listB->count) {
+        return 0;
+    }
+
+    const SwampList* longer = listA->count > listB->count ? listA : listB;
+    const SwtiType* itemType = itemTypeOf(frame->type);
+
+    for (size_t i = frame->count; i < longer->count; ++i) {
+        self->pathLength = basePathLength;
+        appendIndex(self, "[", i, "]");
+        const uint8_t* item = (const uint8_t*) longer->value + i * longer->itemSize;
+        int error = printChange(self, longer == listA ? item : 0, longer == listB ? item : 0, itemType, frame->flags);
+        if (error < 0) {
+            return error;
+        }
+    }
+
+    return 0;
+}
+
+static const SwampDumpWalkVisitor differ = {diffScalar, diffEnter, diffItem, diffLeave, 1};
+
+static int diffToAscii(const void* a, const void* b, const SwtiType* type, int flags,
+                       const SwampDumpAsciiBudget* valueBudget, FldOutStream* fp, int useColor)
+{
+    Differ self;
+    self.fp = fp;
+    self.useColor = useColor;
+    self.color = SWAMP_DUMP_ASCII_COLOR_UNKNOWN;
+    self.valueBudget = valueBudget;
+    self.pathLength = 0;
+    self.depth = 0;
+    self.differenceCount = 0;
+    appendPath(&self, type->name, tc_strlen(type->name));
+    self.pathLengths[0] = self.pathLength;
+
+    if (a == b || tc_memcmp(a, b, swtiGetMemorySize(type)) == 0) {
+        return 0;
+    }
+
+    int error;
+    if (type->type == SwtiTypeCustom && *(const uint8_t*) a != *(const uint8_t*) b) {
+        error = printChange(&self, a, b, type, flags);
+    } else {
+        SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+        SwampDumpWalker walker;
+        swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &differ, &self);
+        walker.rootUserPointer = (void*) b;
+        error = swampDumpWalk(&walker, type, (void*) a, flags, 0);
+        swampDumpWalkerDestroy(&walker);
+    }
+
+    if (useColor && self.differenceCount > 0) {
+        swampDumpAsciiResetColor(fp, &self.color);
+    }
+    if (error < 0) {
+        CLOG_SOFT_ERROR("swampDumpDiffToAscii: could not diff '%s'", type->name)
+        return error;
+    }
+
+    return self.differenceCount;
+}
+
+int swampDumpDiffToAscii(const void* a, const void* b, const SwtiType* type, int flags,
+                         const SwampDumpAsciiBudget* valueBudget, FldOutStream* fp)
+{
+    return diffToAscii(a, b, type, flags, valueBudget, fp, 1);
+}
+
+int swampDumpDiffToAsciiNoColor(const void* a, const void* b, const SwtiType* type, int flags,
+                                const SwampDumpAsciiBudget* valueBudget, FldOutStream* fp)
+{
+    return diffToAscii(a, b, type, flags, valueBudget, fp, 0);
+}
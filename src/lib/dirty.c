@@ -0,0 +1,258 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dirty.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-runtime/swamp_allocate.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+/// Frame flags. The record was changed as a whole, so every field is written.
+#define DIRTY_WRITE_ALL (0x01)
+/// The next field of the record to visit is a record that asks about its own fields.
+#define DIRTY_DESCEND_NEXT (0x02)
+
+static const SwtiRecordType* recordTypeOf(const SwtiType* type)
+{
+    const SwtiType* unaliased = swtiUnalias(type);
+    return unaliased->type == SwtiTypeRecord ? (const SwtiRecordType*) unaliased : 0;
+}
+
+/// Only records are entered, everything else is written or read whole in item(), so no scalar is ever reached.
+static int unexpectedScalar(void* self, SwampDumpWalkFrame* frame)
+{
+    (void) self;
+
+    CLOG_SOFT_ERROR("swamp-dump: dirty dumps only walk records, not '%s'", frame->type->name)
+    return -1;
+}
+
+typedef struct DirtyWriter {
+    FldOutStream* stream;
+    swampDumpNextChangedFieldFn nextChanged;
+    void* context;
+} DirtyWriter;
+
+/// Returns the first changed field at or after `fieldIndex`, or the field count, and remembers in the frame if that
+/// field descends.
+static int findChangedField(DirtyWriter* self, SwampDumpWalkFrame* frame, size_t fieldIndex, size_t* found)
+{
+    SwampDumpFieldChange change = SwampDumpFieldChanged;
+
+    if (fieldIndex >= frame->count) {
+        *found = frame->count;
+    } else if (frame->flags & DIRTY_WRITE_ALL) {
+        *found = fieldIndex;
+    } else {
+        *found = self->nextChanged(self->context, (const SwtiRecordType*) frame->type, frame->value, fieldIndex,
+                                   &change);
+        if (*found < fieldIndex || *found > frame->count) {
+            CLOG_SOFT_ERROR("swampDumpToOctetsDirty: field %zu of '%s' is not at or after field %zu", *found,
+                            frame->type->name, fieldIndex)
+            return -1;
+        }
+    }
+
+    frame->flags = change == SwampDumpFieldDescend ? (frame->flags | DIRTY_DESCEND_NEXT)
+                                                   : (frame->flags & ~DIRTY_DESCEND_NEXT);
+
+    return 0;
+}
+
+/// Reserves the presence mask of the record. The walk starts at the first changed field.
+static int writeEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    DirtyWriter* self = (DirtyWriter*) voidSelf;
+    FldOutStream* stream = self->stream;
+
+    size_t maskOctetCount = (frame->count + 7) / 8;
+    if (stream->size - stream->pos < maskOctetCount) {
+        return -1;
+    }
+    frame->userPointer = stream->p;
+    tc_mem_clear(stream->p, maskOctetCount);
+    stream->p += maskOctetCount;
+    stream->pos += maskOctetCount;
+
+    return findChangedField(self, frame, 0, &frame->index);
+}
+
+/// Every child is a changed field. The parent continues at the changed field after it.
+static int writeItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    DirtyWriter* self = (DirtyWriter*) voidSelf;
+    size_t i = parent->index;
+
+    uint8_t* mask = (uint8_t*) parent->userPointer;
+    mask[i / 8] |= (uint8_t) (1 << (i % 8));
+    child->flags = (parent->flags & DIRTY_DESCEND_NEXT) ? 0 : DIRTY_WRITE_ALL;
+
+    size_t next;
+    int error = findChangedField(self, parent, i + 1, &next);
+    if (error < 0) {
+        return error;
+    }
+    parent->index = next - 1;
+
+    if (child->type->type == SwtiTypeRecord) {
+        return SwampDumpWalkContinue;
+    }
+    if ((error = swampDumpToOctetsRaw(self->stream, child->value, child->type)) < 0) {
+        return error;
+    }
+
+    return SwampDumpWalkSkip;
+}
+
+static const SwampDumpWalkVisitor dirtyWriter = {unexpectedScalar, writeEnter, writeItem, 0, 1};
+
+int swampDumpToOctetsDirty(FldOutStream* stream, const void* v, const SwtiType* type,
+                           swampDumpNextChangedFieldFn nextChanged, void* context)
+{
+    if (recordTypeOf(type) == 0) {
+        CLOG_SOFT_ERROR("swampDumpToOctetsDirty: '%s' is not a record", type->name)
+        return -2;
+    }
+
+    fldOutStreamWriteUInt8(stream, 0);
+    fldOutStreamWriteUInt8(stream, 3);
+    int error = fldOutStreamWriteUInt8(stream, 0);
+    if (error < 0) {
+        return error;
+    }
+
+    DirtyWriter writer;
+    writer.stream = stream;
+    writer.nextChanged = nextChanged;
+    writer.context = context;
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &dirtyWriter, &writer);
+    error = swampDumpWalk(&walker, type, (void*) v, 0, 0);
+    swampDumpWalkerDestroy(&walker);
+
+    return error;
+}
+
+/// Returns the index of the first set bit at or after `index`, or `count` if there is none. Whole octets without
+/// any bit set are passed in one step.
+static size_t nextSetBit(const uint8_t* mask, size_t index, size_t count)
+{
+    while (index < count) {
+        uint8_t octet = (uint8_t) (mask[index / 8] >> (index % 8));
+        if (octet == 0) {
+            index = (index / 8 + 1) * 8;
+            continue;
+        }
+        while (!(octet & 1)) {
+            octet >>= 1;
+            index++;
+        }
+        return index < count ? index : count;
+    }
+
+    return count;
+}
+
+static size_t nextFromMask(void* context, const SwtiRecordType* recordType, const void* record, size_t fieldIndex,
+                           SwampDumpFieldChange* change)
+{
+    (void) record;
+
+    *change = SwampDumpFieldChanged;
+    return nextSetBit((const uint8_t*) context, fieldIndex, recordType->fieldCount);
+}
+
+int swampDumpToOctetsDirtyMask(FldOutStream* stream, const void* v, const SwtiType* type, const uint8_t* dirtyMask)
+{
+    return swampDumpToOctetsDirty(stream, v, type, nextFromMask, (void*) dirtyMask);
+}
+
+typedef struct DirtyMerger {
+    FldInStream* inStream;
+    unmanagedTypeCreator creator;
+    void* context;
+    SwampDynamicMemory* memory;
+    SwampUnmanagedMemory* targetUnmanagedMemory;
+} DirtyMerger;
+
+/// Reads the presence mask of the record. The walk starts at the first field that is present.
+static int mergeEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    DirtyMerger* self = (DirtyMerger*) voidSelf;
+    FldInStream* inStream = self->inStream;
+
+    size_t maskOctetCount = (frame->count + 7) / 8;
+    if (inStream->size - inStream->pos < maskOctetCount) {
+        CLOG_SOFT_ERROR("swampDumpFromOctetsDirtyMerge: mask for '%s' is truncated", frame->type->name)
+        return -3;
+    }
+    frame->userPointer = (void*) inStream->p;
+    inStream->p += maskOctetCount;
+    inStream->pos += maskOctetCount;
+    frame->index = nextSetBit((const uint8_t*) frame->userPointer, 0, frame->count);
+
+    return 0;
+}
+
+/// Every child is a field that is present. The parent continues at the present field after it.
+static int mergeItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    DirtyMerger* self = (DirtyMerger*) voidSelf;
+
+    parent->index = nextSetBit((const uint8_t*) parent->userPointer, parent->index + 1, parent->count) - 1;
+    if (child->type->type == SwtiTypeRecord) {
+        return SwampDumpWalkContinue;
+    }
+
+    int error = swampDumpFromOctetsRaw(self->inStream, child->type, self->creator, self->context, child->value,
+                                       self->memory, self->targetUnmanagedMemory);
+
+    return error < 0 ? error : SwampDumpWalkSkip;
+}
+
+static const SwampDumpWalkVisitor dirtyMerger = {unexpectedScalar, mergeEnter, mergeItem, 0, 0};
+
+int swampDumpFromOctetsDirtyMerge(FldInStream* inStream, const SwtiType* type, unmanagedTypeCreator creator,
+                                  void* context, void* target, SwampDynamicMemory* memory,
+                                  SwampUnmanagedMemory* targetUnmanagedMemory)
+{
+    if (recordTypeOf(type) == 0) {
+        CLOG_SOFT_ERROR("swampDumpFromOctetsDirtyMerge: '%s' is not a record", type->name)
+        return -2;
+    }
+
+    uint8_t major, minor, patch;
+    fldInStreamReadUInt8(inStream, &major);
+    fldInStreamReadUInt8(inStream, &minor);
+    int error = fldInStreamReadUInt8(inStream, &patch);
+    if (error < 0) {
+        return error;
+    }
+    if (major != 0 || minor != 3) {
+        CLOG_SOFT_ERROR("swamp-dump: wrong version %d.%d.%d for a dirty dump", major, minor, patch)
+        return -1;
+    }
+
+    DirtyMerger merger;
+    merger.inStream = inStream;
+    merger.creator = creator;
+    merger.context = context;
+    merger.memory = memory;
+    merger.targetUnmanagedMemory = targetUnmanagedMemory;
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &dirtyMerger, &merger);
+    error = swampDumpWalk(&walker, type, target, 0, 0);
+    swampDumpWalkerDestroy(&walker);
+
+    return error;
+}
@@ -4,71 +4,233 @@
  *--------------------------------------------------------------------------------------------*/
 #include <clog/clog.h>
 #include <flood/out_stream.h>
-#include <stdarg.h>
 #include <swamp-dump/dump_ascii.h>
+#include <swamp-dump/dump_ascii_no_color.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-dump/format.h>
 #include <swamp-dump/types.h>
+#include <swamp-dump/walk.h>
 #include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
 
-static void printTabs(FldOutStream* fp, int indentation)
+const SwampDumpAsciiStyle swampDumpAsciiStyleDefault = {
+    {92, 91, 33, 94, 35, 92, 32, 93, 95, 37, 12},
+    "    ",
+    "..",
+    ", ",
+    " = ",
+    2048,
+};
+
+typedef struct AsciiPrinter {
+    FldOutStream* fp;
+    const SwampDumpAsciiStyle* style;
+    int color;
+    size_t indentationLength;
+    size_t blobIndentationLength;
+    size_t separatorLength;
+    size_t assignLength;
+    SwampDumpAsciiBudget budget;
+    size_t octetLimit;
+    size_t depth;
+    int isExhausted;
+} AsciiPrinter;
+
+#define ASCII_BLOB_HEX_ROW (32)
+#define ASCII_BLOB_TEXT_ROW (64)
+#define ASCII_NO_LIMIT ((size_t) -1)
+
+/// The engine below is shared by the colored and the no-color dumpers. `useColor` is always a constant at the
+/// visitor entry points, so the compiler specializes the no-color visitor without any color handling.
+#define ASCII_WITH_COLOR (1)
+#define ASCII_NO_COLOR (0)
+
+static void printTabs(AsciiPrinter* self, int indentation)
 {
     for (size_t i = 0; i < indentation; ++i) {
-        fldOutStreamWriteOctets(fp, (const uint8_t*)"    ", 4);
+        fldOutStreamWriteOctets(self->fp, (const uint8_t*) self->style->indentation, self->indentationLength);
     }
 }
 
-static void printNewLineWithTabs(FldOutStream* fp, int indentation)
+static void printNewLineWithTabs(AsciiPrinter* self, int indentation)
 {
-    fldOutStreamWriteUInt8(fp, '\n');
-    printTabs(fp, indentation);
+    fldOutStreamWriteUInt8(self->fp, '\n');
+    printTabs(self, indentation);
 }
 
-static void printDots(FldOutStream* fp, int indentation)
+static void printNewLineWithDots(AsciiPrinter* self, int indentation)
 {
+    fldOutStreamWriteUInt8(self->fp, '\n');
     for (size_t i = 0; i < indentation; ++i) {
-        fldOutStreamWriteOctets(fp, (const uint8_t*) "..", 2);
+        fldOutStreamWriteOctets(self->fp, (const uint8_t*) self->style->blobIndentation, self->blobIndentationLength);
     }
 }
 
-static void printNewLineWithDots(FldOutStream* fp, int indentation)
+void swampDumpAsciiWriteColor(FldOutStream* fp, int* activeColor, int color)
 {
-    fldOutStreamWriteUInt8(fp, '\n');
-    printDots(fp, indentation);
+    if (*activeColor == color) {
+        return;
+    }
+    *activeColor = color;
+
+    uint8_t escape[6] = {'\033', '['};
+    size_t pos = 2;
+    if (color >= 10) {
+        escape[pos++] = (uint8_t) ('0' + color / 10 % 10);
+    }
+    escape[pos++] = (uint8_t) ('0' + color % 10);
+    escape[pos++] = 'm';
+
+    fldOutStreamWriteOctets(fp, escape, pos);
 }
 
-static void printWithColorf(FldOutStream* fp, int fg, const char* s, ...)
+void swampDumpAsciiResetColor(FldOutStream* fp, int* activeColor)
 {
-    va_list pl;
+    fldOutStreamWriteOctets(fp, (const uint8_t*) "\033[0m", 4);
+    *activeColor = SWAMP_DUMP_ASCII_COLOR_UNKNOWN;
+}
 
-    fldOutStreamWritef(fp, "\033[%dm", fg);
+static void setColor(AsciiPrinter* self, int useColor, SwampDumpAsciiToken token)
+{
+    if (useColor) {
+        swampDumpAsciiWriteColor(self->fp, &self->color, self->style->colors[token]);
+    }
+}
 
-    va_start(pl, s);
-    fldOutStreamWritevf(fp, s, pl);
-    va_end(pl);
+static void printToken(AsciiPrinter* self, int useColor, SwampDumpAsciiToken token, const char* s, size_t length)
+{
+    setColor(self, useColor, token);
+    fldOutStreamWriteOctets(self->fp, (const uint8_t*) s, length);
 }
 
-static int typeIsSimple(const SwtiType* type)
+#define printLiteral(self, useColor, token, literal) printToken(self, useColor, token, literal, sizeof(literal) - 1)
+
+static void printName(AsciiPrinter* self, int useColor, SwampDumpAsciiToken token, const char* name)
 {
-    enum SwtiTypeValue v = type->type;
-    return (v == SwtiTypeBoolean) || (v == SwtiTypeInt) || (v == SwtiTypeFixed) || (v == SwtiTypeString);
+    printToken(self, useColor, token, name, tc_strlen(name));
 }
 
-int swampDumpToAscii(const uint8_t * v, const SwtiType* type, int flags, int indentation, FldOutStream* fp)
+/// Checked before every token, so the walk ends at the first token boundary after the octet budget is spent.
+static int isExhausted(AsciiPrinter* self)
+{
+    if (!self->isExhausted && self->fp->pos >= self->octetLimit) {
+        self->isExhausted = 1;
+    }
+
+    return self->isExhausted;
+}
+
+static size_t limitOf(size_t budget)
+{
+    return budget == 0 ? ASCII_NO_LIMIT : budget;
+}
+
+static void printUInt32(FldOutStream* fp, uint32_t value)
+{
+    char text[SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT];
+
+    fldOutStreamWriteOctets(fp, (const uint8_t*) text, swampDumpFormatUInt32(text, value));
+}
+
+static void printInt32(FldOutStream* fp, int32_t value)
+{
+    char text[SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT];
+
+    fldOutStreamWriteOctets(fp, (const uint8_t*) text, swampDumpFormatInt32(text, value));
+}
+
+static void printFixed32(FldOutStream* fp, int32_t value)
+{
+    char text[SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT];
+
+    fldOutStreamWriteOctets(fp, (const uint8_t*) text, swampDumpFormatFixed32(text, value));
+}
+
+/// Formats a whole row as "XX XX .." and writes it with a single octet copy.
+static void printHexRow(FldOutStream* fp, const uint8_t* octets, size_t count)
+{
+    char pairs[ASCII_BLOB_HEX_ROW * 2];
+    uint8_t row[ASCII_BLOB_HEX_ROW * 3];
+
+    swampDumpFormatHexPairs(pairs, octets, count);
+    for (size_t i = 0; i < count; ++i) {
+        row[i * 3] = (uint8_t) pairs[i * 2];
+        row[i * 3 + 1] = (uint8_t) pairs[i * 2 + 1];
+        row[i * 3 + 2] = ' ';
+    }
+
+    fldOutStreamWriteOctets(fp, row, count * 3);
+}
+
+/// Only the bracketed composites are levels of the depth budget, custom types and their variants are not.
+static int typeIsLevel(const SwtiType* type)
 {
+    switch (type->type) {
+        case SwtiTypeRecord:
+        case SwtiTypeTuple:
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/// Aliases do not get a frame, so the alias names are printed in front of the target value. The "once" flag only
+/// covers the outermost alias and is not passed on to the items of the target.
+static void printAliases(AsciiPrinter* self, int useColor, SwampDumpWalkFrame* frame)
+{
+    int flags = frame->flags;
+
+    for (const SwtiType* type = frame->alias; type != 0 && type->type == SwtiTypeAlias;
+         type = ((const SwtiAliasType*) type)->targetType) {
+        if (flags & swampDumpFlagAlias || flags & swampDumpFlagAliasOnce) {
+            printName(self, useColor, SwampDumpAsciiTokenKeyword, type->name);
+            printLiteral(self, useColor, SwampDumpAsciiTokenNumber, " => ");
+        }
+        flags &= ~swampDumpFlagAliasOnce;
+    }
+
+    if (frame->alias != 0) {
+        frame->flags &= ~swampDumpFlagAliasOnce;
+    }
+}
+
+static int printScalar(AsciiPrinter* self, int useColor, SwampDumpWalkFrame* frame)
+{
+    FldOutStream* fp = self->fp;
+    const uint8_t* v = frame->value;
+    const SwtiType* type = frame->type;
+    int flags = frame->flags;
+    int indentation = frame->indentation;
+
+    if (isExhausted(self)) {
+        return 0;
+    }
+
+    printAliases(self, useColor, frame);
+
     switch (type->type) {
         case SwtiTypeBoolean: {
             SwampBool value = *((const SwampBool*)v);
-            printWithColorf(fp, 92, "%s", value ? "True" : "False");
+            if (value) {
+                printLiteral(self, useColor, SwampDumpAsciiTokenKeyword, "True");
+            } else {
+                printLiteral(self, useColor, SwampDumpAsciiTokenKeyword, "False");
+            }
         } break;
         case SwtiTypeInt: {
             SwampInt32 value = *((const SwampInt32 *)v);
 
-            printWithColorf(fp, 91, "%d", value);
+            setColor(self, useColor, SwampDumpAsciiTokenNumber);
+            printInt32(fp, value);
         } break;
 
         case SwtiTypeFixed: {
             SwampFixed32 value = *((const SwampFixed32 *)v);
 
-            printWithColorf(fp, 91, "%.3f", value / (float)SWAMP_FIXED_FACTOR);
+            setColor(self, useColor, SwampDumpAsciiTokenNumber);
+            printFixed32(fp, value);
         } break;
         case SwtiTypeString: {
             const SwampString* p = *((const SwampString**)v);
@@ -76,197 +238,70 @@ int swampDumpToAscii(const uint8_t * v, const SwtiType* type, int flags, int ind
                 CLOG_ERROR("can not have these long strings")
             }
             if (!(flags & swampDumpFlagNoStringQuotesOnce)) {
-                printWithColorf(fp, 91, "\"");
+                printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "\"");
             }
-            printWithColorf(fp, 33, "%s", p->characters);
-            if (!(flags & swampDumpFlagNoStringQuotesOnce)) {
-                printWithColorf(fp, 91, "\"");
+            if (p->characterCount > self->budget.maxPreviewLength) {
+                printToken(self, useColor, SwampDumpAsciiTokenText, p->characters, self->budget.maxPreviewLength);
+                printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "...");
+            } else {
+                printToken(self, useColor, SwampDumpAsciiTokenText, p->characters, p->characterCount);
             }
-        } break;
-        case SwtiTypeRecord: {
-            const SwtiRecordType* record = (const SwtiRecordType*) type;
-            printWithColorf(fp, 94, "{ ", fp);
-            for (size_t i = 0; i < record->fieldCount; i++) {
-                const SwtiRecordTypeField* field = &record->fields[i];
-                if (i > 0) {
-                    if (!typeIsSimple(field->fieldType)) {
-                        printNewLineWithTabs(fp, indentation);
-                    }
-                    printWithColorf(fp, 35, ", ");
-                }
-                printWithColorf(fp, 92, field->name);
-                printWithColorf(fp, 32, " = ");
-                int errorCode = swampDumpToAscii(v + field->memoryOffsetInfo.memoryOffset, field->fieldType, flags, indentation + 1, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
-            }
-            printWithColorf(fp, 94, " }");
-        } break;
-        case SwtiTypeArray: {
-            const SwtiArrayType* arrayType = ((const SwtiArrayType*) type);
-            const SwampArray* array = *(const SwampArray**) v;
-
-            const uint8_t* p = array->value;
-            printWithColorf(fp, 94, "[| ", fp);
-            for (size_t i = 0; i < array->count; i++) {
-                if (i > 0) {
-                    printNewLineWithTabs(fp, indentation);
-                    printWithColorf(fp, 35, ", ");
-                }
-                int errorCode = swampDumpToAscii(p, arrayType->itemType, flags, indentation + 1, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
-
-                p += array->itemSize;
-            }
-            printWithColorf(fp, 94, " |]");
-        } break;
-        case SwtiTypeList: {
-            const SwampList* list = *((const SwampList**) v);
-            const SwtiListType* listType = (const SwtiListType*) type;
-
-            printWithColorf(fp, 94, "[ ", fp);
-            const uint8_t* itemPointer = list->value;
-            for (size_t i=0; i<list->count; ++i) {
-                if (i > 0) {
-                    printNewLineWithTabs(fp, indentation);
-                    printWithColorf(fp, 35, ", ");
-                }
-                int errorCode = swampDumpToAscii(itemPointer, listType->itemType, flags, indentation + 1, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
-                itemPointer += list->itemSize;
-            }
-            printWithColorf(fp, 94, " ]");
-        } break;
-        case SwtiTypeTuple: {
-            const SwtiTupleType* tuple = (const SwtiTupleType*) type;
-
-            printWithColorf(fp, 94, "( ", fp);
-            for (size_t i = 0; i < tuple->fieldCount; i++) {
-                const SwtiTupleTypeField* field = &tuple->fields[i];
-                if (i > 0) {
-                    printNewLineWithTabs(fp, indentation);
-                    printWithColorf(fp, 35, ", ");
-                }
-                int errorCode = swampDumpToAscii(v + field->memoryOffsetInfo.memoryOffset, field->fieldType, flags | swampDumpFlagAliasOnce,
-                                                 indentation + 1, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
+            if (!(flags & swampDumpFlagNoStringQuotesOnce)) {
+                printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "\"");
             }
-            printWithColorf(fp, 94, " )");
         } break;
-
         case SwtiTypeFunction:
             CLOG_SOFT_ERROR("can not dump functions")
             return -1;
         case SwtiTypeUnmanaged: {
             const SwampUnmanaged* unmanaged = *(const SwampUnmanaged**) v;
-            printWithColorf(fp, 94, "< (%p) ", (void*)unmanaged);
+            setColor(self, useColor, SwampDumpAsciiTokenBracket);
+            fldOutStreamWritef(fp, "< (%p) ", (void*)unmanaged);
             if (unmanaged->toString) {
                 size_t writtenCharacterCount = unmanaged->toString(unmanaged->ptr, 0, (char*)fp->p, fp->size - fp->pos - 8);
                 fp->pos += writtenCharacterCount;
                 fp->p += writtenCharacterCount;
             }
-            printWithColorf(fp, 94, ">");
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, ">");
             return 0;
         }
-        case SwtiTypeAlias: {
-            const SwtiAliasType* alias = (const SwtiAliasType*) type;
-            if (flags & swampDumpFlagAlias || flags & swampDumpFlagAliasOnce) {
-                printWithColorf(fp, 92, alias->internal.name);
-                printWithColorf(fp, 91, " => ");
-            }
-            int errorCode = swampDumpToAscii(v, alias->targetType, flags & ~swampDumpFlagAliasOnce, indentation + 1,
-                                             fp);
-            if (errorCode != 0) {
-                return errorCode;
-            }
-            break;
-        }
         case SwtiTypeRefId: {
             const SwtiTypeRefIdType* typeRefId = (const SwtiTypeRefIdType *) type;
             SwampInt32 value = *((const SwampInt32 *)v);
 
-            printWithColorf(fp, 92, "$");
-            printWithColorf(fp, 91, typeRefId->referencedType->name);
-            printWithColorf(fp, 92, "(%d)", value);
+            printLiteral(self, useColor, SwampDumpAsciiTokenKeyword, "$");
+            printName(self, useColor, SwampDumpAsciiTokenNumber, typeRefId->referencedType->name);
+            printLiteral(self, useColor, SwampDumpAsciiTokenKeyword, "(");
+            printInt32(fp, value);
+            fldOutStreamWriteUInt8(fp, ')');
         } break;
-        case SwtiTypeCustom: {
-            const SwtiCustomType* custom = (const SwtiCustomType*) type;
-            const uint8_t* p = (const uint8_t*)v;
-            if (*p >= custom->variantCount) {
-                CLOG_ERROR("swampDumpToAscii: illegal variant index %d", *p);
-            }
-            const SwtiCustomTypeVariant* variant = custom->variantTypes[*p];
-            if (flags & swampDumpFlagCustomTypeVariantPrefix) {
-                printWithColorf(fp, 91, custom->internal.name);
-                printWithColorf(fp, 93, ":");
-            }
-            printWithColorf(fp, 95, variant->name);
-            for (size_t i = 0; i < variant->paramCount; ++i) {
-                printWithColorf(fp, 91, " ");
-                const SwtiCustomTypeVariantField* field = &variant->fields[i];
-                int errorCode = swampDumpToAscii(p + field->memoryOffsetInfo.memoryOffset, field->fieldType, flags, indentation + 1, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
-            }
-            break;
-        }
-        case SwtiTypeCustomVariant: {
-            const SwtiCustomTypeVariant * variant = (const SwtiCustomTypeVariant*) type;
-            if (flags & swampDumpFlagCustomTypeVariantPrefix) {
-                printWithColorf(fp, 91, variant->internal.name);
-                printWithColorf(fp, 93, ":");
-            }
-            printWithColorf(fp, 95, variant->name);
-            for (size_t i = 0; i < variant->paramCount; ++i) {
-                printWithColorf(fp, 91, " ");
-                const SwtiCustomTypeVariantField* field = &variant->fields[i];
-                int errorCode = swampDumpToAscii(v + field->memoryOffsetInfo.memoryOffset, field->fieldType, flags, indentation + 1, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
-            }
-            break;
-        }
         case SwtiTypeBlob: {
             const SwampBlob* blob = *((const SwampBlob**) v);
-            printWithColorf(fp, 91, "blob %d", blob->octetCount);
+            printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "blob ");
+            printUInt32(fp, (uint32_t) blob->octetCount);
 
             if (flags & swampDumpFlagBlobExpanded) {
-                size_t count = blob->octetCount > 2048 ? 2048 : blob->octetCount;
-                if (flags & swampDumpFlagBlobAutoFormat) {
-                    int allIsPrintable = 1;
-                    for (size_t i = 0; i < count; ++i) {
-                        uint8_t ch = blob->octets[i];
-                        if (ch < 32 || ch > 126) {
-                            allIsPrintable = 0;
-                            break;
-                        }
-                    }
-                    if (allIsPrintable) {
-                        flags |= swampDumpFlagBlobAscii;
-                    }
+                size_t limit = self->style->blobOctetLimit;
+                if (limit > self->budget.maxPreviewLength) {
+                    limit = self->budget.maxPreviewLength;
+                }
+                size_t count = blob->octetCount > limit ? limit : blob->octetCount;
+                if ((flags & swampDumpFlagBlobAutoFormat) && swampDumpOctetsArePrintable(blob->octets, count)) {
+                    flags |= swampDumpFlagBlobAscii;
                 }
                 if (flags & swampDumpFlagBlobAscii) {
-                    for (size_t i = 0; i < count; ++i) {
-                        if ((i % 64) == 0) {
-                            printNewLineWithDots(fp, indentation + 1);
-                        }
-                        printWithColorf(fp, 37, "%c", blob->octets[i]);
+                    setColor(self, useColor, SwampDumpAsciiTokenBlobText);
+                    for (size_t i = 0; i < count; i += ASCII_BLOB_TEXT_ROW) {
+                        printNewLineWithDots(self, indentation + 1);
+                        size_t rowCount = count - i > ASCII_BLOB_TEXT_ROW ? ASCII_BLOB_TEXT_ROW : count - i;
+                        fldOutStreamWriteOctets(fp, blob->octets + i, rowCount);
                     }
                 } else {
-                    for (size_t i = 0; i < count; ++i) {
-                        if ((i % 32) == 0) {
-                            printNewLineWithDots(fp, indentation + 1);
-                        }
-                        printWithColorf(fp, 12, "%02X ", blob->octets[i]);
+                    setColor(self, useColor, SwampDumpAsciiTokenBlobHex);
+                    for (size_t i = 0; i < count; i += ASCII_BLOB_HEX_ROW) {
+                        printNewLineWithDots(self, indentation + 1);
+                        size_t rowCount = count - i > ASCII_BLOB_HEX_ROW ? ASCII_BLOB_HEX_ROW : count - i;
+                        printHexRow(fp, blob->octets + i, rowCount);
                     }
                 }
             }
@@ -274,22 +309,23 @@ int swampDumpToAscii(const uint8_t * v, const SwtiType* type, int flags, int ind
         }
         case SwtiTypeChar: {
             SwampCharacter ordinalValue = *((const SwampCharacter *)v);
-            printWithColorf(fp, 91, "'");
-            printWithColorf(fp, 33, "%c", (char) ordinalValue);
-            printWithColorf(fp, 91, "'");
+            printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "'");
+            setColor(self, useColor, SwampDumpAsciiTokenText);
+            fldOutStreamWriteUInt8(fp, (uint8_t) ordinalValue);
+            printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "'");
             break;
         }
 
         case SwtiTypeAny: {
-            printWithColorf(fp, 91, "ANY");
+            printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "ANY");
             break;
         }
         case SwtiTypeAnyMatchingTypes: {
-            printWithColorf(fp, 91, "*");
+            printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "*");
             break;
         }
         case SwtiTypeResourceName: {
-            printWithColorf(fp, 33, "@");
+            printLiteral(self, useColor, SwampDumpAsciiTokenText, "@");
             break;
         }
 
@@ -301,7 +337,295 @@ int swampDumpToAscii(const uint8_t * v, const SwtiType* type, int flags, int ind
     return 0;
 }
 
+static int printEnter(AsciiPrinter* self, int useColor, SwampDumpWalkFrame* frame)
+{
+    const SwtiType* type = frame->type;
+    int flags = frame->flags;
+
+    if (typeIsLevel(type)) {
+        self->depth++;
+    }
+    if (isExhausted(self)) {
+        return 0;
+    }
+
+    printAliases(self, useColor, frame);
+    flags = frame->flags;
+
+    switch (type->type) {
+        case SwtiTypeRecord:
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, "{ ");
+            break;
+        case SwtiTypeArray:
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, "[| ");
+            break;
+        case SwtiTypeList:
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, "[ ");
+            break;
+        case SwtiTypeTuple:
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, "( ");
+            break;
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            if (frame->variant >= custom->variantCount) {
+                CLOG_ERROR("swampDumpToAscii: illegal variant index %d", frame->variant);
+            }
+            const SwtiCustomTypeVariant* variant = custom->variantTypes[frame->variant];
+            if (flags & swampDumpFlagCustomTypeVariantPrefix) {
+                printName(self, useColor, SwampDumpAsciiTokenNumber, custom->internal.name);
+                printLiteral(self, useColor, SwampDumpAsciiTokenColon, ":");
+            }
+            printName(self, useColor, SwampDumpAsciiTokenVariant, variant->name);
+            break;
+        }
+        case SwtiTypeCustomVariant: {
+            const SwtiCustomTypeVariant * variant = (const SwtiCustomTypeVariant*) type;
+            if (flags & swampDumpFlagCustomTypeVariantPrefix) {
+                printName(self, useColor, SwampDumpAsciiTokenNumber, variant->internal.name);
+                printLiteral(self, useColor, SwampDumpAsciiTokenColon, ":");
+            }
+            printName(self, useColor, SwampDumpAsciiTokenVariant, variant->name);
+            break;
+        }
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static int printItem(AsciiPrinter* self, int useColor, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    size_t i = parent->index;
+
+    child->indentation = parent->indentation + 1;
+
+    if (isExhausted(self)) {
+        return SwampDumpWalkDone;
+    }
+
+    switch (parent->type->type) {
+        case SwtiTypeRecord: {
+            const SwtiRecordTypeField* field = &((const SwtiRecordType*) parent->type)->fields[i];
+            int isSimple = child->descriptor ? child->descriptor->isSimple : swampDumpTypeIsSimple(field->fieldType);
+            if (i > 0) {
+                if (!isSimple) {
+                    printNewLineWithTabs(self, parent->indentation);
+                }
+                printToken(self, useColor, SwampDumpAsciiTokenSeparator, self->style->separator, self->separatorLength);
+            }
+            size_t nameLength = parent->descriptor ? parent->descriptor->fields[i].nameLength : tc_strlen(field->name);
+            printToken(self, useColor, SwampDumpAsciiTokenFieldName, field->name, nameLength);
+            printToken(self, useColor, SwampDumpAsciiTokenAssign, self->style->assign, self->assignLength);
+            break;
+        }
+        case SwtiTypeTuple:
+            child->flags |= swampDumpFlagAliasOnce;
+            // Intentional fall through
+        case SwtiTypeArray:
+        case SwtiTypeList:
+            if (i > 0) {
+                printNewLineWithTabs(self, parent->indentation);
+                printToken(self, useColor, SwampDumpAsciiTokenSeparator, self->style->separator, self->separatorLength);
+            }
+            if (i == self->budget.maxItemCount && parent->type->type != SwtiTypeTuple) {
+                printLiteral(self, useColor, SwampDumpAsciiTokenNumber, "... ");
+                printUInt32(self->fp, (uint32_t) (parent->count - i));
+                fldOutStreamWriteOctets(self->fp, (const uint8_t*) " more", 5);
+                return SwampDumpWalkDone;
+            }
+            break;
+        case SwtiTypeCustom:
+        case SwtiTypeCustomVariant:
+            printLiteral(self, useColor, SwampDumpAsciiTokenNumber, " ");
+            break;
+        default:
+            break;
+    }
+
+    if (self->depth >= self->budget.maxDepth && typeIsLevel(child->type)) {
+        printLiteral(self, useColor, SwampDumpAsciiTokenBracket, "...");
+        return SwampDumpWalkSkip;
+    }
+
+    return SwampDumpWalkContinue;
+}
+
+static int printLeave(AsciiPrinter* self, int useColor, SwampDumpWalkFrame* frame)
+{
+    if (typeIsLevel(frame->type)) {
+        self->depth--;
+    }
+    if (isExhausted(self)) {
+        return 0;
+    }
+
+    switch (frame->type->type) {
+        case SwtiTypeRecord:
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, " }");
+            break;
+        case SwtiTypeArray:
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, " |]");
+            break;
+        case SwtiTypeList:
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, " ]");
+            break;
+        case SwtiTypeTuple:
+            printLiteral(self, useColor, SwampDumpAsciiTokenBracket, " )");
+            break;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static int printScalarWithColor(void* self, SwampDumpWalkFrame* frame)
+{
+    return printScalar((AsciiPrinter*) self, ASCII_WITH_COLOR, frame);
+}
+
+static int printEnterWithColor(void* self, SwampDumpWalkFrame* frame)
+{
+    return printEnter((AsciiPrinter*) self, ASCII_WITH_COLOR, frame);
+}
+
+static int printItemWithColor(void* self, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    return printItem((AsciiPrinter*) self, ASCII_WITH_COLOR, parent, child);
+}
+
+static int printLeaveWithColor(void* self, SwampDumpWalkFrame* frame)
+{
+    return printLeave((AsciiPrinter*) self, ASCII_WITH_COLOR, frame);
+}
+
+static int printScalarNoColor(void* self, SwampDumpWalkFrame* frame)
+{
+    return printScalar((AsciiPrinter*) self, ASCII_NO_COLOR, frame);
+}
+
+static int printEnterNoColor(void* self, SwampDumpWalkFrame* frame)
+{
+    return printEnter((AsciiPrinter*) self, ASCII_NO_COLOR, frame);
+}
+
+static int printItemNoColor(void* self, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    return printItem((AsciiPrinter*) self, ASCII_NO_COLOR, parent, child);
+}
+
+static int printLeaveNoColor(void* self, SwampDumpWalkFrame* frame)
+{
+    return printLeave((AsciiPrinter*) self, ASCII_NO_COLOR, frame);
+}
+
+static const SwampDumpWalkVisitor asciiPrinter = {printScalarWithColor, printEnterWithColor, printItemWithColor,
+                                                  printLeaveWithColor, 1};
+static const SwampDumpWalkVisitor asciiPrinterNoColor = {printScalarNoColor, printEnterNoColor, printItemNoColor,
+                                                         printLeaveNoColor, 1};
+
+static int dumpToAscii(const uint8_t* v, const SwtiType* type, int flags, int indentation,
+                       const SwampDumpAsciiStyle* style, const SwampDumpAsciiBudget* budget,
+                       const SwampDumpWalkVisitor* visitor, FldOutStream* fp)
+{
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    AsciiPrinter printer;
+
+    printer.fp = fp;
+    printer.style = style;
+    printer.color = SWAMP_DUMP_ASCII_COLOR_UNKNOWN;
+    printer.indentationLength = tc_strlen(style->indentation);
+    printer.blobIndentationLength = tc_strlen(style->blobIndentation);
+    printer.separatorLength = tc_strlen(style->separator);
+    printer.assignLength = tc_strlen(style->assign);
+    printer.depth = 0;
+    printer.isExhausted = 0;
+
+    if (budget) {
+        printer.budget.maxDepth = limitOf(budget->maxDepth);
+        printer.budget.maxItemCount = limitOf(budget->maxItemCount);
+        printer.budget.maxPreviewLength = limitOf(budget->maxPreviewLength);
+        printer.budget.maxOctetCount = limitOf(budget->maxOctetCount);
+    } else {
+        printer.budget.maxDepth = ASCII_NO_LIMIT;
+        printer.budget.maxItemCount = ASCII_NO_LIMIT;
+        printer.budget.maxPreviewLength = ASCII_NO_LIMIT;
+        printer.budget.maxOctetCount = ASCII_NO_LIMIT;
+    }
+    printer.octetLimit = printer.budget.maxOctetCount == ASCII_NO_LIMIT ? ASCII_NO_LIMIT
+                                                                        : fp->pos + printer.budget.maxOctetCount;
+
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, visitor, &printer);
+
+    int errorCode = swampDumpWalk(&walker, type, (void*) v, flags, indentation);
+    swampDumpWalkerDestroy(&walker);
+
+    return errorCode;
+}
+
+int swampDumpToAsciiStyled(const uint8_t* v, const SwtiType* type, int flags, int indentation,
+                           const SwampDumpAsciiStyle* style, const SwampDumpAsciiBudget* budget, FldOutStream* fp)
+{
+    return dumpToAscii(v, type, flags, indentation, style, budget, &asciiPrinter, fp);
+}
+
+int swampDumpToAsciiStyledNoColor(const uint8_t* v, const SwtiType* type, int flags, int indentation,
+                                  const SwampDumpAsciiStyle* style, const SwampDumpAsciiBudget* budget,
+                                  FldOutStream* fp)
+{
+    return dumpToAscii(v, type, flags, indentation, style, budget, &asciiPrinterNoColor, fp);
+}
+
+int swampDumpToAscii(const uint8_t * v, const SwtiType* type, int flags, int indentation, FldOutStream* fp)
+{
+    return swampDumpToAsciiStyled(v, type, flags, indentation, &swampDumpAsciiStyleDefault, 0, fp);
+}
+
+int swampDumpToAsciiNoColor(const uint8_t * v, const SwtiType* type, int flags, int indentation, FldOutStream* fp)
+{
+    return swampDumpToAsciiStyledNoColor(v, type, flags, indentation, &swampDumpAsciiStyleDefault, 0, fp);
+}
+
+const char* swampDumpToAsciiStringBudgeted(const uint8_t* v, const SwtiType* type, int flags,
+                                           const SwampDumpAsciiBudget* budget, char* target, size_t maxCount)
+{
+    FldOutStream outStream;
+
+    if (maxCount < 64) {
+        return 0;
+    }
+
+    fldOutStreamInit(&outStream, (uint8_t*) target, maxCount - 6); // reserve for zero
+
+    SwampDumpAsciiBudget bufferBudget = {0, 0, 0, 0};
+    if (budget != 0) {
+        bufferBudget = *budget;
+    }
+    if (bufferBudget.maxOctetCount == 0 || bufferBudget.maxOctetCount > outStream.size) {
+        bufferBudget.maxOctetCount = outStream.size;
+    }
+
+    int errorCode = swampDumpToAsciiStyled(v, type, flags, 0, &swampDumpAsciiStyleDefault, &bufferBudget, &outStream);
+    outStream.size = maxCount;
+    fldOutStreamWriteOctets(&outStream, (const uint8_t*) "\033[0m", 4);
+    fldOutStreamWriteUInt8(&outStream, 0);
+    if (errorCode != 0) {
+        return 0;
+    }
+
+    return target;
+}
+
 const char* swampDumpToAsciiString(const uint8_t * v, const SwtiType* type, int flags, char* target, size_t maxCount)
+{
+    SwampDumpAsciiBudget budget = {0, 0, 0, 0};
+
+    return swampDumpToAsciiStringBudgeted(v, type, flags, &budget, target, maxCount);
+}
+
+const char* swampDumpToAsciiStringNoColor(const void* v, const SwtiType* type, int flags, char* target, size_t maxCount)
 {
     FldOutStream outStream;
 
@@ -311,9 +635,9 @@ const char* swampDumpToAsciiString(const uint8_t * v, const SwtiType* type, int
 
     fldOutStreamInit(&outStream, (uint8_t*) target, maxCount - 6); // reserve for zero
 
-    int errorCode = swampDumpToAscii(v, type, flags, 0, &outStream);
+    SwampDumpAsciiBudget budget = {0, 0, 0, outStream.size};
+    int errorCode = swampDumpToAsciiStyledNoColor(v, type, flags, 0, &swampDumpAsciiStyleDefault, &budget, &outStream);
     outStream.size = maxCount;
-    fldOutStreamWritef(&outStream, "\033[0m");
     fldOutStreamWriteUInt8(&outStream, 0);
     if (errorCode != 0) {
         return 0;
@@ -4,230 +4,315 @@
  *--------------------------------------------------------------------------------------------*/
 #include <clog/clog.h>
 #include <flood/out_stream.h>
-#include <stdarg.h>
-#include <swamp-dump/types.h>
+#include <swamp-dump/dump_yaml.h>
+#include <swamp-dump/format.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/types.h>
 #include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
 
-static void printTabs(FldOutStream* fp, int indentation)
+/// Where the next octet goes. Record fields and sequence dashes start new lines, except the first one after a dash
+/// that is on the indentation level of the dash item.
+typedef enum YamlCursor {
+    YamlCursorLineStart,
+    YamlCursorAfterDash,
+    YamlCursorInline,
+} YamlCursor;
+
+typedef struct YamlWriter {
+    FldOutStream* fp;
+    YamlCursor cursor;
+    int dashIndentation;
+    int writeError;
+} YamlWriter;
+
+#define YAML_BLOB_HEX_ROW (32)
+#define YAML_BLOB_TEXT_ROW (64)
+
+int swampDumpYamlVariantIsInline(const SwtiCustomTypeVariant* variant)
 {
-    for (size_t i = 0; i < indentation; ++i) {
-        fldOutStreamWriteOctets(fp, (const uint8_t *) "  ", 2);
+    if (variant->paramCount <= 1) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < variant->paramCount; ++i) {
+        switch (swtiUnalias(variant->fields[i].fieldType)->type) {
+            case SwtiTypeBoolean:
+            case SwtiTypeInt:
+            case SwtiTypeFixed:
+            case SwtiTypeRefId:
+                break;
+            default:
+                return 0;
+        }
     }
+
+    return 1;
 }
 
-static void printNewLineWithTabs(FldOutStream* fp, int indentation)
+/// Types that are written on the lines below their key, one indentation level deeper.
+static int typeIsBlock(const SwtiType* type)
 {
-    fldOutStreamWriteUInt8(fp, '\n');
-    printTabs(fp, indentation);
+    switch (swtiUnalias(type)->type) {
+        case SwtiTypeRecord:
+        case SwtiTypeList:
+        case SwtiTypeArray:
+        case SwtiTypeTuple:
+        case SwtiTypeBlob:
+            return 1;
+        default:
+            return 0;
+    }
 }
 
-static void printDots(FldOutStream* fp, int indentation)
+/// A failed write is remembered, so a sink that is too small fails the whole dump instead of truncating it.
+static void writeOctets(YamlWriter* self, const char* s, size_t count)
 {
-    for (size_t i = 0; i < indentation; ++i) {
-        fldOutStreamWriteOctets(fp, (const uint8_t *)"  ", 2);
+    if (fldOutStreamWriteOctets(self->fp, (const uint8_t*) s, count) < 0) {
+        self->writeError = -1;
     }
 }
 
-static void printNewLineWithDots(FldOutStream* fp, int indentation)
+static void writeLiteral(YamlWriter* self, const char* s)
 {
-    fldOutStreamWriteUInt8(fp, '\n');
-    printDots(fp, indentation);
+    writeOctets(self, s, tc_strlen(s));
 }
 
-static void printWithColorf(FldOutStream* fp, int fg, const char* s, ...)
+static void writeIndentation(YamlWriter* self, int indentation)
 {
-    va_list pl;
+    static const char spaces[] = "                                ";
+    size_t count = (size_t) indentation * 2;
 
-    fldOutStreamWritef(fp, "\033[%dm", fg);
+    while (count > 0) {
+        size_t chunk = count > sizeof(spaces) - 1 ? sizeof(spaces) - 1 : count;
+        writeOctets(self, spaces, chunk);
+        count -= chunk;
+    }
+}
 
-    va_start(pl, s);
-    fldOutStreamWritevf(fp, s, pl);
-    va_end(pl);
+/// For values that share the line with a key, a dash or a variant name.
+static void beginValue(YamlWriter* self, int indentation)
+{
+    switch (self->cursor) {
+        case YamlCursorLineStart:
+            writeIndentation(self, indentation);
+            break;
+        case YamlCursorInline:
+            writeOctets(self, " ", 1);
+            break;
+        case YamlCursorAfterDash:
+            break;
+    }
+    self->cursor = YamlCursorInline;
 }
 
-static int typeIsSimple(const SwtiType* type)
+static void beginLine(YamlWriter* self, int indentation)
 {
-    enum SwtiTypeValue v = type->type;
-    return (v == SwtiTypeBoolean) || (v == SwtiTypeInt) || (v == SwtiTypeFixed) || (v == SwtiTypeString) || (v == SwtiTypeCustom) || (v == SwtiTypeBlob);
+    if (self->cursor != YamlCursorAfterDash || indentation != self->dashIndentation) {
+        if (self->cursor != YamlCursorLineStart) {
+            writeOctets(self, "\n", 1);
+        }
+        writeIndentation(self, indentation);
+    }
+    self->cursor = YamlCursorInline;
 }
 
-static int swampDumpToYaml(const void* v, const SwtiType* type, int flags, int indentation, int alreadyindent, FldOutStream* fp)
+static void endLine(YamlWriter* self)
 {
-    /*
-    switch (type->type) {
-        case SwtiTypeBoolean: {
-            swamp_bool value = swamp_value_bool(v);
-            printWithColorf(fp, 92, "%s\n", value ? "true" : "false");
-        } break;
-        case SwtiTypeInt: {
-            swamp_int32 value = swamp_value_int(v);
+    if (self->cursor != YamlCursorLineStart) {
+        writeOctets(self, "\n", 1);
+        self->cursor = YamlCursorLineStart;
+    }
+}
 
-            printWithColorf(fp, 91, "%d\n", value);
-        } break;
-        case SwtiTypeFixed: {
-            swamp_int32 value = swamp_value_int(v);
+static void beginSequenceItem(YamlWriter* self, int indentation)
+{
+    beginLine(self, indentation);
+    writeOctets(self, "- ", 2);
+    self->cursor = YamlCursorAfterDash;
+    self->dashIndentation = indentation + 1;
+}
 
-            printWithColorf(fp, 91, "%f\n", value / 1000.0f);
-        } break;
-        case SwtiTypeString: {
-            const swamp_string* p = swamp_value_string(v);
-            printWithColorf(fp, 33, "%s\n", p->characters);
-        } break;
-        case SwtiTypeChar: {
-            const swamp_int* p = swamp_value_int(v);
-            printWithColorf(fp, 33, "%c\n", p->value);
-        } break;
-        case SwtiTypeResourceName: {
-            const swamp_string* p = swamp_value_string(v);
-            printWithColorf(fp, 33, "'%s'\n", p->characters);
-        } break;
-        case SwtiTypeRecord: {
-            const swamp_struct* p = swamp_value_struct(v);
-            const SwtiRecordType* record = (const SwtiRecordType*) type;
-            if (p->info.field_count != record->fieldCount) {
-                CLOG_SOFT_ERROR("problem with field count");
-                return -2;
-            }
-            for (size_t i = 0; i < record->fieldCount; i++) {
-                const SwtiRecordTypeField* field = &record->fields[i];
-                printTabs(fp, i == 0 ? indentation-alreadyindent : indentation);
-                printWithColorf(fp, 92, field->name);
-                printWithColorf(fp, 32, ": ");
-                if (!typeIsSimple(field->fieldType)) {
-                    printNewLineWithTabs(fp, 0);
-                } else {
-                }
-                int errorCode = swampDumpToYaml(p->fields[i], field->fieldType, flags, indentation + 1, alreadyindent, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
-            }
-        } break;
-        case SwtiTypeArray: {
-            const swamp_struct* p = swamp_value_struct(v);
-            const SwtiArrayType* array = (const SwtiArrayType*) type;
-
-            printWithColorf(fp, 94, "\n", fp);
-            for (size_t i = 0; i < p->info.field_count; i++) {
-                printNewLineWithTabs(fp, indentation-alreadyindent);
-                printWithColorf(fp, 35, "- ");
-                int errorCode = swampDumpToYaml(p->fields[i], array->itemType, flags, indentation + 1, alreadyindent, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
-            }
-        } break;
-        case SwtiTypeTuple: {
-            const swamp_struct* p = swamp_value_struct(v);
-            const SwtiTupleType* tuple = (const SwtiTupleType*) type;
+/// Text rows are read back as they are, so every octet must be printable and no row can start with a space, which
+/// would be taken for indentation.
+static int blobIsText(const uint8_t* octets, size_t count)
+{
+    for (size_t i = 0; i < count; i += YAML_BLOB_TEXT_ROW) {
+        if (octets[i] == ' ') {
+            return 0;
+        }
+    }
 
-            if (tuple->parameterCount != p->info.field_count) {
-                return -48;
-            }
+    return swampDumpOctetsArePrintable(octets, count);
+}
+
+static void writeBlob(YamlWriter* self, const SwampBlob* blob, int indentation)
+{
+    int isText = blobIsText(blob->octets, blob->octetCount);
 
-            printWithColorf(fp, 94, "\n", fp);
-            for (size_t i = 0; i < p->info.field_count; i++) {
-                printNewLineWithTabs(fp, indentation-alreadyindent);
-                printWithColorf(fp, 35, "- ");
-                int errorCode = swampDumpToYaml(p->fields[i], tuple->parameterTypes[i], flags, indentation + 1, alreadyindent, fp);
-                if (errorCode != 0) {
-                    return errorCode;
+    beginValue(self, indentation);
+    writeLiteral(self, isText ? ">" : ">x");
+    endLine(self);
+
+    size_t rowOctetCount = isText ? YAML_BLOB_TEXT_ROW : YAML_BLOB_HEX_ROW;
+    for (size_t i = 0; i < blob->octetCount; i += rowOctetCount) {
+        size_t count = blob->octetCount - i > rowOctetCount ? rowOctetCount : blob->octetCount - i;
+        writeIndentation(self, indentation);
+        if (isText) {
+            writeOctets(self, (const char*) blob->octets + i, count);
+        } else {
+            char pairs[YAML_BLOB_HEX_ROW * 2];
+            swampDumpFormatHexPairs(pairs, blob->octets + i, count);
+            writeOctets(self, pairs, count * 2);
+        }
+        writeOctets(self, "\n", 1);
+    }
+}
+
+static int writeScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    YamlWriter* self = (YamlWriter*) voidSelf;
+    const uint8_t* v = frame->value;
+    char text[SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT];
+
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            beginValue(self, frame->indentation);
+            writeLiteral(self, *(const SwampBool*) v ? "true" : "false");
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeRefId:
+            beginValue(self, frame->indentation);
+            writeOctets(self, text, swampDumpFormatInt32(text, *(const SwampInt32*) v));
+            break;
+        case SwtiTypeFixed:
+            beginValue(self, frame->indentation);
+            writeOctets(self, text, swampDumpFormatFixed32(text, *(const SwampFixed32*) v));
+            break;
+        case SwtiTypeString: {
+            const SwampString* p = *(const SwampString**) v;
+            for (size_t i = 0; i < p->characterCount; ++i) {
+                char ch = p->characters[i];
+                if (ch == '\n' || ch == '\r' || (i == 0 && ch == ' ')) {
+                    CLOG_SOFT_ERROR("swampDumpToYaml: string '%s' can not be written as a plain scalar",
+                                    p->characters)
+                    return -2;
                 }
             }
-        } break;
-        case SwtiTypeList: {
-            const swamp_list* p = swamp_value_list(v);
-            const SwtiArrayType* array = (const SwtiArrayType*) type;
-
-            int i = 0;
-            SWAMP_LIST_FOR_LOOP(p)
-                printTabs(fp, indentation-alreadyindent);
-                printWithColorf(fp, 35, "- ");
-                int errorCode = swampDumpToYaml(value, array->itemType, flags, indentation + 1, indentation + 1, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
-                i++;
-            SWAMP_LIST_FOR_LOOP_END()
-        } break;
-        case SwtiTypeFunction:
-            CLOG_SOFT_ERROR("can not dump functions")
+            beginValue(self, frame->indentation);
+            writeOctets(self, p->characters, p->characterCount);
+            break;
+        }
+        case SwtiTypeBlob:
+            writeBlob(self, *(const SwampBlob**) v, frame->indentation);
+            break;
+        default:
+            CLOG_SOFT_ERROR("swampDumpToYaml: can not write type %d", frame->type->type)
             return -1;
-        case SwtiTypeAlias: {
-            const SwtiAliasType* alias = (const SwtiAliasType*) type;
-            if (flags & swampDumpFlagAlias) {
-                printWithColorf(fp, 92, alias->internal.name);
-                printWithColorf(fp, 91, " => ");
-            }
-            int errorCode = swampDumpToYaml(v, alias->targetType, flags, indentation + 1, alreadyindent, fp);
-            if (errorCode != 0) {
-                return errorCode;
+    }
+
+    return 0;
+}
+
+static int writeEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    YamlWriter* self = (YamlWriter*) voidSelf;
+
+    if (frame->type->type == SwtiTypeCustom) {
+        const SwtiCustomType* custom = (const SwtiCustomType*) frame->type;
+        if (frame->variant < custom->variantCount) {
+            beginValue(self, frame->indentation);
+            writeLiteral(self, custom->variantTypes[frame->variant]->name);
+        }
+    }
+
+    return 0;
+}
+
+static int writeItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    YamlWriter* self = (YamlWriter*) voidSelf;
+
+    switch (parent->type->type) {
+        case SwtiTypeRecord: {
+            const char* name = ((const SwtiRecordType*) parent->type)->fields[parent->index].name;
+            beginLine(self, parent->indentation);
+            writeLiteral(self, name);
+            writeOctets(self, ":", 1);
+            if (typeIsBlock(child->type)) {
+                child->indentation = parent->indentation + 1;
             }
             break;
         }
+        case SwtiTypeList:
+        case SwtiTypeArray:
+        case SwtiTypeTuple:
+            beginSequenceItem(self, parent->indentation);
+            child->indentation = parent->indentation + 1;
+            break;
         case SwtiTypeCustom: {
-            const SwtiCustomType* custom = (const SwtiCustomType*) type;
-            const swamp_enum* p = swamp_value_enum(v);
-            const SwtiCustomTypeVariant* variant = &custom->variantTypes[p->enum_type];
-            printWithColorf(fp, 95, variant->name);
-            for (size_t i = 0; i < variant->paramCount; ++i) {
-                printWithColorf(fp, 91, " ");
-                const SwtiType* paramType = variant->paramTypes[i];
-                int errorCode = swampDumpToYaml(p->fields[i], paramType, flags, indentation + 1, alreadyindent, fp);
-                if (errorCode != 0) {
-                    return errorCode;
-                }
+            const SwtiCustomType* custom = (const SwtiCustomType*) parent->type;
+            if (!swampDumpYamlVariantIsInline(custom->variantTypes[parent->variant])) {
+                beginSequenceItem(self, parent->indentation + 1);
+                child->indentation = parent->indentation + 2;
+            } else if (typeIsBlock(child->type)) {
+                child->indentation = parent->indentation + 1;
             }
-            printWithColorf(fp, 94, "\n");
             break;
         }
-        case SwtiTypeBlob: {
-            const swamp_blob* blob = swamp_value_blob(v);
-            const char* chompModifier = ">@";
-            if (flags & swampDumpFlagBlobAscii) {
-                chompModifier = ">";
-            }
-            printWithColorf(fp, 91, chompModifier, blob->octet_count);
-
-            if (flags & swampDumpFlagBlobExpanded) {
-                size_t count = blob->octet_count > 2048 ? 2048 : blob->octet_count;
-                if (flags & swampDumpFlagBlobAscii) {
-                    for (size_t i=0; i<count;++i) {
-                        if ((i % 64) == 0) {
-                            printNewLineWithDots(fp, indentation);
-                        }
-                        printWithColorf(fp, 37, "%c", blob->octets[i]);
-                    }
-                } else {
-                    for (size_t i=0; i<count;++i) {
-                        if ((i % 32) == 0) {
-                            printNewLineWithDots(fp, indentation);
-                        }
-                        printWithColorf(fp, 12, "%02X", blob->octets[i]);
-                    }
-                }
-            }
-        }
+        default:
+            break;
+    }
+
+    return SwampDumpWalkContinue;
+}
+
+static const SwampDumpWalkVisitor yamlWriter = {writeScalar, writeEnter, writeItem, 0, 1};
+
+int swampDumpToYaml(const void* v, const SwtiType* type, int flags, int indentation, FldOutStream* fp)
+{
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    YamlWriter writer;
+
+    writer.fp = fp;
+    writer.cursor = YamlCursorLineStart;
+    writer.dashIndentation = 0;
+    writer.writeError = 0;
+
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &yamlWriter, &writer);
+    int errorCode = swampDumpWalk(&walker, type, (void*) v, flags, indentation);
+    swampDumpWalkerDestroy(&walker);
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    endLine(&writer);
+    if (writer.writeError < 0) {
+        CLOG_SOFT_ERROR("swampDumpToYaml: out of space when writing '%s'", type->name)
+        return writer.writeError;
     }
-     */
 
     return 0;
 }
 
-static const char* swampDumpToYamlString(const void* v, const SwtiType* type, int flags, char* target, size_t maxCount)
+const char* swampDumpToYamlString(const void* v, const SwtiType* type, int flags, char* target, size_t maxCount)
 {
     FldOutStream outStream;
 
-    fldOutStreamInit(&outStream, (uint8_t*) target, maxCount - 6); // reserve for zero
+    if (maxCount < 16) {
+        return 0;
+    }
+
+    fldOutStreamInit(&outStream, (uint8_t*) target, maxCount - 1); // reserve for zero
 
-    fldOutStreamWritef(&outStream, "%YAML 1.2\n---\n");
-    int errorCode = swampDumpToYaml(v, type, flags, 0, 0, &outStream);
+    fldOutStreamWriteOctets(&outStream, (const uint8_t*) "%YAML 1.2\n---\n", 14);
+    int errorCode = swampDumpToYaml(v, type, flags, 0, &outStream);
     if (errorCode != 0) {
         return 0;
     }
 
     outStream.size = maxCount;
-    fldOutStreamWritef(&outStream, "\033[0m");
     fldOutStreamWriteUInt8(&outStream, 0);
 
     return target;
@@ -0,0 +1,596 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/entropy.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-runtime/swamp_allocate.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+#define PROBABILITY_BITS (11)
+#define PROBABILITY_ONE (1 << PROBABILITY_BITS)
+#define ADAPT_SHIFT (5)
+#define RANGE_TOP (1u << 24)
+
+#define FIELD_CONTEXT_COUNT (64)
+#define VARIANT_CONTEXT_COUNT (16)
+#define MAX_BLOB_OCTET_COUNT (16 * 1024 * 1024)
+
+typedef uint16_t Probability;
+
+/// Everything that is known about one field position: the last value and how large its deltas tend to be.
+typedef struct FieldContext {
+    int32_t previous;
+    Probability boolean;
+    Probability bitCount[64];
+} FieldContext;
+
+typedef struct EntropyModels {
+    FieldContext fields[FIELD_CONTEXT_COUNT];
+    FieldContext blobLength;
+    Probability variants[VARIANT_CONTEXT_COUNT][256];
+    Probability lengths[256];
+    Probability stringLengths[256];
+    Probability octets[256][256];
+} EntropyModels;
+
+static void initProbabilities(Probability* probabilities, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        probabilities[i] = PROBABILITY_ONE / 2;
+    }
+}
+
+static void initFieldContext(FieldContext* context)
+{
+    context->previous = 0;
+    context->boolean = PROBABILITY_ONE / 2;
+    initProbabilities(context->bitCount, 64);
+}
+
+static EntropyModels* createModels(void)
+{
+    EntropyModels* models = tc_malloc_type(EntropyModels);
+    if (models == 0) {
+        CLOG_SOFT_ERROR("swamp-dump: out of memory for %zu octets of entropy models", sizeof(EntropyModels))
+        return 0;
+    }
+    for (size_t i = 0; i < FIELD_CONTEXT_COUNT; ++i) {
+        initFieldContext(&models->fields[i]);
+    }
+    initFieldContext(&models->blobLength);
+    initProbabilities(&models->variants[0][0], VARIANT_CONTEXT_COUNT * 256);
+    initProbabilities(models->lengths, 256);
+    initProbabilities(models->stringLengths, 256);
+    initProbabilities(&models->octets[0][0], 256 * 256);
+
+    return models;
+}
+
+/// Contexts are keyed on the path of field indices and variants from the root, never on type addresses, so a dump
+/// decodes with any copy of its types, also one deserialized in another process. All items of a list or an array
+/// share the key of the list.
+typedef struct ContextPath {
+    const SwampDumpWalker* walker;
+    uint32_t* keys;
+    size_t capacity;
+    uint32_t inlineKeys[SWAMP_DUMP_WALK_INLINE_DEPTH];
+} ContextPath;
+
+#define CONTEXT_KEY_ROOT (0x2545F491u)
+#define CONTEXT_KEY_ITEM (0xFFFFFFFFu)
+
+static void contextPathInit(ContextPath* self, const SwampDumpWalker* walker)
+{
+    self->walker = walker;
+    self->keys = self->inlineKeys;
+    self->capacity = SWAMP_DUMP_WALK_INLINE_DEPTH;
+    self->keys[0] = CONTEXT_KEY_ROOT;
+}
+
+static void contextPathDestroy(ContextPath* self)
+{
+    if (self->keys != self->inlineKeys) {
+        tc_free(self->keys);
+    }
+    self->keys = 0;
+}
+
+static uint32_t mixKey(uint32_t key, uint32_t value)
+{
+    key = (key ^ value) * 0x9E3779B1u;
+    return key ^ (key >> 15);
+}
+
+/// Called from item(), when the child is about to get the frame at the current walker depth.
+static int enterChildContext(ContextPath* self, EntropyModels* models, const SwampDumpWalkFrame* parent,
+                             SwampDumpWalkFrame* child)
+{
+    size_t depth = self->walker->depth;
+    if (depth == self->capacity) {
+        size_t capacity = self->capacity * 2;
+        uint32_t* keys = tc_malloc_type_count(uint32_t, capacity);
+        if (keys == 0) {
+            CLOG_SOFT_ERROR("swamp-dump: out of memory for %zu entropy contexts", capacity)
+            return -3;
+        }
+        tc_memcpy_octets(keys, self->keys, depth * sizeof(uint32_t));
+        contextPathDestroy(self);
+        self->keys = keys;
+        self->capacity = capacity;
+    }
+
+    uint32_t key = self->keys[depth - 1];
+    switch (parent->type->type) {
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            key = mixKey(key, CONTEXT_KEY_ITEM);
+            break;
+        case SwtiTypeCustom:
+            key = mixKey(mixKey(key, parent->variant), (uint32_t) parent->index);
+            break;
+        default:
+            key = mixKey(key, (uint32_t) parent->index);
+            break;
+    }
+    self->keys[depth] = key;
+    child->userPointer = &models->fields[key % FIELD_CONTEXT_COUNT];
+
+    return SwampDumpWalkContinue;
+}
+
+/// Called from enter(), the frame is at the current walker depth.
+static Probability* variantModel(const ContextPath* self, EntropyModels* models)
+{
+    return models->variants[self->keys[self->walker->depth] % VARIANT_CONTEXT_COUNT];
+}
+
+static uint32_t zigZag(int32_t delta)
+{
+    return ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31);
+}
+
+static int32_t unZigZag(uint32_t value)
+{
+    return (int32_t) ((value >> 1) ^ (0u - (value & 1)));
+}
+
+static int bitLength(uint32_t value)
+{
+    int length = 0;
+    while (length < 32 && (value >> length) != 0) {
+        length++;
+    }
+
+    return length;
+}
+
+typedef struct RangeEncoder {
+    FldOutStream* stream;
+    uint64_t low;
+    uint32_t range;
+    uint8_t cache;
+    uint64_t cacheSize;
+    int error;
+} RangeEncoder;
+
+static void shiftLow(RangeEncoder* self)
+{
+    if ((uint32_t) self->low < 0xFF000000u || (self->low >> 32) != 0) {
+        uint8_t carry = (uint8_t) (self->low >> 32);
+        uint8_t octet = self->cache;
+        do {
+            if (fldOutStreamWriteUInt8(self->stream, (uint8_t) (octet + carry)) < 0) {
+                self->error = -1;
+            }
+            octet = 0xFF;
+        } while (--self->cacheSize != 0);
+        self->cache = (uint8_t) (self->low >> 24);
+    }
+    self->cacheSize++;
+    self->low = (self->low & 0x00FFFFFFu) << 8;
+}
+
+static void encodeBit(RangeEncoder* self, Probability* probability, int bit)
+{
+    uint32_t bound = (self->range >> PROBABILITY_BITS) * *probability;
+    if (bit == 0) {
+        self->range = bound;
+        *probability += (PROBABILITY_ONE - *probability) >> ADAPT_SHIFT;
+    } else {
+        self->low += bound;
+        self->range -= bound;
+        *probability -= *probability >> ADAPT_SHIFT;
+    }
+    while (self->range < RANGE_TOP) {
+        self->range <<= 8;
+        shiftLow(self);
+    }
+}
+
+static void encodeDirect(RangeEncoder* self, uint32_t value, int bitCount)
+{
+    while (bitCount-- > 0) {
+        self->range >>= 1;
+        if ((value >> bitCount) & 1) {
+            self->low += self->range;
+        }
+        while (self->range < RANGE_TOP) {
+            self->range <<= 8;
+            shiftLow(self);
+        }
+    }
+}
+
+/// Most significant bit first, each bit in the context of the bits before it.
+static void encodeTree(RangeEncoder* self, Probability* tree, uint32_t value, int bitCount)
+{
+    uint32_t node = 1;
+    while (bitCount-- > 0) {
+        int bit = (value >> bitCount) & 1;
+        encodeBit(self, &tree[node], bit);
+        node = (node << 1) | (uint32_t) bit;
+    }
+}
+
+static void encodeInt(RangeEncoder* self, FieldContext* context, int32_t value)
+{
+    uint32_t zigZagged = zigZag((int32_t) ((uint32_t) value - (uint32_t) context->previous));
+    int length = bitLength(zigZagged);
+
+    encodeTree(self, context->bitCount, (uint32_t) length, 6);
+    if (length > 1) {
+        encodeDirect(self, zigZagged, length - 1);
+    }
+    context->previous = value;
+}
+
+static void encodeOctets(RangeEncoder* self, EntropyModels* models, const uint8_t* octets, size_t octetCount)
+{
+    uint8_t previous = 0;
+    for (size_t i = 0; i < octetCount; ++i) {
+        encodeTree(self, models->octets[previous], octets[i], 8);
+        previous = octets[i];
+    }
+}
+
+typedef struct EntropyWriter {
+    RangeEncoder encoder;
+    EntropyModels* models;
+    ContextPath path;
+} EntropyWriter;
+
+static int writeScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    EntropyWriter* self = (EntropyWriter*) voidSelf;
+    FieldContext* context = (FieldContext*) frame->userPointer;
+
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            encodeBit(&self->encoder, &context->boolean, *(const SwampBool*) frame->value != 0);
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            encodeInt(&self->encoder, context, *(const SwampInt32*) frame->value);
+            break;
+        case SwtiTypeString: {
+            const SwampString* string = *(const SwampString**) frame->value;
+            encodeTree(&self->encoder, self->models->stringLengths, (uint32_t) string->characterCount, 8);
+            encodeOctets(&self->encoder, self->models, (const uint8_t*) string->characters, string->characterCount);
+        } break;
+        case SwtiTypeBlob: {
+            const SwampBlob* blob = *(const SwampBlob**) frame->value;
+            encodeInt(&self->encoder, &self->models->blobLength, (int32_t) blob->octetCount);
+            encodeOctets(&self->encoder, self->models, blob->octets, blob->octetCount);
+        } break;
+        default:
+            CLOG_SOFT_ERROR("swampDumpToOctetsEntropy: can not write type %d", frame->type->type)
+            return -1;
+    }
+
+    return self->encoder.error;
+}
+
+static int writeEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    EntropyWriter* self = (EntropyWriter*) voidSelf;
+
+    switch (frame->type->type) {
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            encodeTree(&self->encoder, self->models->lengths, (uint32_t) frame->count, 8);
+            break;
+        case SwtiTypeCustom:
+            encodeTree(&self->encoder, variantModel(&self->path, self->models), frame->variant, 8);
+            break;
+        default:
+            break;
+    }
+
+    return self->encoder.error;
+}
+
+static int writeItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    EntropyWriter* self = (EntropyWriter*) voidSelf;
+
+    return enterChildContext(&self->path, self->models, parent, child);
+}
+
+static const SwampDumpWalkVisitor entropyWriter = {writeScalar, writeEnter, writeItem, 0, 1};
+
+int swampDumpToOctetsEntropy(FldOutStream* stream, const void* v, const SwtiType* type)
+{
+    fldOutStreamWriteUInt8(stream, 0);
+    fldOutStreamWriteUInt8(stream, 5);
+    fldOutStreamWriteUInt8(stream, 0);
+
+    EntropyWriter writer;
+    writer.models = createModels();
+    if (writer.models == 0) {
+        return -3;
+    }
+    writer.encoder.stream = stream;
+    writer.encoder.low = 0;
+    writer.encoder.range = 0xFFFFFFFFu;
+    writer.encoder.cache = 0;
+    writer.encoder.cacheSize = 1;
+    writer.encoder.error = 0;
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &entropyWriter, &writer);
+    walker.rootUserPointer = &writer.models->fields[CONTEXT_KEY_ROOT % FIELD_CONTEXT_COUNT];
+    contextPathInit(&writer.path, &walker);
+
+    int error = swampDumpWalk(&walker, type, (void*) v, 0, 0);
+    contextPathDestroy(&writer.path);
+    swampDumpWalkerDestroy(&walker);
+    if (error >= 0) {
+        for (size_t i = 0; i < 5; ++i) {
+            shiftLow(&writer.encoder);
+        }
+        error = writer.encoder.error;
+    }
+    tc_free(writer.models);
+
+    return error;
+}
+
+typedef struct RangeDecoder {
+    FldInStream* inStream;
+    uint32_t range;
+    uint32_t code;
+    int error;
+} RangeDecoder;
+
+static uint8_t nextOctet(RangeDecoder* self)
+{
+    uint8_t octet = 0;
+    if (fldInStreamReadUInt8(self->inStream, &octet) < 0) {
+        self->error = -3;
+    }
+
+    return octet;
+}
+
+static int decodeBit(RangeDecoder* self, Probability* probability)
+{
+    int bit;
+    uint32_t bound = (self->range >> PROBABILITY_BITS) * *probability;
+    if (self->code < bound) {
+        self->range = bound;
+        *probability += (PROBABILITY_ONE - *probability) >> ADAPT_SHIFT;
+        bit = 0;
+    } else {
+        self->code -= bound;
+        self->range -= bound;
+        *probability -= *probability >> ADAPT_SHIFT;
+        bit = 1;
+    }
+    while (self->range < RANGE_TOP) {
+        self->range <<= 8;
+        self->code = (self->code << 8) | nextOctet(self);
+    }
+
+    return bit;
+}
+
+static uint32_t decodeDirect(RangeDecoder* self, int bitCount)
+{
+    uint32_t value = 0;
+    while (bitCount-- > 0) {
+        self->range >>= 1;
+        uint32_t bit = self->code >= self->range;
+        if (bit) {
+            self->code -= self->range;
+        }
+        value = (value << 1) | bit;
+        while (self->range < RANGE_TOP) {
+            self->range <<= 8;
+            self->code = (self->code << 8) | nextOctet(self);
+        }
+    }
+
+    return value;
+}
+
+static uint32_t decodeTree(RangeDecoder* self, Probability* tree, int bitCount)
+{
+    uint32_t node = 1;
+    for (int i = 0; i < bitCount; ++i) {
+        node = (node << 1) | (uint32_t) decodeBit(self, &tree[node]);
+    }
+
+    return node - (1u << bitCount);
+}
+
+static int32_t decodeInt(RangeDecoder* self, FieldContext* context)
+{
+    int length = (int) decodeTree(self, context->bitCount, 6);
+    uint32_t zigZagged = 0;
+    if (length > 32) {
+        self->error = -3;
+    } else if (length == 1) {
+        zigZagged = 1;
+    } else if (length > 1) {
+        zigZagged = (1u << (length - 1)) | decodeDirect(self, length - 1);
+    }
+    context->previous = (int32_t) ((uint32_t) context->previous + (uint32_t) unZigZag(zigZagged));
+
+    return context->previous;
+}
+
+static void decodeOctets(RangeDecoder* self, EntropyModels* models, uint8_t* octets, size_t octetCount)
+{
+    uint8_t previous = 0;
+    for (size_t i = 0; i < octetCount; ++i) {
+        octets[i] = (uint8_t) decodeTree(self, models->octets[previous], 8);
+        previous = octets[i];
+    }
+}
+
+typedef struct EntropyReader {
+    RangeDecoder decoder;
+    EntropyModels* models;
+    ContextPath path;
+    SwampDynamicMemory* memory;
+} EntropyReader;
+
+static int readScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    EntropyReader* self = (EntropyReader*) voidSelf;
+    FieldContext* context = (FieldContext*) frame->userPointer;
+
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            *(SwampBool*) frame->value = (SwampBool) decodeBit(&self->decoder, &context->boolean);
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            *(SwampInt32*) frame->value = decodeInt(&self->decoder, context);
+            break;
+        case SwtiTypeString: {
+            char characters[256];
+            size_t characterCount = decodeTree(&self->decoder, self->models->stringLengths, 8);
+            decodeOctets(&self->decoder, self->models, (uint8_t*) characters, characterCount);
+            *(const SwampString**) frame->value = swampStringAllocateWithSize(self->memory, characters, characterCount);
+        } break;
+        case SwtiTypeBlob: {
+            int32_t octetCount = decodeInt(&self->decoder, &self->models->blobLength);
+            if (octetCount < 0 || octetCount > MAX_BLOB_OCTET_COUNT) {
+                CLOG_SOFT_ERROR("swampDumpFromOctetsEntropy: illegal blob size %d", octetCount)
+                return -3;
+            }
+            uint8_t* octets = tc_malloc(octetCount == 0 ? 1 : (size_t) octetCount);
+            if (octets == 0) {
+                CLOG_SOFT_ERROR("swampDumpFromOctetsEntropy: out of memory for a blob of %d octets", octetCount)
+                return -3;
+            }
+            decodeOctets(&self->decoder, self->models, octets, (size_t) octetCount);
+            *(const SwampBlob**) frame->value = swampBlobAllocate(self->memory, octetCount == 0 ? 0 : octets,
+                                                                  (size_t) octetCount);
+            tc_free(octets);
+        } break;
+        default:
+            CLOG_SOFT_ERROR("swampDumpFromOctetsEntropy: can not read type %d", frame->type->type)
+            return -1;
+    }
+
+    return self->decoder.error;
+}
+
+static int readEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    EntropyReader* self = (EntropyReader*) voidSelf;
+
+    switch (frame->type->type) {
+        case SwtiTypeCustom:
+            frame->variant = (uint8_t) decodeTree(&self->decoder, variantModel(&self->path, self->models), 8);
+            *frame->value = frame->variant;
+            break;
+        case SwtiTypeList: {
+            const SwtiListType* listType = (const SwtiListType*) frame->type;
+            uint32_t count = decodeTree(&self->decoder, self->models->lengths, 8);
+            SwampList* list = swampListAllocatePrepare(self->memory, count, listType->memoryInfo.memorySize,
+                                                       listType->memoryInfo.memoryAlign);
+            *(const SwampList**) frame->value = list;
+            frame->items = (uint8_t*) list->value;
+            frame->itemSize = list->itemSize;
+            frame->count = count;
+        } break;
+        case SwtiTypeArray: {
+            const SwtiArrayType* arrayType = (const SwtiArrayType*) frame->type;
+            uint32_t count = decodeTree(&self->decoder, self->models->lengths, 8);
+            SwampArray* array = swampArrayAllocatePrepare(self->memory, count, arrayType->memoryInfo.memorySize,
+                                                          arrayType->memoryInfo.memoryAlign);
+            *(const SwampArray**) frame->value = array;
+            frame->items = (uint8_t*) array->value;
+            frame->itemSize = array->itemSize;
+            frame->count = count;
+        } break;
+        default:
+            break;
+    }
+
+    return self->decoder.error;
+}
+
+static int readItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    EntropyReader* self = (EntropyReader*) voidSelf;
+
+    return enterChildContext(&self->path, self->models, parent, child);
+}
+
+static const SwampDumpWalkVisitor entropyReader = {readScalar, readEnter, readItem, 0, 0};
+
+int swampDumpFromOctetsEntropy(FldInStream* inStream, const SwtiType* type, void* target, SwampDynamicMemory* memory)
+{
+    uint8_t major, minor, patch;
+    fldInStreamReadUInt8(inStream, &major);
+    fldInStreamReadUInt8(inStream, &minor);
+    int error = fldInStreamReadUInt8(inStream, &patch);
+    if (error < 0) {
+        return error;
+    }
+    if (major != 0 || minor != 5) {
+        CLOG_SOFT_ERROR("swamp-dump: wrong version %d.%d.%d for an entropy coded dump", major, minor, patch)
+        return -1;
+    }
+
+    EntropyReader reader;
+    reader.models = createModels();
+    if (reader.models == 0) {
+        return -3;
+    }
+    reader.memory = memory;
+    reader.decoder.inStream = inStream;
+    reader.decoder.range = 0xFFFFFFFFu;
+    reader.decoder.code = 0;
+    reader.decoder.error = 0;
+    for (size_t i = 0; i < 5; ++i) {
+        reader.decoder.code = (reader.decoder.code << 8) | nextOctet(&reader.decoder);
+    }
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &entropyReader, &reader);
+    walker.rootUserPointer = &reader.models->fields[CONTEXT_KEY_ROOT % FIELD_CONTEXT_COUNT];
+    contextPathInit(&reader.path, &walker);
+
+    error = swampDumpWalk(&walker, type, target, 0, 0);
+    contextPathDestroy(&reader.path);
+    swampDumpWalkerDestroy(&walker);
+    tc_free(reader.models);
+
+    return error;
+}
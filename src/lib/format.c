@@ -0,0 +1,282 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <swamp-dump/format.h>
+#include <swamp-runtime/types.h>
+#include <tiny-libc/tiny_libc.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+static const char digitPairs[] = "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                                 "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                                 "8081828384858687888990919293949596979899";
+
+size_t swampDumpFormatUInt32(char* target, uint32_t value)
+{
+    char digits[10];
+    size_t pos = sizeof(digits);
+
+    while (value >= 100) {
+        const char* pair = &digitPairs[(value % 100) * 2];
+        value /= 100;
+        digits[--pos] = pair[1];
+        digits[--pos] = pair[0];
+    }
+    if (value >= 10) {
+        const char* pair = &digitPairs[value * 2];
+        digits[--pos] = pair[1];
+        digits[--pos] = pair[0];
+    } else {
+        digits[--pos] = (char) ('0' + value);
+    }
+
+    size_t count = sizeof(digits) - pos;
+    tc_memcpy_octets(target, digits + pos, count);
+
+    return count;
+}
+
+size_t swampDumpFormatInt32(char* target, int32_t value)
+{
+    if (value < 0) {
+        *target = '-';
+        return 1 + swampDumpFormatUInt32(target + 1, 0u - (uint32_t) value);
+    }
+
+    return swampDumpFormatUInt32(target, (uint32_t) value);
+}
+
+size_t swampDumpFormatFixed32(char* target, int32_t value)
+{
+    size_t pos = 0;
+    uint32_t magnitude = (uint32_t) value;
+
+    if (value < 0) {
+        target[pos++] = '-';
+        magnitude = 0u - magnitude;
+    }
+
+    pos += swampDumpFormatUInt32(target + pos, magnitude / SWAMP_FIXED_FACTOR);
+
+    uint32_t fraction = magnitude % SWAMP_FIXED_FACTOR;
+    const char* pair = &digitPairs[(fraction % 100) * 2];
+    target[pos++] = '.';
+    target[pos++] = (char) ('0' + fraction / 100);
+    target[pos++] = pair[0];
+    target[pos++] = pair[1];
+
+    return pos;
+}
+
+static int onlySpacesLeft(const char* s, size_t pos, size_t count)
+{
+    for (; pos < count; ++pos) {
+        if (s[pos] != ' ') {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/// Reads an optional sign and at least one digit. The magnitude is checked against the limit for the sign.
+static int parseMagnitude(const char* s, size_t count, size_t* pos, uint64_t limitPositive, int* isNegative,
+                          uint64_t* magnitude)
+{
+    *isNegative = 0;
+    if (*pos < count && (s[*pos] == '-' || s[*pos] == '+')) {
+        *isNegative = s[*pos] == '-';
+        (*pos)++;
+    }
+
+    uint64_t limit = limitPositive + (*isNegative ? 1 : 0);
+    size_t digitCount = 0;
+    uint64_t v = 0;
+    for (; *pos < count && s[*pos] >= '0' && s[*pos] <= '9'; ++(*pos)) {
+        v = v * 10 + (uint64_t) (s[*pos] - '0');
+        if (v > limit) {
+            return -2;
+        }
+        digitCount++;
+    }
+
+    if (digitCount == 0) {
+        return -1;
+    }
+
+    *magnitude = v;
+
+    return 0;
+}
+
+int swampDumpParseInt32(const char* s, size_t count, int32_t* value)
+{
+    size_t pos = 0;
+    int isNegative;
+    uint64_t magnitude;
+
+    int error = parseMagnitude(s, count, &pos, INT32_MAX, &isNegative, &magnitude);
+    if (error < 0) {
+        return error;
+    }
+    if (!onlySpacesLeft(s, pos, count)) {
+        return -1;
+    }
+
+    *value = isNegative ? (int32_t) (0u - (uint32_t) magnitude) : (int32_t) magnitude;
+
+    return 0;
+}
+
+int swampDumpParseFixed32(const char* s, size_t count, int32_t* value)
+{
+    size_t pos = 0;
+    int isNegative;
+    uint64_t integer;
+
+    int error = parseMagnitude(s, count, &pos, INT32_MAX / SWAMP_FIXED_FACTOR + 1, &isNegative, &integer);
+    if (error < 0) {
+        return error;
+    }
+
+    uint64_t fraction = 0;
+    if (pos < count && s[pos] == '.') {
+        pos++;
+        size_t decimalCount = 0;
+        for (; pos < count && s[pos] >= '0' && s[pos] <= '9'; ++pos, ++decimalCount) {
+            if (decimalCount < 3) {
+                fraction = fraction * 10 + (uint64_t) (s[pos] - '0');
+            } else if (s[pos] != '0') {
+                return -1;
+            }
+        }
+        for (; decimalCount < 3; ++decimalCount) {
+            fraction *= 10;
+        }
+    }
+
+    if (!onlySpacesLeft(s, pos, count)) {
+        return -1;
+    }
+
+    uint64_t magnitude = integer * SWAMP_FIXED_FACTOR + fraction;
+    if (magnitude > (uint64_t) INT32_MAX + (isNegative ? 1 : 0)) {
+        return -2;
+    }
+
+    *value = isNegative ? (int32_t) (0u - (uint32_t) magnitude) : (int32_t) magnitude;
+
+    return 0;
+}
+
+int swampDumpOctetsArePrintable(const uint8_t* octets, size_t count)
+{
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const __m256i belowWide = _mm256_set1_epi8(31);
+    const __m256i aboveWide = _mm256_set1_epi8(127);
+    for (; i + 32 <= count; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*) (octets + i));
+        __m256i printable = _mm256_and_si256(_mm256_cmpgt_epi8(x, belowWide), _mm256_cmpgt_epi8(aboveWide, x));
+        if ((uint32_t) _mm256_movemask_epi8(printable) != 0xffffffffu) {
+            return 0;
+        }
+    }
+#endif
+
+#if defined(__SSE2__)
+    // Octets above 127 are negative as signed and fail the first compare
+    const __m128i below = _mm_set1_epi8(31);
+    const __m128i above = _mm_set1_epi8(127);
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*) (octets + i));
+        __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(x, below), _mm_cmpgt_epi8(above, x));
+        if (_mm_movemask_epi8(printable) != 0xffff) {
+            return 0;
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        uint8_t ch = octets[i];
+        if (ch < 32 || ch > 126) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void swampDumpFormatHexPairs(char* target, const uint8_t* octets, size_t count)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    const __m128i nibbleMask = _mm_set1_epi8(0x0f);
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i digitOffset = _mm_set1_epi8('0');
+    const __m128i letterOffset = _mm_set1_epi8('A' - '0' - 10);
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*) (octets + i));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(x, 4), nibbleMask);
+        __m128i low = _mm_and_si128(x, nibbleMask);
+        high = _mm_add_epi8(_mm_add_epi8(high, digitOffset), _mm_and_si128(_mm_cmpgt_epi8(high, nine), letterOffset));
+        low = _mm_add_epi8(_mm_add_epi8(low, digitOffset), _mm_and_si128(_mm_cmpgt_epi8(low, nine), letterOffset));
+        _mm_storeu_si128((__m128i*) (target + i * 2), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i*) (target + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        target[i * 2] = hex[octets[i] >> 4];
+        target[i * 2 + 1] = hex[octets[i] & 0xf];
+    }
+}
+
+static int hexDigitValue(char ch)
+{
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'A' && ch <= 'F') {
+        return ch - 'A' + 10;
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+
+    return -1;
+}
+
+int swampDumpParseHexPairs(const char* s, size_t count, uint8_t* target)
+{
+    size_t octetCount = 0;
+    size_t pos = 0;
+
+    while (pos < count) {
+        if (s[pos] == ' ') {
+            pos++;
+            continue;
+        }
+        if (pos + 1 == count) {
+            return -1;
+        }
+        int high = hexDigitValue(s[pos]);
+        int low = hexDigitValue(s[pos + 1]);
+        if (high < 0 || low < 0) {
+            return -1;
+        }
+        target[octetCount++] = (uint8_t) ((high << 4) | low);
+        pos += 2;
+    }
+
+    return (int) octetCount;
+}
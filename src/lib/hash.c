@@ -0,0 +1,420 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+#define PRIME64_1 (0x9E3779B185EBCA87ull)
+#define PRIME64_2 (0xC2B2AE3D27D4EB4Full)
+#define PRIME64_3 (0x165667B19E3779F9ull)
+#define PRIME64_4 (0x85EBCA77C2B2AE63ull)
+#define PRIME64_5 (0x27D4EB2F165667C5ull)
+
+#define STRIPE_SIZE (32)
+#define UNMANAGED_MAX_OCTET_COUNT (1024)
+
+/// Streaming XXH64 style hash. The four lanes are independent, so a stripe is processed in parallel.
+typedef struct HashState {
+    uint64_t lanes[4];
+    uint8_t buffer[STRIPE_SIZE];
+    size_t bufferCount;
+    uint64_t totalCount;
+} HashState;
+
+static uint64_t rotateLeft(uint64_t value, int count)
+{
+    return (value << count) | (value >> (64 - count));
+}
+
+static uint64_t readLittleEndian64(const uint8_t* p)
+{
+    return (uint64_t) p[0] | ((uint64_t) p[1] << 8) | ((uint64_t) p[2] << 16) | ((uint64_t) p[3] << 24) |
+           ((uint64_t) p[4] << 32) | ((uint64_t) p[5] << 40) | ((uint64_t) p[6] << 48) | ((uint64_t) p[7] << 56);
+}
+
+static uint32_t readLittleEndian32(const uint8_t* p)
+{
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static uint64_t round64(uint64_t lane, uint64_t input)
+{
+    lane += input * PRIME64_2;
+    lane = rotateLeft(lane, 31);
+    return lane * PRIME64_1;
+}
+
+static uint64_t mergeRound(uint64_t hash, uint64_t lane)
+{
+    hash ^= round64(0, lane);
+    return hash * PRIME64_1 + PRIME64_4;
+}
+
+static void hashInit(HashState* self)
+{
+    self->lanes[0] = PRIME64_1 + PRIME64_2;
+    self->lanes[1] = PRIME64_2;
+    self->lanes[2] = 0;
+    self->lanes[3] = 0 - PRIME64_1;
+    self->bufferCount = 0;
+    self->totalCount = 0;
+}
+
+static void hashStripe(HashState* self, const uint8_t* stripe)
+{
+    for (size_t i = 0; i < 4; ++i) {
+        self->lanes[i] = round64(self->lanes[i], readLittleEndian64(stripe + i * 8));
+    }
+}
+
+static void hashUpdate(HashState* self, const uint8_t* octets, size_t octetCount)
+{
+    if (octetCount == 0) {
+        return;
+    }
+    self->totalCount += octetCount;
+
+    if (self->bufferCount > 0) {
+        size_t fill = STRIPE_SIZE - self->bufferCount;
+        if (fill > octetCount) {
+            fill = octetCount;
+        }
+        tc_memcpy_octets(self->buffer + self->bufferCount, octets, fill);
+        self->bufferCount += fill;
+        octets += fill;
+        octetCount -= fill;
+        if (self->bufferCount < STRIPE_SIZE) {
+            return;
+        }
+        hashStripe(self, self->buffer);
+        self->bufferCount = 0;
+    }
+
+    while (octetCount >= STRIPE_SIZE) {
+        hashStripe(self, octets);
+        octets += STRIPE_SIZE;
+        octetCount -= STRIPE_SIZE;
+    }
+
+    tc_memcpy_octets(self->buffer, octets, octetCount);
+    self->bufferCount = octetCount;
+}
+
+static uint64_t hashFinal(const HashState* self)
+{
+    uint64_t hash;
+
+    if (self->totalCount >= STRIPE_SIZE) {
+        hash = rotateLeft(self->lanes[0], 1) + rotateLeft(self->lanes[1], 7) + rotateLeft(self->lanes[2], 12) +
+               rotateLeft(self->lanes[3], 18);
+        for (size_t i = 0; i < 4; ++i) {
+            hash = mergeRound(hash, self->lanes[i]);
+        }
+    } else {
+        hash = self->lanes[2] + PRIME64_5;
+    }
+    hash += self->totalCount;
+
+    const uint8_t* p = self->buffer;
+    size_t left = self->bufferCount;
+    for (; left >= 8; left -= 8, p += 8) {
+        hash ^= round64(0, readLittleEndian64(p));
+        hash = rotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (left >= 4) {
+        hash ^= (uint64_t) readLittleEndian32(p) * PRIME64_1;
+        hash = rotateLeft(hash, 23) * PRIME64_2 + PRIME64_3;
+        left -= 4;
+        p += 4;
+    }
+    for (; left > 0; left--, p++) {
+        hash ^= (*p) * PRIME64_5;
+        hash = rotateLeft(hash, 11) * PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+static void hashUInt8(HashState* self, uint8_t value)
+{
+    hashUpdate(self, &value, 1);
+}
+
+static void hashBigEndian32(HashState* self, uint32_t value)
+{
+    uint8_t octets[4];
+    octets[0] = (uint8_t) (value >> 24);
+    octets[1] = (uint8_t) (value >> 16);
+    octets[2] = (uint8_t) (value >> 8);
+    octets[3] = (uint8_t) value;
+    hashUpdate(self, octets, 4);
+}
+
+/// Feeds the same octets as writeScalar() in dump.c would write.
+static int hashScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    HashState* self = (HashState*) voidSelf;
+    const uint8_t* v = frame->value;
+
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            hashUInt8(self, *(const SwampBool*) v);
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            hashBigEndian32(self, (uint32_t) *(const SwampInt32*) v);
+            break;
+        case SwtiTypeString: {
+            const SwampString* string = *(const SwampString**) v;
+            hashUInt8(self, (uint8_t) (string->characterCount + 1));
+            hashUpdate(self, (const uint8_t*) string->characters, string->characterCount);
+            hashUInt8(self, 0);
+        } break;
+        case SwtiTypeBlob: {
+            const SwampBlob* blob = *(const SwampBlob**) v;
+            hashBigEndian32(self, (uint32_t) blob->octetCount);
+            hashUpdate(self, blob->octets, blob->octetCount);
+        } break;
+        case SwtiTypeUnmanaged: {
+            const SwampUnmanaged* unmanaged = *(const SwampUnmanaged**) v;
+            uint8_t octets[UNMANAGED_MAX_OCTET_COUNT];
+            int octetCount = unmanaged->serialize(unmanaged->ptr, octets, UNMANAGED_MAX_OCTET_COUNT);
+            if (octetCount < 0) {
+                return octetCount;
+            }
+            hashUpdate(self, octets, (size_t) octetCount);
+        } break;
+        default:
+            CLOG_SOFT_ERROR("swampDumpHash: can not hash type %d", frame->type->type)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int hashEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    HashState* self = (HashState*) voidSelf;
+
+    switch (frame->type->type) {
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            hashUInt8(self, (uint8_t) frame->count);
+            break;
+        case SwtiTypeCustom:
+            hashUInt8(self, frame->variant);
+            break;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static const SwampDumpWalkVisitor hasher = {hashScalar, hashEnter, 0, 0, 1};
+
+uint64_t swampDumpHash(const void* v, const SwtiType* type)
+{
+    HashState state;
+    hashInit(&state);
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &hasher, &state);
+    if (swampDumpWalk(&walker, type, (void*) v, 0, 0) < 0) {
+        CLOG_SOFT_ERROR("swampDumpHash: could not hash '%s'", type->name)
+    }
+    swampDumpWalkerDestroy(&walker);
+
+    return hashFinal(&state);
+}
+
+uint64_t swampDumpHashOctets(const uint8_t* octets, size_t octetCount)
+{
+    HashState state;
+    hashInit(&state);
+    hashUpdate(&state, octets, octetCount);
+
+    return hashFinal(&state);
+}
+
+#define NOT_EQUAL (-1000)
+
+/// No pointers and no padding, so two values are equal exactly when their memory is. Nesting follows the type
+/// definitions, which bounds the recursion.
+static int isBlittable(const SwtiType* type)
+{
+    const SwtiType* unaliased = swtiUnalias(type);
+    size_t fieldMemorySize = 0;
+
+    switch (unaliased->type) {
+        case SwtiTypeBoolean:
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            return 1;
+        case SwtiTypeRecord: {
+            const SwtiRecordType* record = (const SwtiRecordType*) unaliased;
+            for (size_t i = 0; i < record->fieldCount; ++i) {
+                if (!isBlittable(record->fields[i].fieldType)) {
+                    return 0;
+                }
+                fieldMemorySize += swtiGetMemorySize(record->fields[i].fieldType);
+            }
+            return fieldMemorySize == record->memoryInfo.memorySize;
+        }
+        case SwtiTypeTuple: {
+            const SwtiTupleType* tuple = (const SwtiTupleType*) unaliased;
+            for (size_t i = 0; i < tuple->fieldCount; ++i) {
+                if (!isBlittable(tuple->fields[i].fieldType)) {
+                    return 0;
+                }
+                fieldMemorySize += swtiGetMemorySize(tuple->fields[i].fieldType);
+            }
+            return fieldMemorySize == tuple->memoryInfo.memorySize;
+        }
+        default:
+            return 0;
+    }
+}
+
+/// Walks `a`. The userPointer of each frame is the matching value in `b`.
+static int compareScalar(void* self, SwampDumpWalkFrame* frame)
+{
+    (void) self;
+
+    const uint8_t* a = frame->value;
+    const uint8_t* b = (const uint8_t*) frame->userPointer;
+
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            return *(const SwampBool*) a == *(const SwampBool*) b ? 0 : NOT_EQUAL;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            return *(const SwampInt32*) a == *(const SwampInt32*) b ? 0 : NOT_EQUAL;
+        case SwtiTypeString: {
+            const SwampString* stringA = *(const SwampString**) a;
+            const SwampString* stringB = *(const SwampString**) b;
+            return stringA == stringB || (stringA->characterCount == stringB->characterCount &&
+                                          tc_memcmp(stringA->characters, stringB->characters,
+                                                    stringA->characterCount) == 0)
+                       ? 0
+                       : NOT_EQUAL;
+        }
+        case SwtiTypeBlob: {
+            const SwampBlob* blobA = *(const SwampBlob**) a;
+            const SwampBlob* blobB = *(const SwampBlob**) b;
+            return blobA == blobB || (blobA->octetCount == blobB->octetCount &&
+                                      (blobA->octetCount == 0 ||
+                                       tc_memcmp(blobA->octets, blobB->octets, blobA->octetCount) == 0))
+                       ? 0
+                       : NOT_EQUAL;
+        }
+        case SwtiTypeUnmanaged: {
+            const SwampUnmanaged* unmanagedA = *(const SwampUnmanaged**) a;
+            const SwampUnmanaged* unmanagedB = *(const SwampUnmanaged**) b;
+            if (unmanagedA == unmanagedB) {
+                return 0;
+            }
+            uint8_t octetsA[UNMANAGED_MAX_OCTET_COUNT];
+            uint8_t octetsB[UNMANAGED_MAX_OCTET_COUNT];
+            int octetCountA = unmanagedA->serialize(unmanagedA->ptr, octetsA, UNMANAGED_MAX_OCTET_COUNT);
+            int octetCountB = unmanagedB->serialize(unmanagedB->ptr, octetsB, UNMANAGED_MAX_OCTET_COUNT);
+            if (octetCountA < 0 || octetCountB < 0) {
+                return octetCountA < 0 ? octetCountA : octetCountB;
+            }
+            return octetCountA == octetCountB && tc_memcmp(octetsA, octetsB, (size_t) octetCountA) == 0 ? 0
+                                                                                                         : NOT_EQUAL;
+        }
+        default:
+            CLOG_SOFT_ERROR("swampDumpEqual: can not compare type %d", frame->type->type)
+            return -1;
+    }
+}
+
+static int compareEnter(void* self, SwampDumpWalkFrame* frame)
+{
+    (void) self;
+
+    const uint8_t* b = (const uint8_t*) frame->userPointer;
+
+    switch (frame->type->type) {
+        case SwtiTypeCustom:
+            return frame->variant == *b ? 0 : NOT_EQUAL;
+        case SwtiTypeList:
+        case SwtiTypeArray: {
+            // SwampArray has the same layout as SwampList
+            const SwampList* listB = *(const SwampList**) b;
+            if (frame->items == (const uint8_t*) listB->value && frame->count == listB->count) {
+                frame->count = 0;
+                return 0;
+            }
+            if (frame->count != listB->count) {
+                return NOT_EQUAL;
+            }
+            const SwtiType* itemType = frame->type->type == SwtiTypeList
+                                           ? ((const SwtiListType*) frame->type)->itemType
+                                           : ((const SwtiArrayType*) frame->type)->itemType;
+            if (isBlittable(itemType)) {
+                if (tc_memcmp(frame->items, listB->value, frame->count * frame->itemSize) != 0) {
+                    return NOT_EQUAL;
+                }
+                frame->count = 0;
+            }
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int compareItem(void* self, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    (void) self;
+
+    const uint8_t* parentB = (const uint8_t*) parent->userPointer;
+
+    if (parent->type->type == SwtiTypeList || parent->type->type == SwtiTypeArray) {
+        const SwampList* listB = *(const SwampList**) parentB;
+        child->userPointer = (uint8_t*) listB->value + parent->index * parent->itemSize;
+    } else {
+        child->userPointer = (uint8_t*) parentB + (child->value - parent->value);
+    }
+
+    return SwampDumpWalkContinue;
+}
+
+static const SwampDumpWalkVisitor comparer = {compareScalar, compareEnter, compareItem, 0, 1};
+
+int swampDumpEqual(const void* a, const void* b, const SwtiType* type)
+{
+    if (a == b) {
+        return 1;
+    }
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &comparer, 0);
+    walker.rootUserPointer = (void*) b;
+
+    int result = swampDumpWalk(&walker, type, (void*) a, 0, 0);
+    swampDumpWalkerDestroy(&walker);
+    if (result < 0 && result != NOT_EQUAL) {
+        CLOG_SOFT_ERROR("swampDumpEqual: could not compare '%s'", type->name)
+    }
+
+    return result == 0;
+}
@@ -0,0 +1,202 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/dump_ascii.h>
+#include <swamp-dump/dump_ascii_no_color.h>
+#include <swamp-dump/log_ring.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define loadAcquire(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define storeRelease(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+// MSVC gives volatile accesses acquire and release semantics (/volatile:ms)
+#define loadAcquire(p) (*(volatile size_t*) (p))
+#define storeRelease(p, v) (*(volatile size_t*) (p) = (v))
+#else
+#error "swampDumpLogRing needs atomic load and store"
+#endif
+
+/// Records and the gap between head and tail are aligned to this, so a wrap marker always fits.
+#define LOG_RING_ALIGN (8)
+#define LOG_RING_WRAP (0xffffffff)
+
+typedef struct LogRingHeader {
+    uint32_t octetCount;
+    int32_t flags;
+    const SwtiType* type;
+} LogRingHeader;
+
+static size_t alignedRecordSize(size_t octetCount)
+{
+    return (sizeof(LogRingHeader) + octetCount + LOG_RING_ALIGN - 1) & ~(size_t) (LOG_RING_ALIGN - 1);
+}
+
+void swampDumpLogRingInit(SwampDumpLogRing* self, uint8_t* octets, size_t capacity)
+{
+    CLOG_ASSERT(((uintptr_t) octets & (LOG_RING_ALIGN - 1)) == 0, "swampDumpLogRingInit: octets must be aligned to 8")
+    self->octets = octets;
+    self->capacity = capacity & ~(size_t) (LOG_RING_ALIGN - 1);
+    self->head = 0;
+    self->tail = 0;
+    self->pushedCount = 0;
+    self->droppedCount = 0;
+}
+
+/// Encodes the value directly into the ring. Returns the record size, or a negative value if it did not fit.
+static int writeRecord(SwampDumpLogRing* self, size_t pos, size_t space, const void* v, const SwtiType* type,
+                       int flags)
+{
+    if (space <= sizeof(LogRingHeader)) {
+        return -1;
+    }
+
+    FldOutStream stream;
+    fldOutStreamInit(&stream, self->octets + pos + sizeof(LogRingHeader), space - sizeof(LogRingHeader));
+    int error = swampDumpToOctetsRaw(&stream, v, type);
+    if (error < 0) {
+        return error;
+    }
+
+    size_t recordSize = alignedRecordSize(stream.pos);
+    if (recordSize > space) {
+        return -1;
+    }
+
+    LogRingHeader* header = (LogRingHeader*) (self->octets + pos);
+    header->octetCount = (uint32_t) stream.pos;
+    header->flags = flags;
+    header->type = type;
+
+    return (int) recordSize;
+}
+
+int swampDumpLogRingPush(SwampDumpLogRing* self, const void* v, const SwtiType* type, int flags)
+{
+    size_t head = self->head;
+    size_t tail = loadAcquire(&self->tail);
+    size_t newHead = head;
+    int recordSize;
+
+    if (head >= tail) {
+        // A gap is kept before the tail, so head == tail always means that the ring is empty
+        size_t reserved = tail == 0 ? LOG_RING_ALIGN : 0;
+        size_t endSpace = self->capacity - head > reserved ? self->capacity - head - reserved : 0;
+        recordSize = writeRecord(self, head, endSpace, v, type, flags);
+        if (recordSize >= 0) {
+            newHead = head + (size_t) recordSize;
+            if (newHead == self->capacity) {
+                newHead = 0;
+            }
+        } else if (tail > LOG_RING_ALIGN) {
+            recordSize = writeRecord(self, 0, tail - LOG_RING_ALIGN, v, type, flags);
+            if (recordSize >= 0) {
+                ((LogRingHeader*) (self->octets + head))->octetCount = LOG_RING_WRAP;
+                newHead = (size_t) recordSize;
+            }
+        }
+    } else {
+        recordSize = writeRecord(self, head, tail - head - LOG_RING_ALIGN, v, type, flags);
+        newHead = head + (size_t) recordSize;
+    }
+
+    if (recordSize < 0) {
+        storeRelease(&self->droppedCount, self->droppedCount + 1);
+        return -1;
+    }
+
+    storeRelease(&self->pushedCount, self->pushedCount + 1);
+    storeRelease(&self->head, newHead);
+
+    return 0;
+}
+
+int swampDumpLogRingPeek(SwampDumpLogRing* self, SwampDumpLogEntry* entry)
+{
+    size_t tail = self->tail;
+    size_t head = loadAcquire(&self->head);
+
+    if (tail == head) {
+        return 0;
+    }
+
+    const LogRingHeader* header = (const LogRingHeader*) (self->octets + tail);
+    if (header->octetCount == LOG_RING_WRAP) {
+        tail = 0;
+        storeRelease(&self->tail, tail);
+        header = (const LogRingHeader*) self->octets;
+    }
+
+    entry->type = header->type;
+    entry->flags = header->flags;
+    entry->octets = self->octets + tail + sizeof(LogRingHeader);
+    entry->octetCount = header->octetCount;
+
+    return 1;
+}
+
+void swampDumpLogRingRelease(SwampDumpLogRing* self)
+{
+    size_t tail = self->tail;
+    const LogRingHeader* header = (const LogRingHeader*) (self->octets + tail);
+
+    tail += alignedRecordSize(header->octetCount);
+    if (tail == self->capacity) {
+        tail = 0;
+    }
+
+    storeRelease(&self->tail, tail);
+}
+
+size_t swampDumpLogRingPushedCount(const SwampDumpLogRing* self)
+{
+    return loadAcquire(&self->pushedCount);
+}
+
+size_t swampDumpLogRingDroppedCount(const SwampDumpLogRing* self)
+{
+    return loadAcquire(&self->droppedCount);
+}
+
+static int render(SwampDumpLogRing* self, SwampDynamicMemory* memory, FldOutStream* out, int useColor)
+{
+    SwampDumpLogEntry entry;
+    if (!swampDumpLogRingPeek(self, &entry)) {
+        return 0;
+    }
+
+    void* value = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(entry.type));
+
+    FldInStream inStream;
+    fldInStreamInit(&inStream, entry.octets, entry.octetCount);
+    int error = swampDumpFromOctetsRaw(&inStream, entry.type, 0, 0, value, memory, 0);
+    if (error >= 0) {
+        error = useColor ? swampDumpToAscii(value, entry.type, entry.flags, 0, out)
+                         : swampDumpToAsciiNoColor(value, entry.type, entry.flags, 0, out);
+    }
+
+    swampDumpLogRingRelease(self);
+    if (error < 0) {
+        CLOG_SOFT_ERROR("swampDumpLogRingRender: could not render '%s'", entry.type->name)
+        return error;
+    }
+
+    return 1;
+}
+
+int swampDumpLogRingRender(SwampDumpLogRing* self, SwampDynamicMemory* memory, FldOutStream* out)
+{
+    return render(self, memory, out, 1);
+}
+
+int swampDumpLogRingRenderNoColor(SwampDumpLogRing* self, SwampDynamicMemory* memory, FldOutStream* out)
+{
+    return render(self, memory, out, 0);
+}
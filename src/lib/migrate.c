@@ -0,0 +1,803 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/migrate.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-runtime/swamp_allocate.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+#define MIGRATION_INLINE_DEPTH (16)
+
+static uint64_t fingerprintAdd(uint64_t hash, const void* data, size_t count)
+{
+    const uint8_t* octets = (const uint8_t*) data;
+    for (size_t i = 0; i < count; ++i) {
+        hash ^= octets[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static uint64_t fingerprintAddName(uint64_t hash, const char* name)
+{
+    if (name == 0) {
+        return fingerprintAdd(hash, "", 1);
+    }
+    return fingerprintAdd(hash, name, tc_strlen(name) + 1);
+}
+
+/// The types that are being fingerprinted or compared further up, from the current one to the root. A type that is
+/// already on the path is recursive, so the walk stops there instead of following the cycle forever.
+typedef struct TypePath {
+    const SwtiType* type;
+    const SwtiType* otherType;
+    const struct TypePath* parent;
+} TypePath;
+
+static uint64_t fingerprintHelper(uint64_t hash, const SwtiType* type, const TypePath* parent)
+{
+    type = swtiUnalias(type);
+
+    // A recursive reference is hashed as the distance back to the type it refers to, which is the same for every
+    // copy of the type graph
+    uint32_t distance = 1;
+    for (const TypePath* up = parent; up != 0; up = up->parent, ++distance) {
+        if (up->type == type) {
+            uint8_t reference[5] = {0xff, (uint8_t) (distance >> 24), (uint8_t) (distance >> 16),
+                                    (uint8_t) (distance >> 8), (uint8_t) distance};
+            return fingerprintAdd(hash, reference, sizeof(reference));
+        }
+    }
+
+    uint8_t kind = (uint8_t) type->type;
+    hash = fingerprintAdd(hash, &kind, 1);
+
+    TypePath path;
+    path.type = type;
+    path.otherType = 0;
+    path.parent = parent;
+
+    switch (type->type) {
+        case SwtiTypeRecord: {
+            const SwtiRecordType* record = (const SwtiRecordType*) type;
+            for (size_t i = 0; i < record->fieldCount; ++i) {
+                hash = fingerprintAddName(hash, record->fields[i].name);
+                hash = fingerprintHelper(hash, record->fields[i].fieldType, &path);
+            }
+        } break;
+        case SwtiTypeTuple: {
+            const SwtiTupleType* tuple = (const SwtiTupleType*) type;
+            for (size_t i = 0; i < tuple->fieldCount; ++i) {
+                hash = fingerprintHelper(hash, tuple->fields[i].fieldType, &path);
+            }
+        } break;
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            for (size_t i = 0; i < custom->variantCount; ++i) {
+                const SwtiCustomTypeVariant* variant = custom->variantTypes[i];
+                hash = fingerprintAddName(hash, variant->name);
+                for (size_t j = 0; j < variant->paramCount; ++j) {
+                    hash = fingerprintHelper(hash, variant->fields[j].fieldType, &path);
+                }
+            }
+        } break;
+        case SwtiTypeList:
+            hash = fingerprintHelper(hash, ((const SwtiListType*) type)->itemType, &path);
+            break;
+        case SwtiTypeArray:
+            hash = fingerprintHelper(hash, ((const SwtiArrayType*) type)->itemType, &path);
+            break;
+        case SwtiTypeUnmanaged:
+            hash = fingerprintAddName(hash, type->name);
+            break;
+        default:
+            break;
+    }
+
+    return hash;
+}
+
+/// Structural hash of the whole type: kinds, field names, variant names and the order of them all.
+uint64_t swampDumpTypeFingerprint(const SwtiType* type)
+{
+    return fingerprintHelper(0xcbf29ce484222325ull, type, 0);
+}
+
+static int namesEqual(const char* a, const char* b)
+{
+    if (a == 0 || b == 0) {
+        return a == b;
+    }
+    return tc_str_equal(a, b);
+}
+
+/// Returns 1 if octets written as `writer` decode correctly, and with the same meaning, as `reader`.
+static int typesMatch(const SwtiType* writer, const SwtiType* reader, const TypePath* parent)
+{
+    writer = swtiUnalias(writer);
+    reader = swtiUnalias(reader);
+    if (writer == reader) {
+        return 1;
+    }
+    if (writer->type != reader->type) {
+        return 0;
+    }
+
+    // The pair is already being compared further up, so it matches as long as everything else does
+    for (const TypePath* up = parent; up != 0; up = up->parent) {
+        if (up->type == writer && up->otherType == reader) {
+            return 1;
+        }
+    }
+
+    TypePath path;
+    path.type = writer;
+    path.otherType = reader;
+    path.parent = parent;
+
+    switch (writer->type) {
+        case SwtiTypeRecord: {
+            const SwtiRecordType* w = (const SwtiRecordType*) writer;
+            const SwtiRecordType* r = (const SwtiRecordType*) reader;
+            if (w->fieldCount != r->fieldCount) {
+                return 0;
+            }
+            for (size_t i = 0; i < w->fieldCount; ++i) {
+                if (!namesEqual(w->fields[i].name, r->fields[i].name) ||
+                    !typesMatch(w->fields[i].fieldType, r->fields[i].fieldType, &path)) {
+                    return 0;
+                }
+            }
+            return 1;
+        }
+        case SwtiTypeTuple: {
+            const SwtiTupleType* w = (const SwtiTupleType*) writer;
+            const SwtiTupleType* r = (const SwtiTupleType*) reader;
+            if (w->fieldCount != r->fieldCount) {
+                return 0;
+            }
+            for (size_t i = 0; i < w->fieldCount; ++i) {
+                if (!typesMatch(w->fields[i].fieldType, r->fields[i].fieldType, &path)) {
+                    return 0;
+                }
+            }
+            return 1;
+        }
+        case SwtiTypeCustom: {
+            const SwtiCustomType* w = (const SwtiCustomType*) writer;
+            const SwtiCustomType* r = (const SwtiCustomType*) reader;
+            if (w->variantCount != r->variantCount) {
+                return 0;
+            }
+            for (size_t i = 0; i < w->variantCount; ++i) {
+                const SwtiCustomTypeVariant* wv = w->variantTypes[i];
+                const SwtiCustomTypeVariant* rv = r->variantTypes[i];
+                if (!namesEqual(wv->name, rv->name) || wv->paramCount != rv->paramCount) {
+                    return 0;
+                }
+                for (size_t j = 0; j < wv->paramCount; ++j) {
+                    if (!typesMatch(wv->fields[j].fieldType, rv->fields[j].fieldType, &path)) {
+                        return 0;
+                    }
+                }
+            }
+            return 1;
+        }
+        case SwtiTypeList:
+            return typesMatch(((const SwtiListType*) writer)->itemType, ((const SwtiListType*) reader)->itemType,
+                              &path);
+        case SwtiTypeArray:
+            return typesMatch(((const SwtiArrayType*) writer)->itemType, ((const SwtiArrayType*) reader)->itemType,
+                              &path);
+        case SwtiTypeUnmanaged:
+            return namesEqual(writer->name, reader->name);
+        default:
+            return 1;
+    }
+}
+
+static SwampDumpMigrationNode* allocateNode(SwampDumpMigrationPlan* self, SwampDumpMigrationKind kind,
+                                            const SwtiType* writerType, const SwtiType* readerType)
+{
+    SwampDumpMigrationNode* node = tc_malloc_type(SwampDumpMigrationNode);
+    tc_mem_clear_type(node);
+    node->kind = kind;
+    node->writerType = writerType;
+    node->readerType = readerType;
+    node->next = self->nodes;
+    self->nodes = node;
+
+    return node;
+}
+
+static SwampDumpMigrationField* allocateFields(size_t count)
+{
+    return tc_malloc_type_count(SwampDumpMigrationField, count == 0 ? 1 : count);
+}
+
+static const SwampDumpMigrationNode* compileNode(SwampDumpMigrationPlan* self, const SwtiType* writerType,
+                                                 const SwtiType* readerType);
+
+static int compileRecord(SwampDumpMigrationPlan* self, SwampDumpMigrationNode* node)
+{
+    const SwtiRecordType* w = (const SwtiRecordType*) node->writerType;
+    const SwtiRecordType* r = (const SwtiRecordType*) node->readerType;
+
+    node->fields = allocateFields(w->fieldCount);
+    node->fieldCount = w->fieldCount;
+    for (size_t i = 0; i < w->fieldCount; ++i) {
+        const SwtiRecordTypeField* writerField = &w->fields[i];
+        const SwtiRecordTypeField* readerField = 0;
+        for (size_t j = 0; j < r->fieldCount; ++j) {
+            if (namesEqual(writerField->name, r->fields[j].name)) {
+                readerField = &r->fields[j];
+                break;
+            }
+        }
+        if (readerField == 0) {
+            node->fields[i].node = allocateNode(self, SwampDumpMigrationSkip, writerField->fieldType, 0);
+            node->fields[i].readerOffset = 0;
+            continue;
+        }
+        node->fields[i].node = compileNode(self, writerField->fieldType, readerField->fieldType);
+        if (node->fields[i].node == 0) {
+            CLOG_SOFT_ERROR("can not migrate field '%s' in '%s'", writerField->name, r->internal.name)
+            return -1;
+        }
+        node->fields[i].readerOffset = readerField->memoryOffsetInfo.memoryOffset;
+    }
+
+    node->defaults = allocateFields(r->fieldCount);
+    for (size_t j = 0; j < r->fieldCount; ++j) {
+        const SwtiRecordTypeField* readerField = &r->fields[j];
+        int existsInWriter = 0;
+        for (size_t i = 0; i < w->fieldCount; ++i) {
+            if (namesEqual(w->fields[i].name, readerField->name)) {
+                existsInWriter = 1;
+                break;
+            }
+        }
+        if (!existsInWriter) {
+            SwampDumpMigrationField* field = &node->defaults[node->defaultCount++];
+            field->node = allocateNode(self, SwampDumpMigrationDefault, 0, readerField->fieldType);
+            field->readerOffset = readerField->memoryOffsetInfo.memoryOffset;
+        }
+    }
+
+    return 0;
+}
+
+static int compileParameters(SwampDumpMigrationPlan* self, SwampDumpMigrationField** outFields, size_t* outCount,
+                             SwampDumpMigrationField** outDefaults, size_t* outDefaultCount,
+                             const SwtiCustomTypeVariantField* writerFields, size_t writerCount,
+                             const SwtiCustomTypeVariantField* readerFields, size_t readerCount)
+{
+    SwampDumpMigrationField* fields = allocateFields(writerCount);
+    for (size_t i = 0; i < writerCount; ++i) {
+        if (i >= readerCount) {
+            fields[i].node = allocateNode(self, SwampDumpMigrationSkip, writerFields[i].fieldType, 0);
+            fields[i].readerOffset = 0;
+            continue;
+        }
+        fields[i].node = compileNode(self, writerFields[i].fieldType, readerFields[i].fieldType);
+        if (fields[i].node == 0) {
+            tc_free(fields);
+            return -1;
+        }
+        fields[i].readerOffset = readerFields[i].memoryOffsetInfo.memoryOffset;
+    }
+
+    SwampDumpMigrationField* defaults = allocateFields(readerCount);
+    size_t defaultCount = 0;
+    for (size_t j = writerCount; j < readerCount; ++j) {
+        defaults[defaultCount].node = allocateNode(self, SwampDumpMigrationDefault, 0, readerFields[j].fieldType);
+        defaults[defaultCount].readerOffset = readerFields[j].memoryOffsetInfo.memoryOffset;
+        defaultCount++;
+    }
+
+    *outFields = fields;
+    *outCount = writerCount;
+    *outDefaults = defaults;
+    *outDefaultCount = defaultCount;
+
+    return 0;
+}
+
+static int compileTuple(SwampDumpMigrationPlan* self, SwampDumpMigrationNode* node)
+{
+    const SwtiTupleType* w = (const SwtiTupleType*) node->writerType;
+    const SwtiTupleType* r = (const SwtiTupleType*) node->readerType;
+
+    node->fields = allocateFields(w->fieldCount);
+    node->fieldCount = w->fieldCount;
+    for (size_t i = 0; i < w->fieldCount; ++i) {
+        if (i >= r->fieldCount) {
+            node->fields[i].node = allocateNode(self, SwampDumpMigrationSkip, w->fields[i].fieldType, 0);
+            node->fields[i].readerOffset = 0;
+            continue;
+        }
+        node->fields[i].node = compileNode(self, w->fields[i].fieldType, r->fields[i].fieldType);
+        if (node->fields[i].node == 0) {
+            return -1;
+        }
+        node->fields[i].readerOffset = r->fields[i].memoryOffsetInfo.memoryOffset;
+    }
+
+    node->defaults = allocateFields(r->fieldCount);
+    for (size_t j = w->fieldCount; j < r->fieldCount; ++j) {
+        SwampDumpMigrationField* field = &node->defaults[node->defaultCount++];
+        field->node = allocateNode(self, SwampDumpMigrationDefault, 0, r->fields[j].fieldType);
+        field->readerOffset = r->fields[j].memoryOffsetInfo.memoryOffset;
+    }
+
+    return 0;
+}
+
+static int compileCustom(SwampDumpMigrationPlan* self, SwampDumpMigrationNode* node)
+{
+    const SwtiCustomType* w = (const SwtiCustomType*) node->writerType;
+    const SwtiCustomType* r = (const SwtiCustomType*) node->readerType;
+
+    node->variants = tc_malloc_type_count(SwampDumpMigrationVariant, w->variantCount == 0 ? 1 : w->variantCount);
+    tc_mem_clear_type_n(node->variants, w->variantCount == 0 ? 1 : w->variantCount);
+    node->variantCount = w->variantCount;
+    for (size_t i = 0; i < w->variantCount; ++i) {
+        const SwtiCustomTypeVariant* writerVariant = w->variantTypes[i];
+        SwampDumpMigrationVariant* variant = &node->variants[i];
+        variant->readerVariantIndex = -1;
+        for (size_t j = 0; j < r->variantCount; ++j) {
+            if (namesEqual(writerVariant->name, r->variantTypes[j]->name)) {
+                variant->readerVariantIndex = (int) j;
+                break;
+            }
+        }
+        if (variant->readerVariantIndex < 0) {
+            continue;
+        }
+        const SwtiCustomTypeVariant* readerVariant = r->variantTypes[variant->readerVariantIndex];
+        int error = compileParameters(self, &variant->fields, &variant->fieldCount, &variant->defaults,
+                                      &variant->defaultCount, writerVariant->fields, writerVariant->paramCount,
+                                      readerVariant->fields, readerVariant->paramCount);
+        if (error < 0) {
+            CLOG_SOFT_ERROR("can not migrate variant '%s' in '%s'", writerVariant->name, r->internal.name)
+            return error;
+        }
+    }
+
+    return 0;
+}
+
+static const SwampDumpMigrationNode* compileNode(SwampDumpMigrationPlan* self, const SwtiType* writerType,
+                                                 const SwtiType* readerType)
+{
+    writerType = swtiUnalias(writerType);
+    readerType = swtiUnalias(readerType);
+
+    for (const SwampDumpMigrationNode* existing = self->nodes; existing != 0; existing = existing->next) {
+        if (existing->writerType == writerType && existing->readerType == readerType) {
+            return existing;
+        }
+    }
+
+    if (typesMatch(writerType, readerType, 0)) {
+        return allocateNode(self, SwampDumpMigrationCopy, writerType, readerType);
+    }
+
+    if (writerType->type != readerType->type) {
+        CLOG_SOFT_ERROR("can not migrate type '%s' (%d) to '%s' (%d)", writerType->name, writerType->type,
+                        readerType->name, readerType->type)
+        return 0;
+    }
+
+    int error;
+    SwampDumpMigrationNode* node;
+    switch (writerType->type) {
+        case SwtiTypeRecord:
+            node = allocateNode(self, SwampDumpMigrationRecord, writerType, readerType);
+            error = compileRecord(self, node);
+            break;
+        case SwtiTypeTuple:
+            node = allocateNode(self, SwampDumpMigrationRecord, writerType, readerType);
+            error = compileTuple(self, node);
+            break;
+        case SwtiTypeCustom:
+            node = allocateNode(self, SwampDumpMigrationCustom, writerType, readerType);
+            error = compileCustom(self, node);
+            break;
+        case SwtiTypeList:
+            node = allocateNode(self, SwampDumpMigrationList, writerType, readerType);
+            node->item = compileNode(self, ((const SwtiListType*) writerType)->itemType,
+                                     ((const SwtiListType*) readerType)->itemType);
+            error = node->item == 0 ? -1 : 0;
+            break;
+        case SwtiTypeArray:
+            node = allocateNode(self, SwampDumpMigrationList, writerType, readerType);
+            node->item = compileNode(self, ((const SwtiArrayType*) writerType)->itemType,
+                                     ((const SwtiArrayType*) readerType)->itemType);
+            error = node->item == 0 ? -1 : 0;
+            break;
+        default:
+            CLOG_SOFT_ERROR("can not migrate '%s' to '%s'", writerType->name, readerType->name)
+            return 0;
+    }
+
+    return error < 0 ? 0 : node;
+}
+
+int swampDumpMigrationPlanInit(SwampDumpMigrationPlan* self, const SwtiType* writerType, const SwtiType* readerType)
+{
+    self->writerType = writerType;
+    self->readerType = readerType;
+    self->writerFingerprint = swampDumpTypeFingerprint(writerType);
+    self->nodes = 0;
+    self->root = compileNode(self, writerType, readerType);
+    if (self->root == 0) {
+        swampDumpMigrationPlanDestroy(self);
+        return -1;
+    }
+
+    return 0;
+}
+
+void swampDumpMigrationPlanDestroy(SwampDumpMigrationPlan* self)
+{
+    SwampDumpMigrationNode* node = self->nodes;
+    while (node != 0) {
+        SwampDumpMigrationNode* next = node->next;
+        for (size_t i = 0; i < node->variantCount; ++i) {
+            tc_free(node->variants[i].fields);
+            tc_free(node->variants[i].defaults);
+        }
+        tc_free(node->variants);
+        tc_free(node->fields);
+        tc_free(node->defaults);
+        tc_free(node);
+        node = next;
+    }
+    self->nodes = 0;
+    self->root = 0;
+}
+
+static int defaultScalar(void* self, SwampDumpWalkFrame* frame)
+{
+    SwampDynamicMemory* memory = (SwampDynamicMemory*) self;
+
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            *(SwampBool*) frame->value = 0;
+            break;
+        case SwtiTypeInt:
+        case SwtiTypeRefId:
+            *(SwampInt32*) frame->value = 0;
+            break;
+        case SwtiTypeFixed:
+            *(SwampFixed32*) frame->value = 0;
+            break;
+        case SwtiTypeChar:
+            *(SwampCharacter*) frame->value = 0;
+            break;
+        case SwtiTypeString:
+            *(const SwampString**) frame->value = swampStringAllocate(memory, "");
+            break;
+        case SwtiTypeBlob:
+            *(const SwampBlob**) frame->value = swampBlobAllocate(memory, 0, 0);
+            break;
+        default:
+            CLOG_SOFT_ERROR("can not create a default value for '%s' (%d)", frame->type->name, frame->type->type)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int defaultEnter(void* self, SwampDumpWalkFrame* frame)
+{
+    SwampDynamicMemory* memory = (SwampDynamicMemory*) self;
+
+    switch (frame->type->type) {
+        case SwtiTypeCustom:
+            *frame->value = 0;
+            frame->variant = 0;
+            break;
+        case SwtiTypeList: {
+            const SwtiListType* listType = (const SwtiListType*) frame->type;
+            *(const SwampList**) frame->value = swampListAllocatePrepare(memory, 0, listType->memoryInfo.memorySize,
+                                                                        listType->memoryInfo.memoryAlign);
+        } break;
+        case SwtiTypeArray: {
+            const SwtiArrayType* arrayType = (const SwtiArrayType*) frame->type;
+            *(const SwampArray**) frame->value = swampArrayAllocatePrepare(memory, 0, arrayType->memoryInfo.memorySize,
+                                                                          arrayType->memoryInfo.memoryAlign);
+        } break;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static const SwampDumpWalkVisitor defaultWriter = {defaultScalar, defaultEnter, 0, 0, 0};
+
+static int writeDefault(SwampDynamicMemory* memory, const SwtiType* type, uint8_t* target)
+{
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &defaultWriter, memory);
+
+    int errorCode = swampDumpWalk(&walker, type, target, 0, 0);
+    swampDumpWalkerDestroy(&walker);
+
+    return errorCode;
+}
+
+static int writeDefaults(SwampDynamicMemory* memory, const SwampDumpMigrationField* defaults, size_t count,
+                         uint8_t* target)
+{
+    for (size_t i = 0; i < count; ++i) {
+        int error = writeDefault(memory, defaults[i].node->readerType, target + defaults[i].readerOffset);
+        if (error < 0) {
+            return error;
+        }
+    }
+
+    return 0;
+}
+
+typedef struct MigrationReader {
+    FldInStream* inStream;
+    unmanagedTypeCreator creator;
+    void* context;
+    SwampDynamicMemory* memory;
+    SwampUnmanagedMemory* targetUnmanagedMemory;
+} MigrationReader;
+
+typedef struct MigrationFrame {
+    const SwampDumpMigrationNode* node;
+    uint8_t* target;
+    const SwampDumpMigrationField* fields;
+    uint8_t* items;
+    size_t itemSize;
+    size_t count;
+    size_t index;
+} MigrationFrame;
+
+static int isLeaf(const SwampDumpMigrationNode* node)
+{
+    return node->kind == SwampDumpMigrationCopy || node->kind == SwampDumpMigrationSkip ||
+           node->kind == SwampDumpMigrationDefault;
+}
+
+static int readLeaf(MigrationReader* self, const SwampDumpMigrationNode* node, uint8_t* target)
+{
+    switch (node->kind) {
+        case SwampDumpMigrationCopy:
+            return swampDumpFromOctetsRaw(self->inStream, node->readerType, self->creator, self->context, target,
+                                          self->memory, self->targetUnmanagedMemory);
+        case SwampDumpMigrationSkip:
+            return swampDumpSkipOctetsRaw(self->inStream, node->writerType);
+        case SwampDumpMigrationDefault:
+            return writeDefault(self->memory, node->readerType, target);
+        default:
+            return -1;
+    }
+}
+
+static int enterFrame(MigrationReader* self, MigrationFrame* frame)
+{
+    const SwampDumpMigrationNode* node = frame->node;
+    frame->index = 0;
+
+    switch (node->kind) {
+        case SwampDumpMigrationRecord:
+            frame->fields = node->fields;
+            frame->count = node->fieldCount;
+            return writeDefaults(self->memory, node->defaults, node->defaultCount, frame->target);
+        case SwampDumpMigrationCustom: {
+            uint8_t writerVariantIndex;
+            int error = fldInStreamReadUInt8(self->inStream, &writerVariantIndex);
+            if (error < 0) {
+                return error;
+            }
+            if (writerVariantIndex >= node->variantCount) {
+                CLOG_SOFT_ERROR("illegal variant index %d for '%s'", writerVariantIndex, node->writerType->name)
+                return -2;
+            }
+            const SwampDumpMigrationVariant* variant = &node->variants[writerVariantIndex];
+            if (variant->readerVariantIndex < 0) {
+                const SwtiCustomType* custom = (const SwtiCustomType*) node->writerType;
+                CLOG_SOFT_ERROR("variant '%s' has been removed from '%s'",
+                                custom->variantTypes[writerVariantIndex]->name, node->readerType->name)
+                return -2;
+            }
+            *frame->target = (uint8_t) variant->readerVariantIndex;
+            frame->fields = variant->fields;
+            frame->count = variant->fieldCount;
+            return writeDefaults(self->memory, variant->defaults, variant->defaultCount, frame->target);
+        }
+        case SwampDumpMigrationList: {
+            uint8_t count;
+            int error = fldInStreamReadUInt8(self->inStream, &count);
+            if (error < 0) {
+                return error;
+            }
+            if (node->readerType->type == SwtiTypeList) {
+                const SwtiListType* listType = (const SwtiListType*) node->readerType;
+                SwampList* list = swampListAllocatePrepare(self->memory, count, listType->memoryInfo.memorySize,
+                                                           listType->memoryInfo.memoryAlign);
+                *(const SwampList**) frame->target = list;
+                frame->items = (uint8_t*) list->value;
+                frame->itemSize = list->itemSize;
+            } else {
+                const SwtiArrayType* arrayType = (const SwtiArrayType*) node->readerType;
+                SwampArray* array = swampArrayAllocatePrepare(self->memory, count, arrayType->memoryInfo.memorySize,
+                                                              arrayType->memoryInfo.memoryAlign);
+                *(const SwampArray**) frame->target = array;
+                frame->items = (uint8_t*) array->value;
+                frame->itemSize = array->itemSize;
+            }
+            frame->fields = 0;
+            frame->count = count;
+            return 0;
+        }
+        default:
+            return -1;
+    }
+}
+
+/// Doubles the frame stack. The first stack is owned by the caller and is never freed here.
+static MigrationFrame* growFrames(MigrationFrame* frames, size_t* capacity, const MigrationFrame* inlineFrames)
+{
+    MigrationFrame* grown = tc_malloc_type_count(MigrationFrame, *capacity * 2);
+    if (grown == 0) {
+        CLOG_SOFT_ERROR("swampDumpFromOctetsMigrate: out of memory for %zu frames", *capacity * 2)
+        return 0;
+    }
+    tc_memcpy_octets(grown, frames, *capacity * sizeof(MigrationFrame));
+    if (frames != inlineFrames) {
+        tc_free(frames);
+    }
+    *capacity *= 2;
+
+    return grown;
+}
+
+int swampDumpFromOctetsMigrateRaw(FldInStream* inStream, const SwampDumpMigrationPlan* plan,
+                                  unmanagedTypeCreator creator, void* context, void* target,
+                                  SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)
+{
+    MigrationReader reader;
+    reader.inStream = inStream;
+    reader.creator = creator;
+    reader.context = context;
+    reader.memory = memory;
+    reader.targetUnmanagedMemory = targetUnmanagedMemory;
+
+    if (isLeaf(plan->root)) {
+        return readLeaf(&reader, plan->root, target);
+    }
+
+    MigrationFrame inlineFrames[MIGRATION_INLINE_DEPTH];
+    MigrationFrame* frames = inlineFrames;
+    size_t capacity = MIGRATION_INLINE_DEPTH;
+    size_t depth = 0;
+
+    frames[0].node = plan->root;
+    frames[0].target = target;
+    int error = enterFrame(&reader, &frames[0]);
+    if (error < 0) {
+        return error;
+    }
+    depth = 1;
+
+    while (depth > 0) {
+        MigrationFrame* top = &frames[depth - 1];
+        if (top->index >= top->count) {
+            depth--;
+            continue;
+        }
+
+        size_t i = top->index++;
+        const SwampDumpMigrationNode* childNode;
+        uint8_t* childTarget;
+        if (top->node->kind == SwampDumpMigrationList) {
+            childNode = top->node->item;
+            childTarget = top->items + i * top->itemSize;
+        } else {
+            childNode = top->fields[i].node;
+            childTarget = top->target + top->fields[i].readerOffset;
+        }
+
+        if (isLeaf(childNode)) {
+            if ((error = readLeaf(&reader, childNode, childTarget)) < 0) {
+                break;
+            }
+            continue;
+        }
+
+        if (depth == capacity) {
+            MigrationFrame* grown = growFrames(frames, &capacity, inlineFrames);
+            if (grown == 0) {
+                error = -3;
+                break;
+            }
+            frames = grown;
+        }
+        MigrationFrame* child = &frames[depth];
+        child->node = childNode;
+        child->target = childTarget;
+        if ((error = enterFrame(&reader, child)) < 0) {
+            break;
+        }
+        depth++;
+    }
+
+    if (frames != inlineFrames) {
+        tc_free(frames);
+    }
+
+    return error < 0 ? error : 0;
+}
+
+int swampDumpToOctetsWithSchema(FldOutStream* stream, const void* v, const SwtiType* type)
+{
+    fldOutStreamWriteUInt8(stream, 0);
+    fldOutStreamWriteUInt8(stream, 2);
+    fldOutStreamWriteUInt8(stream, 0);
+    int error = fldOutStreamWriteUInt64(stream, swampDumpTypeFingerprint(type));
+    if (error < 0) {
+        return error;
+    }
+
+    return swampDumpToOctetsRaw(stream, v, type);
+}
+
+int swampDumpFromOctetsWithSchema(FldInStream* inStream, const SwtiType* readerType,
+                                  const SwampDumpMigrationPlan* const* plans, size_t planCount,
+                                  unmanagedTypeCreator creator, void* context, void* target, SwampDynamicMemory* memory,
+                                  SwampUnmanagedMemory* targetUnmanagedMemory)
+{
+    uint8_t major, minor, patch;
+    fldInStreamReadUInt8(inStream, &major);
+    fldInStreamReadUInt8(inStream, &minor);
+    int error = fldInStreamReadUInt8(inStream, &patch);
+    if (error < 0) {
+        return error;
+    }
+
+    if (major == 0 && minor == 1) {
+        return swampDumpFromOctetsRaw(inStream, readerType, creator, context, target, memory, targetUnmanagedMemory);
+    }
+
+    if (major != 0 || minor != 2) {
+        CLOG_SOFT_ERROR("swamp-dump: wrong version %d.%d.%d", major, minor, patch)
+        return -1;
+    }
+
+    uint64_t writerFingerprint;
+    if ((error = fldInStreamReadUInt64(inStream, &writerFingerprint)) < 0) {
+        return error;
+    }
+
+    if (writerFingerprint == swampDumpTypeFingerprint(readerType)) {
+        return swampDumpFromOctetsRaw(inStream, readerType, creator, context, target, memory, targetUnmanagedMemory);
+    }
+
+    for (size_t i = 0; i < planCount; ++i) {
+        const SwampDumpMigrationPlan* plan = plans[i];
+        if (plan->writerFingerprint == writerFingerprint && plan->readerType == readerType) {
+            return swampDumpFromOctetsMigrateRaw(inStream, plan, creator, context, target, memory,
+                                                 targetUnmanagedMemory);
+        }
+    }
+
+    CLOG_SOFT_ERROR("swamp-dump: no migration plan from writer %016llX to '%s'", (unsigned long long) writerFingerprint,
+                    readerType->name)
+    return -2;
+}
@@ -0,0 +1,212 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-dump/projection.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+/// Nodes also select the variants of a custom type, while descriptors keep them apart from the fields.
+static size_t childCountOf(const SwtiType* type)
+{
+    if (type->type == SwtiTypeCustom) {
+        return ((const SwtiCustomType*) type)->variantCount;
+    }
+
+    return swampDumpFieldCount(type);
+}
+
+static SwampDumpProjectionNode* createNode(const SwtiType* type)
+{
+    SwampDumpProjectionNode* node = tc_malloc_type(SwampDumpProjectionNode);
+    node->type = type;
+    node->childCount = childCountOf(type);
+    size_t allocCount = node->childCount == 0 ? 1 : node->childCount;
+    node->selections = tc_malloc(allocCount);
+    tc_mem_clear(node->selections, allocCount);
+    node->children = tc_malloc_type_count(SwampDumpProjectionNode*, allocCount);
+    tc_mem_clear_type_n(node->children, allocCount);
+
+    return node;
+}
+
+static void destroyNode(SwampDumpProjectionNode* node)
+{
+    for (size_t i = 0; i < node->childCount; ++i) {
+        if (node->children[i] != 0) {
+            destroyNode(node->children[i]);
+        }
+    }
+    tc_free(node->children);
+    tc_free(node->selections);
+    tc_free(node);
+}
+
+static const char* childNameOf(const SwtiType* type, size_t index)
+{
+    switch (type->type) {
+        case SwtiTypeRecord:
+            return ((const SwtiRecordType*) type)->fields[index].name;
+        case SwtiTypeTuple:
+            return ((const SwtiTupleType*) type)->fields[index].name;
+        case SwtiTypeCustom:
+            return ((const SwtiCustomType*) type)->variantTypes[index]->name;
+        default:
+            return 0;
+    }
+}
+
+/// Fields and variants are found by name, variant parameters by their index.
+static int findChildIndex(const SwtiType* type, const char* name, size_t nameLength)
+{
+    size_t childCount = childCountOf(type);
+
+    if (type->type == SwtiTypeCustomVariant) {
+        size_t index = 0;
+        for (size_t i = 0; i < nameLength; ++i) {
+            if (name[i] < '0' || name[i] > '9') {
+                return -1;
+            }
+            index = index * 10 + (size_t) (name[i] - '0');
+        }
+        return nameLength > 0 && index < childCount ? (int) index : -1;
+    }
+
+    for (size_t i = 0; i < childCount; ++i) {
+        const char* childName = childNameOf(type, i);
+        if (childName != 0 && tc_strlen(childName) == nameLength && tc_memcmp(childName, name, nameLength) == 0) {
+            return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+static const SwtiType* childTypeOf(const SwtiType* type, size_t index)
+{
+    if (type->type == SwtiTypeCustom) {
+        return &((const SwtiCustomType*) type)->variantTypes[index]->internal;
+    }
+
+    return swampDumpFieldType(type, index);
+}
+
+/// Marks `node->children[index]` as partially selected and returns it, unless the child is already selected whole.
+static SwampDumpProjectionNode* descend(SwampDumpProjectionNode* node, size_t index)
+{
+    if (node->selections[index] == SwampDumpProjectionWhole) {
+        return 0;
+    }
+    if (node->children[index] == 0) {
+        node->children[index] = createNode(swtiUnalias(childTypeOf(node->type, index)));
+    }
+    node->selections[index] = SwampDumpProjectionPartial;
+
+    return node->children[index];
+}
+
+static void selectWhole(SwampDumpProjectionNode* node, size_t index)
+{
+    if (node->children[index] != 0) {
+        destroyNode(node->children[index]);
+        node->children[index] = 0;
+    }
+    node->selections[index] = SwampDumpProjectionWhole;
+}
+
+static int addPath(SwampDumpProjection* self, const char* path)
+{
+    SwampDumpProjectionNode* node = self->root;
+    const char* p = path;
+
+    while (node != 0) {
+        const char* nameStart = p;
+        while (*p != 0 && *p != '.' && *p != '[') {
+            p++;
+        }
+        size_t nameLength = p - nameStart;
+
+        if (node->type->type == SwtiTypeList || node->type->type == SwtiTypeArray || childCountOf(node->type) == 0) {
+            CLOG_SOFT_ERROR("projection '%s': '%.*s' is not inside a record, tuple or custom type", path,
+                            (int) nameLength, nameStart)
+            return -1;
+        }
+
+        int fieldIndex = findChildIndex(node->type, nameStart, nameLength);
+        if (fieldIndex < 0) {
+            CLOG_SOFT_ERROR("projection '%s': unknown field '%.*s' in '%s'", path, (int) nameLength, nameStart,
+                            node->type->name)
+            return -2;
+        }
+
+        int allItems = 0;
+        if (*p == '[') {
+            if (p[1] != '*' || p[2] != ']') {
+                CLOG_SOFT_ERROR("projection '%s': only [*] is supported", path)
+                return -3;
+            }
+            p += 3;
+            allItems = 1;
+        }
+
+        if (*p == 0 && !allItems) {
+            selectWhole(node, fieldIndex);
+            return 0;
+        }
+
+        node = descend(node, fieldIndex);
+        if (node == 0) {
+            return 0;
+        }
+
+        if (allItems) {
+            if (node->type->type != SwtiTypeList && node->type->type != SwtiTypeArray) {
+                CLOG_SOFT_ERROR("projection '%s': [*] used on something that is not a list or array", path)
+                return -3;
+            }
+            if (*p == 0) {
+                selectWhole(node, 0);
+                return 0;
+            }
+            node = descend(node, 0);
+            if (node == 0) {
+                return 0;
+            }
+        }
+
+        if (*p != '.') {
+            CLOG_SOFT_ERROR("projection '%s': expected '.' at '%s'", path, p)
+            return -3;
+        }
+        p++;
+    }
+
+    return 0;
+}
+
+int swampDumpProjectionInit(SwampDumpProjection* self, const SwtiType* type, const char* const* paths,
+                            size_t pathCount)
+{
+    self->type = type;
+    self->root = createNode(swtiUnalias(type));
+
+    for (size_t i = 0; i < pathCount; ++i) {
+        int error = addPath(self, paths[i]);
+        if (error < 0) {
+            swampDumpProjectionDestroy(self);
+            return error;
+        }
+    }
+
+    return 0;
+}
+
+void swampDumpProjectionDestroy(SwampDumpProjection* self)
+{
+    if (self->root != 0) {
+        destroyNode(self->root);
+        self->root = 0;
+    }
+}
@@ -0,0 +1,427 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/quantize.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-runtime/swamp_allocate.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+static int bitCountFor(uint32_t maxValue)
+{
+    int bitCount = 0;
+    while (bitCount < 32 && (maxValue >> bitCount) != 0) {
+        bitCount++;
+    }
+
+    return bitCount;
+}
+
+int swampDumpQuantizationInit(SwampDumpQuantization* self, const SwampDumpQuantizedField* fields, size_t fieldCount)
+{
+    self->entries = tc_malloc_type_count(SwampDumpQuantizedEntry, fieldCount == 0 ? 1 : fieldCount);
+    self->entryCount = 0;
+
+    for (size_t i = 0; i < fieldCount; ++i) {
+        const SwampDumpQuantizedField* field = &fields[i];
+        const SwtiType* unaliased = swtiUnalias(field->recordType);
+        if (unaliased->type != SwtiTypeRecord || field->step <= 0 || field->max < field->min) {
+            CLOG_SOFT_ERROR("swampDumpQuantizationInit: illegal annotation for '%s'", field->fieldName)
+            swampDumpQuantizationDestroy(self);
+            return -1;
+        }
+
+        const SwtiRecordType* recordType = (const SwtiRecordType*) unaliased;
+        size_t fieldIndex = 0;
+        while (fieldIndex < recordType->fieldCount && !tc_str_equal(recordType->fields[fieldIndex].name, field->fieldName)) {
+            fieldIndex++;
+        }
+        if (fieldIndex == recordType->fieldCount) {
+            CLOG_SOFT_ERROR("swampDumpQuantizationInit: '%s' has no field '%s'", unaliased->name, field->fieldName)
+            swampDumpQuantizationDestroy(self);
+            return -2;
+        }
+
+        int fieldType = swtiUnalias(recordType->fields[fieldIndex].fieldType)->type;
+        if (fieldType != SwtiTypeInt && fieldType != SwtiTypeFixed) {
+            CLOG_SOFT_ERROR("swampDumpQuantizationInit: '%s' is not an Int or Fixed", field->fieldName)
+            swampDumpQuantizationDestroy(self);
+            return -2;
+        }
+
+        SwampDumpQuantizedEntry* entry = &self->entries[self->entryCount++];
+        entry->recordType = unaliased;
+        entry->fieldIndex = fieldIndex;
+        entry->min = field->min;
+        entry->max = field->max;
+        entry->step = field->step;
+        entry->maxStepCount = (uint32_t) (((int64_t) field->max - field->min + field->step - 1) / field->step);
+        entry->bitCount = bitCountFor(entry->maxStepCount);
+    }
+
+    return 0;
+}
+
+void swampDumpQuantizationDestroy(SwampDumpQuantization* self)
+{
+    tc_free(self->entries);
+    self->entries = 0;
+    self->entryCount = 0;
+}
+
+static const SwampDumpQuantizedEntry* findEntry(const SwampDumpQuantization* self, const SwtiType* recordType,
+                                                size_t fieldIndex)
+{
+    for (size_t i = 0; i < self->entryCount; ++i) {
+        const SwampDumpQuantizedEntry* entry = &self->entries[i];
+        if (entry->recordType == recordType && entry->fieldIndex == fieldIndex) {
+            return entry;
+        }
+    }
+
+    return 0;
+}
+
+/// The annotation of a field travels in the userPointer of its frame.
+static int annotateItem(const SwampDumpQuantization* quantization, SwampDumpWalkFrame* parent,
+                        SwampDumpWalkFrame* child)
+{
+    child->userPointer = 0;
+    if (parent->type->type == SwtiTypeRecord) {
+        child->userPointer = (void*) findEntry(quantization, parent->type, parent->index);
+    }
+
+    return SwampDumpWalkContinue;
+}
+
+static int variantBitCount(const SwtiType* type)
+{
+    const SwtiCustomType* custom = (const SwtiCustomType*) type;
+    return custom->variantCount == 0 ? 0 : bitCountFor((uint32_t) custom->variantCount - 1);
+}
+
+typedef struct BitWriter {
+    FldOutStream* stream;
+    const SwampDumpQuantization* quantization;
+    uint64_t accumulator;
+    int bitCount;
+} BitWriter;
+
+static int writeBits(BitWriter* self, uint32_t value, int bitCount)
+{
+    if (bitCount == 0) {
+        return 0;
+    }
+
+    self->accumulator = (self->accumulator << bitCount) | (bitCount == 32 ? value : (value & ((1u << bitCount) - 1)));
+    self->bitCount += bitCount;
+    while (self->bitCount >= 8) {
+        self->bitCount -= 8;
+        int error = fldOutStreamWriteUInt8(self->stream, (uint8_t) (self->accumulator >> self->bitCount));
+        if (error < 0) {
+            return error;
+        }
+    }
+
+    return 0;
+}
+
+static int alignWriter(BitWriter* self)
+{
+    if (self->bitCount == 0) {
+        return 0;
+    }
+
+    return writeBits(self, 0, 8 - self->bitCount);
+}
+
+/// The value is clamped to [min, max] first, then rounded to the nearest step.
+static uint32_t quantize(const SwampDumpQuantizedEntry* entry, int32_t value)
+{
+    int32_t clamped = value < entry->min ? entry->min : (value > entry->max ? entry->max : value);
+    int64_t offset = (int64_t) clamped - entry->min;
+
+    uint64_t steps = (uint64_t) ((offset + entry->step / 2) / entry->step);
+    return steps > entry->maxStepCount ? entry->maxStepCount : (uint32_t) steps;
+}
+
+/// The last step can lie beyond max when the range is not a multiple of the step, it decodes as max.
+static int32_t dequantize(const SwampDumpQuantizedEntry* entry, uint32_t steps)
+{
+    int64_t value = (int64_t) entry->min + (int64_t) steps * entry->step;
+
+    return value > entry->max ? entry->max : (int32_t) value;
+}
+
+static int writeScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    BitWriter* self = (BitWriter*) voidSelf;
+    const SwampDumpQuantizedEntry* entry = (const SwampDumpQuantizedEntry*) frame->userPointer;
+
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            return writeBits(self, *(const SwampBool*) frame->value != 0, 1);
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId: {
+            int32_t value = *(const SwampInt32*) frame->value;
+            if (entry != 0) {
+                return writeBits(self, quantize(entry, value), entry->bitCount);
+            }
+            return writeBits(self, (uint32_t) value, 32);
+        }
+        case SwtiTypeString: {
+            const SwampString* string = *(const SwampString**) frame->value;
+            int error = writeBits(self, (uint32_t) string->characterCount + 1, 8);
+            if (error < 0 || (error = alignWriter(self)) < 0) {
+                return error;
+            }
+            return fldOutStreamWriteOctets(self->stream, (const uint8_t*) string->characters,
+                                           string->characterCount + 1);
+        }
+        case SwtiTypeBlob: {
+            const SwampBlob* blob = *(const SwampBlob**) frame->value;
+            int error = writeBits(self, (uint32_t) blob->octetCount, 32);
+            if (error < 0 || (error = alignWriter(self)) < 0) {
+                return error;
+            }
+            return fldOutStreamWriteOctets(self->stream, blob->octets, blob->octetCount);
+        }
+        default:
+            CLOG_SOFT_ERROR("swampDumpToBits: can not write type %d", frame->type->type)
+            return -1;
+    }
+}
+
+static int writeEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    BitWriter* self = (BitWriter*) voidSelf;
+
+    switch (frame->type->type) {
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            return writeBits(self, (uint32_t) frame->count, 8);
+        case SwtiTypeCustom:
+            return writeBits(self, frame->variant, variantBitCount(frame->type));
+        default:
+            return 0;
+    }
+}
+
+static int writeItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    return annotateItem(((BitWriter*) voidSelf)->quantization, parent, child);
+}
+
+static const SwampDumpWalkVisitor bitWriter = {writeScalar, writeEnter, writeItem, 0, 1};
+
+int swampDumpToBits(FldOutStream* stream, const void* v, const SwtiType* type,
+                    const SwampDumpQuantization* quantization)
+{
+    fldOutStreamWriteUInt8(stream, 0);
+    fldOutStreamWriteUInt8(stream, 4);
+    fldOutStreamWriteUInt8(stream, 0);
+
+    BitWriter writer;
+    writer.stream = stream;
+    writer.quantization = quantization;
+    writer.accumulator = 0;
+    writer.bitCount = 0;
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &bitWriter, &writer);
+
+    int error = swampDumpWalk(&walker, type, (void*) v, 0, 0);
+    swampDumpWalkerDestroy(&walker);
+    if (error < 0) {
+        return error;
+    }
+
+    return alignWriter(&writer);
+}
+
+typedef struct BitReader {
+    FldInStream* inStream;
+    const SwampDumpQuantization* quantization;
+    SwampDynamicMemory* memory;
+    uint64_t accumulator;
+    int bitCount;
+} BitReader;
+
+static int readBits(BitReader* self, int bitCount, uint32_t* value)
+{
+    while (self->bitCount < bitCount) {
+        uint8_t octet;
+        int error = fldInStreamReadUInt8(self->inStream, &octet);
+        if (error < 0) {
+            return error;
+        }
+        self->accumulator = (self->accumulator << 8) | octet;
+        self->bitCount += 8;
+    }
+
+    self->bitCount -= bitCount;
+    *value = bitCount == 0 ? 0 : (uint32_t) (self->accumulator >> self->bitCount) & (uint32_t) ((1ull << bitCount) - 1);
+
+    return 0;
+}
+
+/// Whole octets are only read when bits are needed, so what is left is the padding of the current octet.
+static const uint8_t* alignedOctets(BitReader* self, size_t octetCount)
+{
+    FldInStream* inStream = self->inStream;
+
+    self->bitCount = 0;
+    if (inStream->size - inStream->pos < octetCount) {
+        CLOG_SOFT_ERROR("swampDumpFromBits: needs %zu octets, but only %zu left", octetCount,
+                        inStream->size - inStream->pos)
+        return 0;
+    }
+    const uint8_t* octets = inStream->p;
+    inStream->p += octetCount;
+    inStream->pos += octetCount;
+
+    return octets;
+}
+
+static int readScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    BitReader* self = (BitReader*) voidSelf;
+    const SwampDumpQuantizedEntry* entry = (const SwampDumpQuantizedEntry*) frame->userPointer;
+    uint32_t value;
+    int error;
+
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            if ((error = readBits(self, 1, &value)) < 0) {
+                return error;
+            }
+            *(SwampBool*) frame->value = (SwampBool) value;
+            return 0;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            if ((error = readBits(self, entry != 0 ? entry->bitCount : 32, &value)) < 0) {
+                return error;
+            }
+            *(SwampInt32*) frame->value = entry != 0 ? dequantize(entry, value) : (SwampInt32) value;
+            return 0;
+        case SwtiTypeString: {
+            if ((error = readBits(self, 8, &value)) < 0) {
+                return error;
+            }
+            const uint8_t* characters = alignedOctets(self, value);
+            if (characters == 0 || value == 0) {
+                return -3;
+            }
+            *(const SwampString**) frame->value =
+                swampStringAllocateWithSize(self->memory, (const char*) characters, value - 1);
+            return 0;
+        }
+        case SwtiTypeBlob: {
+            if ((error = readBits(self, 32, &value)) < 0) {
+                return error;
+            }
+            const uint8_t* octets = alignedOctets(self, value);
+            if (octets == 0) {
+                return -3;
+            }
+            *(const SwampBlob**) frame->value = swampBlobAllocate(self->memory, value == 0 ? 0 : octets, value);
+            return 0;
+        }
+        default:
+            CLOG_SOFT_ERROR("swampDumpFromBits: can not read type %d", frame->type->type)
+            return -1;
+    }
+}
+
+static int readEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    BitReader* self = (BitReader*) voidSelf;
+    uint32_t value;
+    int error;
+
+    switch (frame->type->type) {
+        case SwtiTypeCustom:
+            if ((error = readBits(self, variantBitCount(frame->type), &value)) < 0) {
+                return error;
+            }
+            frame->variant = (uint8_t) value;
+            *frame->value = frame->variant;
+            return 0;
+        case SwtiTypeList: {
+            const SwtiListType* listType = (const SwtiListType*) frame->type;
+            if ((error = readBits(self, 8, &value)) < 0) {
+                return error;
+            }
+            SwampList* list = swampListAllocatePrepare(self->memory, value, listType->memoryInfo.memorySize,
+                                                       listType->memoryInfo.memoryAlign);
+            *(const SwampList**) frame->value = list;
+            frame->items = (uint8_t*) list->value;
+            frame->itemSize = list->itemSize;
+            frame->count = value;
+            return 0;
+        }
+        case SwtiTypeArray: {
+            const SwtiArrayType* arrayType = (const SwtiArrayType*) frame->type;
+            if ((error = readBits(self, 8, &value)) < 0) {
+                return error;
+            }
+            SwampArray* array = swampArrayAllocatePrepare(self->memory, value, arrayType->memoryInfo.memorySize,
+                                                          arrayType->memoryInfo.memoryAlign);
+            *(const SwampArray**) frame->value = array;
+            frame->items = (uint8_t*) array->value;
+            frame->itemSize = array->itemSize;
+            frame->count = value;
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int readItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    return annotateItem(((BitReader*) voidSelf)->quantization, parent, child);
+}
+
+static const SwampDumpWalkVisitor bitReader = {readScalar, readEnter, readItem, 0, 0};
+
+int swampDumpFromBits(FldInStream* inStream, const SwtiType* type, const SwampDumpQuantization* quantization,
+                      void* target, SwampDynamicMemory* memory)
+{
+    uint8_t major, minor, patch;
+    fldInStreamReadUInt8(inStream, &major);
+    fldInStreamReadUInt8(inStream, &minor);
+    int error = fldInStreamReadUInt8(inStream, &patch);
+    if (error < 0) {
+        return error;
+    }
+    if (major != 0 || minor != 4) {
+        CLOG_SOFT_ERROR("swamp-dump: wrong version %d.%d.%d for a bit packed dump", major, minor, patch)
+        return -1;
+    }
+
+    BitReader reader;
+    reader.inStream = inStream;
+    reader.quantization = quantization;
+    reader.memory = memory;
+    reader.accumulator = 0;
+    reader.bitCount = 0;
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &bitReader, &reader);
+
+    int errorCode = swampDumpWalk(&walker, type, target, 0, 0);
+    swampDumpWalkerDestroy(&walker);
+
+    return errorCode;
+}
@@ -0,0 +1,516 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/query.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+static int parseIndex(const char* s, size_t length, size_t* index)
+{
+    if (length == 0) {
+        return -1;
+    }
+
+    size_t value = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (s[i] < '0' || s[i] > '9') {
+            return -1;
+        }
+        value = value * 10 + (size_t) (s[i] - '0');
+    }
+    *index = value;
+
+    return 0;
+}
+
+static int findName(const SwtiType* type, const char* name, size_t nameLength, size_t* index)
+{
+    for (size_t i = 0; i < swampDumpFieldCount(type); ++i) {
+        const char* fieldName = type->type == SwtiTypeRecord ? ((const SwtiRecordType*) type)->fields[i].name
+                                                             : ((const SwtiTupleType*) type)->fields[i].name;
+        if (fieldName != 0 && tc_strlen(fieldName) == nameLength && tc_memcmp(fieldName, name, nameLength) == 0) {
+            *index = i;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+static int findVariant(const SwtiCustomType* custom, const char* name, size_t nameLength, size_t* index)
+{
+    for (size_t i = 0; i < custom->variantCount; ++i) {
+        const char* variantName = custom->variantTypes[i]->name;
+        if (tc_strlen(variantName) == nameLength && tc_memcmp(variantName, name, nameLength) == 0) {
+            *index = i;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+static SwampDumpQueryStep* addStep(SwampDumpQuery* self, const char* path, SwampDumpQueryStepKind kind,
+                                   const SwtiType* type, size_t index)
+{
+    if (self->stepCount == SWAMP_DUMP_QUERY_MAX_STEPS) {
+        CLOG_SOFT_ERROR("query '%s': more than %d steps", path, SWAMP_DUMP_QUERY_MAX_STEPS)
+        return 0;
+    }
+
+    SwampDumpQueryStep* step = &self->steps[self->stepCount++];
+    step->kind = kind;
+    step->type = type;
+    step->index = index;
+    step->hasFixedSkip = 0;
+    step->fixedSkipOctetCount = 0;
+
+    return step;
+}
+
+static int compileName(SwampDumpQuery* self, const char* path, const SwtiType** current, const char* name,
+                       size_t nameLength)
+{
+    size_t index;
+    const SwtiType* type = *current;
+
+    switch (type->type) {
+        case SwtiTypeRecord:
+        case SwtiTypeTuple:
+        case SwtiTypeCustomVariant: {
+            int found = type->type == SwtiTypeCustomVariant ? parseIndex(name, nameLength, &index)
+                                                            : findName(type, name, nameLength, &index);
+            if (found < 0 || index >= swampDumpFieldCount(type)) {
+                CLOG_SOFT_ERROR("query '%s': unknown field '%.*s' in '%s'", path, (int) nameLength, name, type->name)
+                return -2;
+            }
+            SwampDumpQueryStep* step = addStep(self, path, SwampDumpQueryField, type, index);
+            if (step == 0) {
+                return -1;
+            }
+            size_t skip = 0;
+            step->hasFixedSkip = 1;
+            for (size_t i = 0; i < index && step->hasFixedSkip; ++i) {
+                size_t fieldOctetCount;
+                step->hasFixedSkip = swampDumpFixedOctetCount(swampDumpFieldType(type, i), &fieldOctetCount);
+                skip += fieldOctetCount;
+            }
+            step->fixedSkipOctetCount = step->hasFixedSkip ? skip : 0;
+            *current = swtiUnalias(swampDumpFieldType(type, index));
+        } break;
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            if (findVariant(custom, name, nameLength, &index) < 0) {
+                CLOG_SOFT_ERROR("query '%s': unknown variant '%.*s' in '%s'", path, (int) nameLength, name,
+                                type->name)
+                return -2;
+            }
+            if (addStep(self, path, SwampDumpQueryVariant, type, index) == 0) {
+                return -1;
+            }
+            *current = &custom->variantTypes[index]->internal;
+        } break;
+        default:
+            CLOG_SOFT_ERROR("query '%s': '%s' has no field '%.*s'", path, type->name, (int) nameLength, name)
+            return -2;
+    }
+
+    return 0;
+}
+
+static int compileItem(SwampDumpQuery* self, const char* path, const SwtiType** current, const char* digits,
+                       size_t digitCount)
+{
+    size_t index;
+    const SwtiType* type = *current;
+
+    if (type->type != SwtiTypeList && type->type != SwtiTypeArray) {
+        CLOG_SOFT_ERROR("query '%s': '%s' is not a list or array", path, type->name)
+        return -2;
+    }
+    if (parseIndex(digits, digitCount, &index) < 0) {
+        CLOG_SOFT_ERROR("query '%s': illegal item index '%.*s'", path, (int) digitCount, digits)
+        return -3;
+    }
+
+    SwampDumpQueryStep* step = addStep(self, path, SwampDumpQueryItem, type, index);
+    if (step == 0) {
+        return -1;
+    }
+    step->hasFixedSkip = swampDumpFixedOctetCount(swampDumpFieldType(type, 0), &step->fixedSkipOctetCount);
+    *current = swtiUnalias(swampDumpFieldType(type, 0));
+
+    return 0;
+}
+
+int swampDumpQueryCompile(SwampDumpQuery* self, const SwtiType* type, const char* path)
+{
+    const SwtiType* current = swtiUnalias(type);
+    const char* p = path;
+
+    self->type = type;
+    self->stepCount = 0;
+
+    while (*p != 0) {
+        const char* name = p;
+        while (*p != 0 && *p != '.' && *p != '[') {
+            p++;
+        }
+        int error;
+        if (p != name && (error = compileName(self, path, &current, name, p - name)) < 0) {
+            return error;
+        }
+
+        while (*p == '[') {
+            const char* digits = ++p;
+            while (*p != 0 && *p != ']') {
+                p++;
+            }
+            if (*p != ']') {
+                CLOG_SOFT_ERROR("query '%s': missing ']'", path)
+                return -3;
+            }
+            if ((error = compileItem(self, path, &current, digits, p - digits)) < 0) {
+                return error;
+            }
+            p++;
+        }
+
+        if (*p == '.') {
+            p++;
+        } else if (*p != 0) {
+            CLOG_SOFT_ERROR("query '%s': unexpected '%c'", path, *p)
+            return -3;
+        }
+    }
+
+    return 0;
+}
+
+static int skipOctets(FldInStream* inStream, size_t octetCount)
+{
+    if (inStream->size - inStream->pos < octetCount) {
+        CLOG_SOFT_ERROR("swampDumpQuery: needs %zu octets, but only %zu left", octetCount,
+                        inStream->size - inStream->pos)
+        return -3;
+    }
+    inStream->p += octetCount;
+    inStream->pos += octetCount;
+
+    return 0;
+}
+
+/// Strings, blobs and lists of fixed size items are skipped by their length prefix, without a walker.
+static int skipValue(FldInStream* inStream, const SwtiType* type)
+{
+    size_t octetCount;
+    if (swampDumpFixedOctetCount(type, &octetCount)) {
+        return skipOctets(inStream, octetCount);
+    }
+
+    int error;
+    const SwtiType* unaliased = swtiUnalias(type);
+    switch (unaliased->type) {
+        case SwtiTypeString: {
+            uint8_t stringLengthIncludingTerminator;
+            if ((error = fldInStreamReadUInt8(inStream, &stringLengthIncludingTerminator)) < 0) {
+                return error;
+            }
+            return skipOctets(inStream, stringLengthIncludingTerminator);
+        }
+        case SwtiTypeBlob: {
+            uint32_t blobOctetCount;
+            if ((error = fldInStreamReadUInt32(inStream, &blobOctetCount)) < 0) {
+                return error;
+            }
+            return skipOctets(inStream, blobOctetCount);
+        }
+        case SwtiTypeList:
+        case SwtiTypeArray: {
+            size_t itemOctetCount;
+            if (!swampDumpFixedOctetCount(swampDumpFieldType(unaliased, 0), &itemOctetCount)) {
+                break;
+            }
+            uint8_t count;
+            if ((error = fldInStreamReadUInt8(inStream, &count)) < 0) {
+                return error;
+            }
+            return skipOctets(inStream, count * itemOctetCount);
+        }
+        default:
+            break;
+    }
+
+    return swampDumpSkipOctetsRaw(inStream, type);
+}
+
+static int runStep(const SwampDumpQueryStep* step, FldInStream* inStream)
+{
+    int error;
+
+    switch (step->kind) {
+        case SwampDumpQueryField:
+            if (step->hasFixedSkip) {
+                return skipOctets(inStream, step->fixedSkipOctetCount);
+            }
+            for (size_t i = 0; i < step->index; ++i) {
+                if ((error = skipValue(inStream, swampDumpFieldType(step->type, i))) < 0) {
+                    return error;
+                }
+            }
+            return 0;
+        case SwampDumpQueryItem: {
+            uint8_t count;
+            if ((error = fldInStreamReadUInt8(inStream, &count)) < 0) {
+                return error;
+            }
+            if (step->index >= count) {
+                return 1;
+            }
+            if (step->hasFixedSkip) {
+                return skipOctets(inStream, step->index * step->fixedSkipOctetCount);
+            }
+            for (size_t i = 0; i < step->index; ++i) {
+                if ((error = skipValue(inStream, swampDumpFieldType(step->type, 0))) < 0) {
+                    return error;
+                }
+            }
+            return 0;
+        }
+        case SwampDumpQueryVariant: {
+            uint8_t variant;
+            if ((error = fldInStreamReadUInt8(inStream, &variant)) < 0) {
+                return error;
+            }
+            return variant == step->index ? 0 : 1;
+        }
+    }
+
+    return -1;
+}
+
+int swampDumpQueryOctetsRaw(const SwampDumpQuery* self, const uint8_t* octets, size_t octetCount,
+                            SwampDumpQueryResult* result)
+{
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, octetCount);
+
+    const uint8_t* valueStart = octets;
+    const SwtiType* valueType = self->type;
+
+    for (size_t i = 0; i < self->stepCount; ++i) {
+        const SwampDumpQueryStep* step = &self->steps[i];
+        int found = runStep(step, &inStream);
+        if (found != 0) {
+            return found;
+        }
+        // The custom type is still the value until a parameter is selected
+        if (step->kind != SwampDumpQueryVariant) {
+            valueStart = inStream.p;
+            valueType = swampDumpFieldType(step->type, step->kind == SwampDumpQueryItem ? 0 : step->index);
+        }
+    }
+
+    inStream.p = valueStart;
+    inStream.pos = valueStart - octets;
+    int error = skipValue(&inStream, valueType);
+    if (error < 0) {
+        return error;
+    }
+
+    result->type = valueType;
+    result->octets = valueStart;
+    result->octetCount = inStream.p - valueStart;
+    result->value = 0;
+
+    FldInStream valueStream;
+    fldInStreamInit(&valueStream, result->octets, result->octetCount);
+    const SwtiType* unaliased = swtiUnalias(valueType);
+    switch (unaliased->type) {
+        case SwtiTypeBoolean: {
+            uint8_t v;
+            fldInStreamReadUInt8(&valueStream, &v);
+            result->value = v;
+        } break;
+        case SwtiTypeCustom: {
+            // A custom type with a fixed size is skipped without looking at the variant index
+            uint8_t v;
+            fldInStreamReadUInt8(&valueStream, &v);
+            if (v >= ((const SwtiCustomType*) unaliased)->variantCount) {
+                CLOG_SOFT_ERROR("swampDumpQuery: illegal variant index %d for '%s'", v, unaliased->name)
+                return -2;
+            }
+            result->value = v;
+        } break;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            fldInStreamReadInt32(&valueStream, &result->value);
+            break;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+int swampDumpQueryOctets(const SwampDumpQuery* self, const uint8_t* octets, size_t octetCount,
+                         SwampDumpQueryResult* result)
+{
+    if (octetCount < 3 || octets[0] != 0 || octets[1] != 1) {
+        CLOG_SOFT_ERROR("swampDumpQuery: not a swamp-dump version 0.1 buffer")
+        return -1;
+    }
+
+    return swampDumpQueryOctetsRaw(self, octets + 3, octetCount - 3, result);
+}
+
+static int haveSameParameters(const SwtiCustomTypeVariant* a, const SwtiCustomTypeVariant* b)
+{
+    if (a->paramCount != b->paramCount) {
+        return 0;
+    }
+    for (size_t i = 0; i < a->paramCount; ++i) {
+        if (a->fields[i].fieldType != b->fields[i].fieldType) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int swampDumpPatchOctets(const SwampDumpQuery* query, uint8_t* octets, size_t octetCount, int32_t value)
+{
+    SwampDumpQueryResult result;
+    int error = swampDumpQueryOctets(query, octets, octetCount, &result);
+    if (error != 0) {
+        return error;
+    }
+
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets + (result.octets - octets), result.octetCount);
+
+    const SwtiType* type = swtiUnalias(result.type);
+    switch (type->type) {
+        case SwtiTypeBoolean:
+            return fldOutStreamWriteUInt8(&outStream, value != 0);
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            return fldOutStreamWriteInt32(&outStream, value);
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) type;
+            if (result.value < 0 || (size_t) result.value >= custom->variantCount || value < 0 ||
+                (size_t) value >= custom->variantCount ||
+                !haveSameParameters(custom->variantTypes[result.value], custom->variantTypes[value])) {
+                CLOG_SOFT_ERROR("swampDumpPatchOctets: can not change '%s' from variant %d to %d in place",
+                                type->name, result.value, value)
+                return -2;
+            }
+            return fldOutStreamWriteUInt8(&outStream, (uint8_t) value);
+        }
+        default:
+            CLOG_SOFT_ERROR("swampDumpPatchOctets: '%s' does not have a fixed size, use swampDumpSpliceOctets()",
+                            type->name)
+            return -2;
+    }
+}
+
+int swampDumpSpliceOctets(const SwampDumpQuery* query, uint8_t* octets, size_t octetCount, size_t capacity,
+                          const uint8_t* replacement, size_t replacementOctetCount, size_t* newOctetCount)
+{
+    SwampDumpQueryResult result;
+    int error = swampDumpQueryOctets(query, octets, octetCount, &result);
+    if (error != 0) {
+        return error;
+    }
+
+    FldInStream replacementStream;
+    fldInStreamInit(&replacementStream, replacement, replacementOctetCount);
+    if ((error = swampDumpSkipOctetsRaw(&replacementStream, result.type)) < 0) {
+        return error;
+    }
+    if (replacementStream.pos != replacementOctetCount) {
+        CLOG_SOFT_ERROR("swampDumpSpliceOctets: replacement is %zu octets, but a '%s' was %zu", replacementOctetCount,
+                        result.type->name, replacementStream.pos)
+        return -3;
+    }
+
+    size_t offset = result.octets - octets;
+    size_t tailOffset = offset + result.octetCount;
+    size_t resultingOctetCount = octetCount - result.octetCount + replacementOctetCount;
+    if (resultingOctetCount > capacity) {
+        CLOG_SOFT_ERROR("swampDumpSpliceOctets: needs %zu octets, but capacity is %zu", resultingOctetCount, capacity)
+        return -4;
+    }
+
+    // Lengths in the format are item counts, so no enclosing value has to be updated
+    tc_memmove_octets(octets + offset + replacementOctetCount, octets + tailOffset, octetCount - tailOffset);
+    tc_memcpy_octets(octets + offset, replacement, replacementOctetCount);
+    *newOctetCount = resultingOctetCount;
+
+    return 0;
+}
+
+int swampDumpFixedStrideListInit(SwampDumpFixedStrideList* self, const SwtiType* listType, const uint8_t* octets,
+                                 size_t octetCount)
+{
+    const SwtiType* unaliased = swtiUnalias(listType);
+    if (unaliased->type != SwtiTypeList && unaliased->type != SwtiTypeArray) {
+        CLOG_SOFT_ERROR("swampDumpFixedStrideListInit: '%s' is not a list or array", listType->name)
+        return -2;
+    }
+
+    self->itemType = swampDumpFieldType(unaliased, 0);
+    self->itemMemorySize = unaliased->type == SwtiTypeList ? ((const SwtiListType*) unaliased)->memoryInfo.memorySize
+                                                           : ((const SwtiArrayType*) unaliased)->memoryInfo.memorySize;
+    if (!swampDumpFixedOctetCount(self->itemType, &self->stride)) {
+        CLOG_SOFT_ERROR("swampDumpFixedStrideListInit: items of '%s' do not have a fixed size", listType->name)
+        return -2;
+    }
+    if (octetCount < 1 || (octetCount - 1) / (self->stride == 0 ? 1 : self->stride) < octets[0]) {
+        CLOG_SOFT_ERROR("swampDumpFixedStrideListInit: %zu octets can not hold %d items", octetCount, octetCount < 1 ? 0 : octets[0])
+        return -3;
+    }
+    self->count = octets[0];
+    self->items = octets + 1;
+
+    return 0;
+}
+
+const uint8_t* swampDumpFixedStrideListItem(const SwampDumpFixedStrideList* self, size_t index)
+{
+    if (index >= self->count) {
+        return 0;
+    }
+
+    return self->items + index * self->stride;
+}
+
+int swampDumpFixedStrideListDecode(const SwampDumpFixedStrideList* self, size_t first, size_t count, void* items)
+{
+    if (first > self->count || count > self->count - first) {
+        CLOG_SOFT_ERROR("swampDumpFixedStrideListDecode: items %zu..%zu are outside the %zu items", first, first + count,
+                        self->count)
+        return -2;
+    }
+
+    FldInStream inStream;
+    fldInStreamInit(&inStream, self->items + first * self->stride, count * self->stride);
+    uint8_t* item = (uint8_t*) items;
+    for (size_t i = 0; i < count; ++i) {
+        int error = swampDumpFromOctetsRaw(&inStream, self->itemType, 0, 0, item, 0, 0);
+        if (error < 0) {
+            return error;
+        }
+        item += self->itemMemorySize;
+    }
+
+    return 0;
+}
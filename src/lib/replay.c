@@ -0,0 +1,521 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/replay.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+static const uint8_t replayVersion = 0;
+static const uint8_t replayEntryKeyframe = 'K';
+static const uint8_t replayEntryDelta = 'D';
+static const uint8_t replayEntrySeekTable = 'S';
+
+// Kind and payload octet count
+static const size_t replayEntryHeaderOctetCount = 5;
+
+// Equal gaps shorter than this are copied rather than skipped, since a new run costs four octets
+static const size_t replayMinimumSkip = 4;
+static const size_t replayMaxRunLength = 0xffff;
+
+#define REPLAY_OUT_OF_MEMORY (-4)
+
+/// Doubles the capacity of a keyframe position table. The table is left as it was when it fails.
+static int growKeyframePositions(uint32_t** keyframePositions, size_t* capacity)
+{
+    size_t newCapacity = *capacity * 2;
+    uint32_t* positions = tc_realloc(*keyframePositions, newCapacity * sizeof(positions[0]));
+    if (positions == 0) {
+        CLOG_SOFT_ERROR("replay: out of memory for %zu keyframe positions", newCapacity)
+        return REPLAY_OUT_OF_MEMORY;
+    }
+    *keyframePositions = positions;
+    *capacity = newCapacity;
+
+    return 0;
+}
+
+/// Writes (or only measures, if stream is NULL) the runs that turn `previous` into `current`.
+/// Each run is a uint16 skip count followed by a uint16 copy count and the copied octets.
+static size_t deltaRuns(const uint8_t* previous, size_t previousCount, const uint8_t* current, size_t currentCount,
+                        FldOutStream* stream)
+{
+    size_t octetCount = 0;
+    size_t pos = 0;
+
+    while (pos < currentCount) {
+        size_t diffStart = pos;
+        while (diffStart < currentCount && diffStart < previousCount && previous[diffStart] == current[diffStart]) {
+            diffStart++;
+        }
+        if (diffStart == currentCount) {
+            break;
+        }
+
+        size_t diffEnd = diffStart;
+        size_t equalCount = 0;
+        while (diffEnd < currentCount && (diffEnd - diffStart) < replayMaxRunLength) {
+            int isEqual = diffEnd < previousCount && previous[diffEnd] == current[diffEnd];
+            if (isEqual) {
+                equalCount++;
+                if (equalCount >= replayMinimumSkip) {
+                    break;
+                }
+            } else {
+                equalCount = 0;
+            }
+            diffEnd++;
+        }
+        if (equalCount > 0) {
+            diffEnd -= equalCount - (equalCount >= replayMinimumSkip ? 1 : 0);
+        }
+
+        size_t skip = diffStart - pos;
+        while (skip > replayMaxRunLength) {
+            if (stream) {
+                fldOutStreamWriteUInt16(stream, (uint16_t) replayMaxRunLength);
+                fldOutStreamWriteUInt16(stream, 0);
+            }
+            octetCount += 4;
+            skip -= replayMaxRunLength;
+        }
+
+        size_t copyCount = diffEnd - diffStart;
+        if (stream) {
+            fldOutStreamWriteUInt16(stream, (uint16_t) skip);
+            fldOutStreamWriteUInt16(stream, (uint16_t) copyCount);
+            fldOutStreamWriteOctets(stream, current + diffStart, copyCount);
+        }
+        octetCount += 4 + copyCount;
+        pos = diffEnd;
+    }
+
+    return octetCount;
+}
+
+static int applyDeltaRuns(uint8_t* state, size_t maxStateOctetCount, size_t stateOctetCount, FldInStream* inStream,
+                          size_t runsOctetCount)
+{
+    if (stateOctetCount > maxStateOctetCount) {
+        CLOG_SOFT_ERROR("replay: state is too large for player %zu", stateOctetCount)
+        return -2;
+    }
+
+    size_t end = inStream->pos + runsOctetCount;
+    size_t pos = 0;
+    while (inStream->pos < end) {
+        uint16_t skip;
+        uint16_t copyCount;
+        fldInStreamReadUInt16(inStream, &skip);
+        int errorCode = fldInStreamReadUInt16(inStream, &copyCount);
+        if (errorCode < 0) {
+            return errorCode;
+        }
+        pos += skip;
+        if (pos + copyCount > stateOctetCount) {
+            CLOG_SOFT_ERROR("replay: delta run is outside of state")
+            return -3;
+        }
+        if ((errorCode = fldInStreamReadOctets(inStream, state + pos, copyCount)) < 0) {
+            return errorCode;
+        }
+        pos += copyCount;
+    }
+
+    return 0;
+}
+
+int swampDumpReplayRecorderInit(SwampDumpReplayRecorder* self, FldOutStream* stream, const SwtiType* type,
+                                size_t keyframeInterval, size_t maxStateOctetCount)
+{
+    if (keyframeInterval == 0) {
+        CLOG_SOFT_ERROR("replay: keyframe interval must be at least one")
+        return -1;
+    }
+
+    self->stream = stream;
+    self->type = type;
+    self->keyframeInterval = keyframeInterval;
+    self->entryCount = 0;
+    self->keyframeCount = 0;
+    self->keyframeCapacity = 32;
+    self->keyframePositions = tc_malloc_type_count(uint32_t, self->keyframeCapacity);
+    self->maxStateOctetCount = maxStateOctetCount;
+    self->previousState = tc_malloc(maxStateOctetCount);
+    self->currentState = tc_malloc(maxStateOctetCount);
+    self->previousStateOctetCount = 0;
+    if (self->keyframePositions == 0 || self->previousState == 0 || self->currentState == 0) {
+        CLOG_SOFT_ERROR("replay: out of memory for states of %zu octets", maxStateOctetCount)
+        swampDumpReplayRecorderDestroy(self);
+        return REPLAY_OUT_OF_MEMORY;
+    }
+
+    fldOutStreamWriteUInt8(stream, replayVersion);
+    return fldOutStreamWriteUInt32(stream, (uint32_t) keyframeInterval);
+}
+
+void swampDumpReplayRecorderDestroy(SwampDumpReplayRecorder* self)
+{
+    tc_free(self->keyframePositions);
+    tc_free(self->previousState);
+    tc_free(self->currentState);
+    self->keyframePositions = 0;
+    self->previousState = 0;
+    self->currentState = 0;
+}
+
+static int hasRoomFor(const FldOutStream* stream, size_t octetCount)
+{
+    if (stream->size - stream->pos < octetCount) {
+        CLOG_SOFT_ERROR("replay: entry needs %zu octets, but only %zu left", octetCount, stream->size - stream->pos)
+        return 0;
+    }
+
+    return 1;
+}
+
+/// Entries are measured before they are written, so a full stream never ends with half an entry.
+int swampDumpReplayRecorderAdd(SwampDumpReplayRecorder* self, const void* v)
+{
+    FldOutStream stateStream;
+    fldOutStreamInit(&stateStream, self->currentState, self->maxStateOctetCount);
+
+    int errorCode = swampDumpToOctets(&stateStream, v, self->type);
+    if (errorCode < 0) {
+        return errorCode;
+    }
+    size_t stateOctetCount = stateStream.pos;
+
+    int isKeyframe = (self->entryCount % self->keyframeInterval) == 0;
+    if (isKeyframe) {
+        if (!hasRoomFor(self->stream, replayEntryHeaderOctetCount + stateOctetCount)) {
+            return -1;
+        }
+        if (self->keyframeCount == self->keyframeCapacity &&
+            (errorCode = growKeyframePositions(&self->keyframePositions, &self->keyframeCapacity)) < 0) {
+            return errorCode;
+        }
+        self->keyframePositions[self->keyframeCount++] = (uint32_t) self->stream->pos;
+        fldOutStreamWriteUInt8(self->stream, replayEntryKeyframe);
+        fldOutStreamWriteUInt32(self->stream, (uint32_t) stateOctetCount);
+        errorCode = fldOutStreamWriteOctets(self->stream, self->currentState, stateOctetCount);
+    } else {
+        size_t runsOctetCount = deltaRuns(self->previousState, self->previousStateOctetCount, self->currentState,
+                                          stateOctetCount, 0);
+        if (!hasRoomFor(self->stream, replayEntryHeaderOctetCount + 4 + runsOctetCount)) {
+            return -1;
+        }
+        fldOutStreamWriteUInt8(self->stream, replayEntryDelta);
+        fldOutStreamWriteUInt32(self->stream, (uint32_t) (4 + runsOctetCount));
+        errorCode = fldOutStreamWriteUInt32(self->stream, (uint32_t) stateOctetCount);
+        deltaRuns(self->previousState, self->previousStateOctetCount, self->currentState, stateOctetCount,
+                  self->stream);
+    }
+    if (errorCode < 0) {
+        return errorCode;
+    }
+
+    uint8_t* temp = self->previousState;
+    self->previousState = self->currentState;
+    self->currentState = temp;
+    self->previousStateOctetCount = stateOctetCount;
+    self->entryCount++;
+
+    return 0;
+}
+
+int swampDumpReplayRecorderFinish(SwampDumpReplayRecorder* self)
+{
+    FldOutStream* stream = self->stream;
+    size_t payloadOctetCount = 8 + self->keyframeCount * 4;
+    size_t seekTablePosition = stream->pos;
+
+    if (!hasRoomFor(stream, replayEntryHeaderOctetCount + payloadOctetCount + 4)) {
+        return -1;
+    }
+
+    fldOutStreamWriteUInt8(stream, replayEntrySeekTable);
+    fldOutStreamWriteUInt32(stream, (uint32_t) payloadOctetCount);
+    fldOutStreamWriteUInt32(stream, (uint32_t) self->entryCount);
+    fldOutStreamWriteUInt32(stream, (uint32_t) self->keyframeCount);
+    for (size_t i = 0; i < self->keyframeCount; ++i) {
+        fldOutStreamWriteUInt32(stream, self->keyframePositions[i]);
+    }
+
+    return fldOutStreamWriteUInt32(stream, (uint32_t) seekTablePosition);
+}
+
+/// Reads the seek table that swampDumpReplayRecorderFinish() appended. Returns 0 if there is no valid table, for
+/// example when the recorder never finished, and 1 if there is.
+static int readSeekTable(SwampDumpReplayPlayer* self, const uint8_t* octets, size_t octetCount,
+                         size_t firstEntryPosition, uint32_t keyframeInterval)
+{
+    if (octetCount < firstEntryPosition + replayEntryHeaderOctetCount + 8 + 4) {
+        return 0;
+    }
+
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets + octetCount - 4, 4);
+    uint32_t seekTablePosition;
+    fldInStreamReadUInt32(&inStream, &seekTablePosition);
+    if (seekTablePosition < firstEntryPosition || seekTablePosition > octetCount - 4 - replayEntryHeaderOctetCount) {
+        return 0;
+    }
+
+    size_t tableOctetCount = octetCount - 4 - seekTablePosition;
+    fldInStreamInit(&inStream, octets + seekTablePosition, tableOctetCount);
+    uint8_t kind;
+    uint32_t payloadOctetCount;
+    uint32_t entryCount;
+    uint32_t keyframeCount;
+    fldInStreamReadUInt8(&inStream, &kind);
+    fldInStreamReadUInt32(&inStream, &payloadOctetCount);
+    fldInStreamReadUInt32(&inStream, &entryCount);
+    if (fldInStreamReadUInt32(&inStream, &keyframeCount) < 0 || kind != replayEntrySeekTable ||
+        payloadOctetCount != tableOctetCount - replayEntryHeaderOctetCount ||
+        payloadOctetCount != 8 + (uint64_t) keyframeCount * 4 ||
+        keyframeCount != (entryCount + (uint64_t) keyframeInterval - 1) / keyframeInterval) {
+        return 0;
+    }
+
+    uint32_t* keyframePositions = tc_malloc_type_count(uint32_t, keyframeCount + 1);
+    if (keyframePositions == 0) {
+        CLOG_SOFT_ERROR("replay: out of memory for %u keyframe positions", keyframeCount)
+        return REPLAY_OUT_OF_MEMORY;
+    }
+    uint32_t previousPosition = 0;
+    for (size_t i = 0; i < keyframeCount; ++i) {
+        fldInStreamReadUInt32(&inStream, &keyframePositions[i]);
+        uint32_t position = keyframePositions[i];
+        if (position < firstEntryPosition || position >= seekTablePosition || (i > 0 && position <= previousPosition) ||
+            octets[position] != replayEntryKeyframe) {
+            tc_free(keyframePositions);
+            return 0;
+        }
+        previousPosition = position;
+    }
+
+    self->entryCount = entryCount;
+    self->keyframeCount = keyframeCount;
+    self->keyframePositions = keyframePositions;
+    self->entriesEnd = seekTablePosition;
+
+    return 1;
+}
+
+/// Without a seek table every entry header is read once to find the keyframes.
+static int scanEntries(SwampDumpReplayPlayer* self, const uint8_t* octets, size_t octetCount,
+                       size_t firstEntryPosition, uint32_t keyframeInterval)
+{
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, octetCount);
+    inStream.p += firstEntryPosition;
+    inStream.pos += firstEntryPosition;
+
+    size_t entryCount = 0;
+    size_t keyframeCapacity = 32;
+    uint32_t* keyframePositions = tc_malloc_type_count(uint32_t, keyframeCapacity);
+    if (keyframePositions == 0) {
+        CLOG_SOFT_ERROR("replay: out of memory for %zu keyframe positions", keyframeCapacity)
+        return REPLAY_OUT_OF_MEMORY;
+    }
+    size_t keyframeCount = 0;
+    size_t entriesEnd = octetCount;
+    while (inStream.pos < octetCount) {
+        size_t position = inStream.pos;
+        uint8_t kind;
+        uint32_t payloadOctetCount;
+        fldInStreamReadUInt8(&inStream, &kind);
+        int errorCode = fldInStreamReadUInt32(&inStream, &payloadOctetCount);
+        if (errorCode < 0) {
+            tc_free(keyframePositions);
+            return errorCode;
+        }
+        if (kind == replayEntrySeekTable) {
+            entriesEnd = position;
+            break;
+        }
+        int isKeyframe = (entryCount % keyframeInterval) == 0;
+        uint8_t expectedKind = isKeyframe ? replayEntryKeyframe : replayEntryDelta;
+        if (kind != expectedKind || payloadOctetCount > octetCount - inStream.pos ||
+            (kind == replayEntryDelta && payloadOctetCount < 4)) {
+            CLOG_SOFT_ERROR("replay: corrupt entry %zu", entryCount)
+            tc_free(keyframePositions);
+            return -2;
+        }
+        if (isKeyframe) {
+            if (keyframeCount == keyframeCapacity &&
+                (errorCode = growKeyframePositions(&keyframePositions, &keyframeCapacity)) < 0) {
+                tc_free(keyframePositions);
+                return errorCode;
+            }
+            keyframePositions[keyframeCount++] = (uint32_t) position;
+        }
+        inStream.p += payloadOctetCount;
+        inStream.pos += payloadOctetCount;
+        entryCount++;
+    }
+
+    self->entryCount = entryCount;
+    self->keyframeCount = keyframeCount;
+    self->keyframePositions = keyframePositions;
+    self->entriesEnd = entriesEnd;
+
+    return 0;
+}
+
+int swampDumpReplayPlayerInit(SwampDumpReplayPlayer* self, const uint8_t* octets, size_t octetCount,
+                              const SwtiType* type, size_t maxStateOctetCount)
+{
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, octetCount);
+
+    uint8_t version;
+    uint32_t keyframeInterval;
+    fldInStreamReadUInt8(&inStream, &version);
+    int errorCode = fldInStreamReadUInt32(&inStream, &keyframeInterval);
+    if (errorCode < 0) {
+        return errorCode;
+    }
+    if (version != replayVersion || keyframeInterval == 0) {
+        CLOG_SOFT_ERROR("replay: unsupported recording version:%d interval:%d", version, keyframeInterval)
+        return -1;
+    }
+
+    size_t firstEntryPosition = inStream.pos;
+    int hasSeekTable = readSeekTable(self, octets, octetCount, firstEntryPosition, keyframeInterval);
+    if (hasSeekTable < 0) {
+        return hasSeekTable;
+    }
+    if (!hasSeekTable &&
+        (errorCode = scanEntries(self, octets, octetCount, firstEntryPosition, keyframeInterval)) < 0) {
+        return errorCode;
+    }
+
+    self->octets = octets;
+    self->octetCount = octetCount;
+    self->type = type;
+    self->keyframeInterval = keyframeInterval;
+    self->maxStateOctetCount = maxStateOctetCount;
+    self->state = tc_malloc(maxStateOctetCount);
+    self->stateOctetCount = 0;
+    self->hasState = 0;
+    if (self->state == 0) {
+        CLOG_SOFT_ERROR("replay: out of memory for a state of %zu octets", maxStateOctetCount)
+        tc_free(self->keyframePositions);
+        self->keyframePositions = 0;
+        return REPLAY_OUT_OF_MEMORY;
+    }
+
+    return 0;
+}
+
+void swampDumpReplayPlayerDestroy(SwampDumpReplayPlayer* self)
+{
+    tc_free(self->keyframePositions);
+    tc_free(self->state);
+    self->keyframePositions = 0;
+    self->state = 0;
+}
+
+static int loadKeyframe(SwampDumpReplayPlayer* self, size_t keyframeIndex)
+{
+    size_t position = self->keyframePositions[keyframeIndex];
+    FldInStream inStream;
+    fldInStreamInit(&inStream, self->octets + position, self->entriesEnd - position);
+
+    uint8_t kind;
+    uint32_t payloadOctetCount;
+    fldInStreamReadUInt8(&inStream, &kind);
+    int errorCode = fldInStreamReadUInt32(&inStream, &payloadOctetCount);
+    if (errorCode < 0) {
+        return errorCode;
+    }
+    if (kind != replayEntryKeyframe) {
+        CLOG_SOFT_ERROR("replay: expected keyframe entry")
+        return -3;
+    }
+    if (payloadOctetCount > self->maxStateOctetCount) {
+        CLOG_SOFT_ERROR("replay: keyframe is too large for player %d", payloadOctetCount)
+        return -2;
+    }
+    if ((errorCode = fldInStreamReadOctets(&inStream, self->state, payloadOctetCount)) < 0) {
+        return errorCode;
+    }
+
+    self->stateOctetCount = payloadOctetCount;
+    self->stateTick = keyframeIndex * self->keyframeInterval;
+    self->stateNextPosition = position + inStream.pos;
+    self->hasState = 1;
+
+    return 0;
+}
+
+static int applyNextDelta(SwampDumpReplayPlayer* self)
+{
+    size_t position = self->stateNextPosition;
+    FldInStream inStream;
+    fldInStreamInit(&inStream, self->octets + position, self->entriesEnd - position);
+
+    uint8_t kind;
+    uint32_t payloadOctetCount;
+    uint32_t stateOctetCount;
+    fldInStreamReadUInt8(&inStream, &kind);
+    fldInStreamReadUInt32(&inStream, &payloadOctetCount);
+    int errorCode = fldInStreamReadUInt32(&inStream, &stateOctetCount);
+    if (errorCode < 0) {
+        return errorCode;
+    }
+    if (kind != replayEntryDelta || payloadOctetCount < 4) {
+        CLOG_SOFT_ERROR("replay: expected delta entry")
+        return -3;
+    }
+
+    if ((errorCode = applyDeltaRuns(self->state, self->maxStateOctetCount, stateOctetCount, &inStream,
+                                    payloadOctetCount - 4)) < 0) {
+        self->hasState = 0;
+        return errorCode;
+    }
+
+    self->stateOctetCount = stateOctetCount;
+    self->stateTick++;
+    self->stateNextPosition = position + inStream.pos;
+
+    return 0;
+}
+
+int swampDumpReplayPlayerSeek(SwampDumpReplayPlayer* self, size_t tick, unmanagedTypeCreator creator, void* context,
+                              void* target, struct SwampDynamicMemory* memory,
+                              struct SwampUnmanagedMemory* targetUnmanagedMemory)
+{
+    if (tick >= self->entryCount) {
+        CLOG_SOFT_ERROR("replay: tick %zu is outside of recording (%zu entries)", tick, self->entryCount)
+        return -1;
+    }
+
+    size_t keyframeIndex = tick / self->keyframeInterval;
+    int canContinue = self->hasState && self->stateTick <= tick &&
+                      (self->stateTick / self->keyframeInterval) == keyframeIndex;
+    if (!canContinue) {
+        int errorCode = loadKeyframe(self, keyframeIndex);
+        if (errorCode < 0) {
+            return errorCode;
+        }
+    }
+
+    while (self->stateTick < tick) {
+        int errorCode = applyNextDelta(self);
+        if (errorCode < 0) {
+            return errorCode;
+        }
+    }
+
+    FldInStream stateStream;
+    fldInStreamInit(&stateStream, self->state, self->stateOctetCount);
+
+    return swampDumpFromOctets(&stateStream, self->type, creator, context, target, memory, targetUnmanagedMemory);
+}
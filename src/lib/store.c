@@ -0,0 +1,669 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/migrate.h>
+#include <swamp-dump/store.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-runtime/swamp_allocate.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+#define CHUNK_INLINE (0)
+#define CHUNK_REFERENCE (1)
+
+/// Only values of these types can be chunks. Each of them gets a marker octet in the encoding of its parent.
+static int canBeChunk(const SwtiType* type)
+{
+    switch (type->type) {
+        case SwtiTypeRecord:
+        case SwtiTypeList:
+        case SwtiTypeArray:
+        case SwtiTypeBlob:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+int swampDumpStoreInit(SwampDumpStore* self, size_t initialCapacity, size_t threshold)
+{
+    size_t capacity = 16;
+    while (capacity < initialCapacity * 2) {
+        capacity *= 2;
+    }
+
+    self->chunkCount = 0;
+    self->threshold = threshold;
+    self->storedOctetCount = 0;
+    self->chunks = tc_malloc_type_count(SwampDumpStoreChunk, capacity);
+    if (self->chunks == 0) {
+        CLOG_SOFT_ERROR("swampDumpStoreInit: out of memory for %zu chunks", capacity)
+        self->capacity = 0;
+        return -3;
+    }
+    tc_mem_clear_type_n(self->chunks, capacity);
+    self->capacity = capacity;
+
+    return 0;
+}
+
+void swampDumpStoreDestroy(SwampDumpStore* self)
+{
+    for (size_t i = 0; i < self->capacity; ++i) {
+        tc_free(self->chunks[i].octets);
+    }
+    tc_free(self->chunks);
+    self->chunks = 0;
+    self->capacity = 0;
+    self->chunkCount = 0;
+}
+
+static SwampDumpStoreChunk* findSlot(SwampDumpStoreChunk* chunks, size_t capacity, uint64_t hash)
+{
+    size_t mask = capacity - 1;
+    for (size_t i = (size_t) hash & mask;; i = (i + 1) & mask) {
+        if (chunks[i].octets == 0 || chunks[i].hash == hash) {
+            return &chunks[i];
+        }
+    }
+}
+
+const SwampDumpStoreChunk* swampDumpStoreFind(const SwampDumpStore* self, uint64_t hash)
+{
+    const SwampDumpStoreChunk* chunk = findSlot(self->chunks, self->capacity, hash);
+
+    return chunk->octets == 0 ? 0 : chunk;
+}
+
+static int grow(SwampDumpStore* self)
+{
+    size_t capacity = self->capacity * 2;
+    SwampDumpStoreChunk* chunks = tc_malloc_type_count(SwampDumpStoreChunk, capacity);
+    if (chunks == 0) {
+        CLOG_SOFT_ERROR("swampDumpStore: out of memory for %zu chunks", capacity)
+        return -3;
+    }
+    tc_mem_clear_type_n(chunks, capacity);
+
+    for (size_t i = 0; i < self->capacity; ++i) {
+        if (self->chunks[i].octets != 0) {
+            *findSlot(chunks, capacity, self->chunks[i].hash) = self->chunks[i];
+        }
+    }
+
+    tc_free(self->chunks);
+    self->chunks = chunks;
+    self->capacity = capacity;
+
+    return 0;
+}
+
+/// Takes ownership of `octets`, also when it fails.
+static int insertChunk(SwampDumpStore* self, uint64_t hash, uint8_t* octets, size_t octetCount)
+{
+    if ((self->chunkCount + 1) * 2 > self->capacity) {
+        int error = grow(self);
+        if (error < 0) {
+            tc_free(octets);
+            return error;
+        }
+    }
+
+    SwampDumpStoreChunk* chunk = findSlot(self->chunks, self->capacity, hash);
+    if (chunk->octets != 0) {
+        tc_free(octets);
+        return 0;
+    }
+
+    chunk->hash = hash;
+    chunk->octets = octets;
+    chunk->octetCount = octetCount;
+    self->chunkCount++;
+    self->storedOctetCount += octetCount;
+
+    return 0;
+}
+
+/// Copies the octets into a new allocation that the store owns.
+static int insertChunkCopy(SwampDumpStore* self, uint64_t hash, const uint8_t* octets, size_t octetCount)
+{
+    uint8_t* copy = tc_malloc(octetCount == 0 ? 1 : octetCount);
+    if (copy == 0) {
+        CLOG_SOFT_ERROR("swampDumpStore: out of memory for a chunk of %zu octets", octetCount)
+        return -3;
+    }
+    tc_memcpy_octets(copy, octets, octetCount);
+
+    return insertChunk(self, hash, copy, octetCount);
+}
+
+int swampDumpStoreAdd(SwampDumpStore* self, uint64_t hash, const uint8_t* octets, size_t octetCount)
+{
+    return insertChunkCopy(self, hash, octets, octetCount);
+}
+
+/// A list, array, record or blob that is being encoded or decoded as a chunk candidate. `frameIndex` is where the
+/// walker keeps the frame of the candidate, the level is closed when the walk leaves that frame.
+typedef struct ChunkWriteLevel {
+    size_t frameIndex;
+    const SwtiType* type;
+    size_t start;
+    size_t overheadOctetCount;   ///< markers and references inside the candidate
+    size_t referencedOctetCount; ///< what the referenced sub-chunks would have taken inline
+} ChunkWriteLevel;
+
+typedef struct TypeFingerprint {
+    const SwtiType* type;
+    uint64_t fingerprint;
+} TypeFingerprint;
+
+#define CHUNK_INLINE_LEVEL_COUNT (16)
+#define CHUNK_FINGERPRINT_CACHE_COUNT (8)
+
+/// The whole snapshot is encoded in one walk. Every chunk candidate is encoded in place after a placeholder marker,
+/// and when it is done it either stays there or is moved to a chunk of its own and replaced with its key. Sizes and
+/// keys are computed bottom up, so each octet is encoded and hashed once.
+typedef struct ChunkWriter {
+    SwampDumpStore* store;
+    const SwampDumpWalker* walker;
+    uint8_t* octets;
+    size_t octetCount;
+    size_t capacity;
+    ChunkWriteLevel* levels;
+    size_t levelCount;
+    size_t levelCapacity;
+    ChunkWriteLevel inlineLevels[CHUNK_INLINE_LEVEL_COUNT];
+    TypeFingerprint fingerprints[CHUNK_FINGERPRINT_CACHE_COUNT];
+    size_t nextFingerprint;
+} ChunkWriter;
+
+static uint64_t fingerprintOf(ChunkWriter* self, const SwtiType* type)
+{
+    for (size_t i = 0; i < CHUNK_FINGERPRINT_CACHE_COUNT; ++i) {
+        if (self->fingerprints[i].type == type) {
+            return self->fingerprints[i].fingerprint;
+        }
+    }
+
+    TypeFingerprint* entry = &self->fingerprints[self->nextFingerprint];
+    self->nextFingerprint = (self->nextFingerprint + 1) % CHUNK_FINGERPRINT_CACHE_COUNT;
+    entry->type = type;
+    entry->fingerprint = swampDumpTypeFingerprint(type);
+
+    return entry->fingerprint;
+}
+
+/// Equal octets only share a chunk if they were written as the same type with the same threshold.
+static uint64_t chunkKey(ChunkWriter* self, const SwtiType* type, const uint8_t* octets, size_t octetCount)
+{
+    uint8_t key[24];
+    FldOutStream keyStream;
+
+    fldOutStreamInit(&keyStream, key, sizeof(key));
+    fldOutStreamWriteUInt64(&keyStream, swampDumpHashOctets(octets, octetCount));
+    fldOutStreamWriteUInt64(&keyStream, fingerprintOf(self, type));
+    fldOutStreamWriteUInt64(&keyStream, (uint64_t) self->store->threshold);
+
+    return swampDumpHashOctets(key, sizeof(key));
+}
+
+static int reserve(ChunkWriter* self, size_t octetCount)
+{
+    if (self->octetCount + octetCount <= self->capacity) {
+        return 0;
+    }
+
+    size_t capacity = self->capacity;
+    while (capacity < self->octetCount + octetCount) {
+        capacity *= 2;
+    }
+    uint8_t* octets = tc_realloc(self->octets, capacity);
+    if (octets == 0) {
+        CLOG_SOFT_ERROR("swampDumpStoreWrite: out of memory for %zu octets", capacity)
+        return -3;
+    }
+    self->octets = octets;
+    self->capacity = capacity;
+
+    return 0;
+}
+
+static int writeOctet(ChunkWriter* self, uint8_t octet)
+{
+    int error = reserve(self, 1);
+    if (error < 0) {
+        return error;
+    }
+    self->octets[self->octetCount++] = octet;
+
+    return 0;
+}
+
+static int reserveWriteLevel(ChunkWriter* self)
+{
+    if (self->levelCount < self->levelCapacity) {
+        return 0;
+    }
+
+    size_t capacity = self->levelCapacity * 2;
+    ChunkWriteLevel* levels = tc_malloc_type_count(ChunkWriteLevel, capacity);
+    if (levels == 0) {
+        CLOG_SOFT_ERROR("swampDumpStoreWrite: out of memory for %zu levels", capacity)
+        return -3;
+    }
+    tc_memcpy_octets(levels, self->levels, self->levelCount * sizeof(ChunkWriteLevel));
+    if (self->levels != self->inlineLevels) {
+        tc_free(self->levels);
+    }
+    self->levels = levels;
+    self->levelCapacity = capacity;
+
+    return 0;
+}
+
+/// Keeps the candidate inline if it is small, otherwise moves it to a chunk and leaves the key in its place.
+static int closeWriteLevel(ChunkWriter* self)
+{
+    ChunkWriteLevel* level = &self->levels[--self->levelCount];
+    ChunkWriteLevel* parent = &self->levels[self->levelCount - 1];
+    size_t octetCount = self->octetCount - level->start;
+    size_t inlineOctetCount = octetCount - level->overheadOctetCount + level->referencedOctetCount;
+
+    if (inlineOctetCount < self->store->threshold) {
+        self->octets[level->start - 1] = CHUNK_INLINE;
+        parent->overheadOctetCount += 1 + level->overheadOctetCount;
+        parent->referencedOctetCount += level->referencedOctetCount;
+        return 0;
+    }
+
+    uint64_t hash = chunkKey(self, level->type, self->octets + level->start, octetCount);
+    int error;
+    if (swampDumpStoreFind(self->store, hash) == 0 &&
+        (error = insertChunkCopy(self->store, hash, self->octets + level->start, octetCount)) < 0) {
+        return error;
+    }
+
+    self->octetCount = level->start - 1;
+    FldOutStream stream;
+    error = reserve(self, 9);
+    if (error < 0) {
+        return error;
+    }
+    fldOutStreamInit(&stream, self->octets + self->octetCount, 9);
+    fldOutStreamWriteUInt8(&stream, CHUNK_REFERENCE);
+    fldOutStreamWriteUInt64(&stream, hash);
+    self->octetCount += 9;
+
+    parent->overheadOctetCount += 9;
+    parent->referencedOctetCount += inlineOctetCount;
+
+    return 0;
+}
+
+/// The octets that swampDumpToOctetsRaw() writes for a scalar.
+static int scalarOctetCount(const SwampDumpWalkFrame* frame, size_t* octetCount)
+{
+    switch (frame->type->type) {
+        case SwtiTypeBoolean:
+            *octetCount = 1;
+            return 0;
+        case SwtiTypeInt:
+        case SwtiTypeFixed:
+        case SwtiTypeRefId:
+            *octetCount = 4;
+            return 0;
+        case SwtiTypeString:
+            *octetCount = 2 + (*(const SwampString**) frame->value)->characterCount;
+            return 0;
+        case SwtiTypeBlob:
+            *octetCount = 4 + (*(const SwampBlob**) frame->value)->octetCount;
+            return 0;
+        default:
+            CLOG_SOFT_ERROR("swampDumpStore: can not store type %d", frame->type->type)
+            return -1;
+    }
+}
+
+static int writeScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    ChunkWriter* self = (ChunkWriter*) voidSelf;
+    size_t octetCount;
+    int error;
+
+    if ((error = scalarOctetCount(frame, &octetCount)) < 0 || (error = reserve(self, octetCount)) < 0) {
+        return error;
+    }
+
+    FldOutStream stream;
+    fldOutStreamInit(&stream, self->octets + self->octetCount, octetCount);
+    if ((error = swampDumpToOctetsRaw(&stream, frame->value, frame->type)) < 0) {
+        return error;
+    }
+    self->octetCount += stream.pos;
+
+    if (self->levels[self->levelCount - 1].frameIndex == self->walker->depth) {
+        return closeWriteLevel(self);
+    }
+
+    return 0;
+}
+
+static int writeEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    ChunkWriter* self = (ChunkWriter*) voidSelf;
+
+    switch (frame->type->type) {
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            return writeOctet(self, (uint8_t) frame->count);
+        case SwtiTypeCustom:
+            return writeOctet(self, frame->variant);
+        default:
+            return 0;
+    }
+}
+
+static int writeItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    (void) parent;
+
+    ChunkWriter* self = (ChunkWriter*) voidSelf;
+    if (!canBeChunk(child->type)) {
+        return SwampDumpWalkContinue;
+    }
+
+    int error;
+    if ((error = writeOctet(self, CHUNK_INLINE)) < 0 || (error = reserveWriteLevel(self)) < 0) {
+        return error;
+    }
+
+    ChunkWriteLevel* level = &self->levels[self->levelCount++];
+    level->frameIndex = self->walker->depth;
+    level->type = child->type;
+    level->start = self->octetCount;
+    level->overheadOctetCount = 0;
+    level->referencedOctetCount = 0;
+
+    return SwampDumpWalkContinue;
+}
+
+static int writeLeave(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    (void) frame;
+
+    ChunkWriter* self = (ChunkWriter*) voidSelf;
+    if (self->levels[self->levelCount - 1].frameIndex == self->walker->depth) {
+        return closeWriteLevel(self);
+    }
+
+    return 0;
+}
+
+static const SwampDumpWalkVisitor chunkWriter = {writeScalar, writeEnter, writeItem, writeLeave, 1};
+
+int swampDumpStoreWrite(SwampDumpStore* self, const void* v, const SwtiType* type, uint64_t* rootHash)
+{
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    ChunkWriter writer;
+
+    writer.store = self;
+    writer.walker = &walker;
+    writer.capacity = 256;
+    writer.octets = tc_malloc(writer.capacity);
+    if (writer.octets == 0) {
+        CLOG_SOFT_ERROR("swampDumpStoreWrite: out of memory for %zu octets", writer.capacity)
+        return -3;
+    }
+    writer.octetCount = 0;
+    writer.levels = writer.inlineLevels;
+    writer.levelCapacity = CHUNK_INLINE_LEVEL_COUNT;
+    writer.levelCount = 1;
+    writer.levels[0].frameIndex = (size_t) -1;
+    writer.levels[0].type = type;
+    writer.levels[0].start = 0;
+    writer.levels[0].overheadOctetCount = 0;
+    writer.levels[0].referencedOctetCount = 0;
+    tc_mem_clear_type_n(writer.fingerprints, CHUNK_FINGERPRINT_CACHE_COUNT);
+    writer.nextFingerprint = 0;
+
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &chunkWriter, &writer);
+    int error = swampDumpWalk(&walker, type, (void*) v, 0, 0);
+    swampDumpWalkerDestroy(&walker);
+    if (writer.levels != writer.inlineLevels) {
+        tc_free(writer.levels);
+    }
+    if (error < 0) {
+        tc_free(writer.octets);
+        return error;
+    }
+
+    *rootHash = chunkKey(&writer, type, writer.octets, writer.octetCount);
+    if (swampDumpStoreFind(self, *rootHash) != 0) {
+        tc_free(writer.octets);
+        return 0;
+    }
+
+    return insertChunk(self, *rootHash, writer.octets, writer.octetCount);
+}
+
+/// A chunk that is being decoded. Chunks are followed without recursion, so the depth of a snapshot is only
+/// bounded by memory.
+typedef struct ChunkReadLevel {
+    size_t frameIndex;
+    uint64_t hash;
+    FldInStream inStream;
+} ChunkReadLevel;
+
+typedef struct ChunkReader {
+    const SwampDumpStore* store;
+    const SwampDumpWalker* walker;
+    SwampDynamicMemory* memory;
+    ChunkReadLevel* levels;
+    size_t levelCount;
+    size_t levelCapacity;
+    ChunkReadLevel inlineLevels[CHUNK_INLINE_LEVEL_COUNT];
+} ChunkReader;
+
+/// Persisted chunks come from outside, so a chunk that (indirectly) references itself is rejected instead of being
+/// followed forever. Chunks written by swampDumpStoreWrite() can never do that, a value can not contain itself.
+static int pushReadLevel(ChunkReader* self, uint64_t hash, const SwtiType* type)
+{
+    const SwampDumpStoreChunk* chunk = swampDumpStoreFind(self->store, hash);
+    if (chunk == 0) {
+        CLOG_SOFT_ERROR("swampDumpStoreRead: missing chunk %016llX for '%s'", (unsigned long long) hash, type->name)
+        return -2;
+    }
+
+    for (size_t i = 0; i < self->levelCount; ++i) {
+        if (self->levels[i].hash == hash) {
+            CLOG_SOFT_ERROR("swampDumpStoreRead: chunk %016llX for '%s' refers to itself", (unsigned long long) hash,
+                            type->name)
+            return -2;
+        }
+    }
+
+    if (self->levelCount == self->levelCapacity) {
+        size_t capacity = self->levelCapacity * 2;
+        ChunkReadLevel* levels = tc_malloc_type_count(ChunkReadLevel, capacity);
+        if (levels == 0) {
+            CLOG_SOFT_ERROR("swampDumpStoreRead: out of memory for %zu levels", capacity)
+            return -3;
+        }
+        tc_memcpy_octets(levels, self->levels, self->levelCount * sizeof(ChunkReadLevel));
+        if (self->levels != self->inlineLevels) {
+            tc_free(self->levels);
+        }
+        self->levels = levels;
+        self->levelCapacity = capacity;
+    }
+
+    ChunkReadLevel* level = &self->levels[self->levelCount++];
+    level->frameIndex = self->walker->depth;
+    level->hash = hash;
+    fldInStreamInit(&level->inStream, chunk->octets, chunk->octetCount);
+
+    return 0;
+}
+
+static int popReadLevel(ChunkReader* self)
+{
+    const ChunkReadLevel* level = &self->levels[--self->levelCount];
+    if (level->inStream.pos != level->inStream.size) {
+        CLOG_SOFT_ERROR("swampDumpStoreRead: chunk %016llX has %zu octets left", (unsigned long long) level->hash,
+                        level->inStream.size - level->inStream.pos)
+        return -2;
+    }
+
+    return 0;
+}
+
+static FldInStream* currentStream(ChunkReader* self)
+{
+    return &self->levels[self->levelCount - 1].inStream;
+}
+
+static int readScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    ChunkReader* self = (ChunkReader*) voidSelf;
+
+    int error = swampDumpFromOctetsRaw(currentStream(self), frame->type, 0, 0, frame->value, self->memory, 0);
+    if (error < 0) {
+        return error;
+    }
+
+    if (self->levels[self->levelCount - 1].frameIndex == self->walker->depth) {
+        return popReadLevel(self);
+    }
+
+    return 0;
+}
+
+static int readEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    ChunkReader* self = (ChunkReader*) voidSelf;
+    FldInStream* inStream = currentStream(self);
+    uint8_t count;
+    int error;
+
+    switch (frame->type->type) {
+        case SwtiTypeCustom:
+            if ((error = fldInStreamReadUInt8(inStream, &frame->variant)) < 0) {
+                return error;
+            }
+            *frame->value = frame->variant;
+            return 0;
+        case SwtiTypeList: {
+            const SwtiListType* listType = (const SwtiListType*) frame->type;
+            if ((error = fldInStreamReadUInt8(inStream, &count)) < 0) {
+                return error;
+            }
+            SwampList* list = swampListAllocatePrepare(self->memory, count, listType->memoryInfo.memorySize,
+                                                       listType->memoryInfo.memoryAlign);
+            *(const SwampList**) frame->value = list;
+            frame->items = (uint8_t*) list->value;
+            frame->itemSize = list->itemSize;
+            frame->count = count;
+            return 0;
+        }
+        case SwtiTypeArray: {
+            const SwtiArrayType* arrayType = (const SwtiArrayType*) frame->type;
+            if ((error = fldInStreamReadUInt8(inStream, &count)) < 0) {
+                return error;
+            }
+            SwampArray* array = swampArrayAllocatePrepare(self->memory, count, arrayType->memoryInfo.memorySize,
+                                                          arrayType->memoryInfo.memoryAlign);
+            *(const SwampArray**) frame->value = array;
+            frame->items = (uint8_t*) array->value;
+            frame->itemSize = array->itemSize;
+            frame->count = count;
+            return 0;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int readItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    (void) parent;
+
+    ChunkReader* self = (ChunkReader*) voidSelf;
+    if (!canBeChunk(child->type)) {
+        return SwampDumpWalkContinue;
+    }
+
+    FldInStream* inStream = currentStream(self);
+    uint8_t marker;
+    int error = fldInStreamReadUInt8(inStream, &marker);
+    if (error < 0) {
+        return error;
+    }
+    if (marker == CHUNK_INLINE) {
+        return SwampDumpWalkContinue;
+    }
+    if (marker != CHUNK_REFERENCE) {
+        CLOG_SOFT_ERROR("swampDumpStoreRead: unknown chunk marker %d for '%s'", marker, child->type->name)
+        return -2;
+    }
+
+    uint64_t hash;
+    if ((error = fldInStreamReadUInt64(inStream, &hash)) < 0 || (error = pushReadLevel(self, hash, child->type)) < 0) {
+        return error;
+    }
+
+    return SwampDumpWalkContinue;
+}
+
+static int readLeave(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    (void) frame;
+
+    ChunkReader* self = (ChunkReader*) voidSelf;
+    if (self->levels[self->levelCount - 1].frameIndex == self->walker->depth) {
+        return popReadLevel(self);
+    }
+
+    return 0;
+}
+
+static const SwampDumpWalkVisitor chunkReader = {readScalar, readEnter, readItem, readLeave, 0};
+
+int swampDumpStoreRead(const SwampDumpStore* self, uint64_t rootHash, const SwtiType* type, void* target,
+                       SwampDynamicMemory* memory)
+{
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    ChunkReader reader;
+
+    reader.store = self;
+    reader.walker = &walker;
+    reader.memory = memory;
+    reader.levels = reader.inlineLevels;
+    reader.levelCount = 0;
+    reader.levelCapacity = CHUNK_INLINE_LEVEL_COUNT;
+
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &chunkReader, &reader);
+    int error = pushReadLevel(&reader, rootHash, type);
+    if (error == 0) {
+        reader.levels[0].frameIndex = (size_t) -1;
+        error = swampDumpWalk(&walker, type, target, 0, 0);
+    }
+    if (error == 0) {
+        error = popReadLevel(&reader);
+    }
+    swampDumpWalkerDestroy(&walker);
+    if (reader.levels != reader.inlineLevels) {
+        tc_free(reader.levels);
+    }
+
+    return error;
+}
@@ -4,24 +4,45 @@
 *--------------------------------------------------------------------------------------------*/
 #include <clog/clog.h>
 #include <flood/in_stream.h>
+#include <swamp-dump/descriptor.h>
 #include <swamp-dump/dump.h>
+#include <swamp-dump/projection.h>
+#include <swamp-dump/walk.h>
 #include <swamp-typeinfo/typeinfo.h>
 #include <tiny-libc/tiny_libc.h>
 #include <swamp-runtime/dynamic_memory.h>
 #include <swamp-runtime/swamp_allocate.h>
 #include <swamp-runtime/context.h>
 
-static int swampDumpFromOctetsHelper(FldInStream* inStream, const SwtiType* tiType,
-                             unmanagedTypeCreator creator, void* context, void* target, SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)
+typedef struct OctetReader {
+   FldInStream* inStream;
+   unmanagedTypeCreator creator;
+   void* context;
+   SwampDynamicMemory* memory;
+   SwampUnmanagedMemory* targetUnmanagedMemory;
+   SwampDumpProjectionFill fill;
+   int reuse;
+} OctetReader;
+
+static int readScalar(void* voidSelf, SwampDumpWalkFrame* frame)
 {
+   OctetReader* self = (OctetReader*) voidSelf;
+   FldInStream* inStream = self->inStream;
+   void* target = frame->value;
+   const SwtiType* tiType = frame->type;
+
    switch (tiType->type) {
        case SwtiTypeInt: {
-           fldInStreamReadInt32(inStream, (SwampInt32*) target);
-       } break;
+           return fldInStreamReadInt32(inStream, (SwampInt32*) target);
+       }
+
+       case SwtiTypeFixed: {
+           return fldInStreamReadInt32(inStream, (SwampFixed32*) target);
+       }
 
        case SwtiTypeRefId: {
-           fldInStreamReadInt32(inStream, (SwampInt32*) target);
-       } break;
+           return fldInStreamReadInt32(inStream, (SwampInt32*) target);
+       }
 
        case SwtiTypeBoolean: {
            tc_memcpy_octets(target, inStream->p, sizeof(SwampBool));
@@ -32,78 +53,315 @@ static int swampDumpFromOctetsHelper(FldInStream* inStream, const SwtiType* tiTy
        case SwtiTypeString: {
            uint8_t stringLengthIncludingTerminator;
            fldInStreamReadUInt8(inStream, &stringLengthIncludingTerminator);
+           if (inStream->size - inStream->pos < stringLengthIncludingTerminator) {
+               CLOG_SOFT_ERROR("swampDumpFromOctets: string needs %d octets, but only %zu left", stringLengthIncludingTerminator, inStream->size - inStream->pos)
+               return -3;
+           }
 
-           const SwampString* newString = swampStringAllocateWithSize(memory, (const char*)inStream->p, stringLengthIncludingTerminator-1);
-           *(const SwampString**)target = newString;
+           const SwampString* existingString = *(const SwampString**) target;
+           int isSame = self->reuse && existingString != 0 && stringLengthIncludingTerminator > 0 &&
+                        existingString->characterCount == (size_t) stringLengthIncludingTerminator - 1 &&
+                        tc_memcmp(existingString->characters, inStream->p, existingString->characterCount) == 0;
+           if (!isSame) {
+               const SwampString* newString = swampStringAllocateWithSize(self->memory, (const char*)inStream->p, stringLengthIncludingTerminator-1);
+               *(const SwampString**)target = newString;
+           }
            inStream->p += stringLengthIncludingTerminator;
            inStream->pos += stringLengthIncludingTerminator;
            break;
        }
 
-       case SwtiTypeRecord: {
-           const SwtiRecordType* recordType = (const SwtiRecordType*) tiType;
-           for (size_t i = 0; i < recordType->fieldCount; ++i) {
-               const SwtiRecordTypeField* field = &recordType->fields[i];
-               swampDumpFromOctetsHelper(inStream, field->fieldType, creator, context, (uint8_t *)target + field->memoryOffsetInfo.memoryOffset, memory, targetUnmanagedMemory);
+       case SwtiTypeFunction: {
+           CLOG_SOFT_ERROR("functions can not be serialized")
+           return -1;
+       }
+       case SwtiTypeBlob: {
+           uint32_t octetCount;
+           int errorCode = fldInStreamReadUInt32(inStream, &octetCount);
+           if (errorCode < 0) {
+               return errorCode;
            }
+           if (inStream->size - inStream->pos < octetCount) {
+               CLOG_SOFT_ERROR("swampDumpFromOctets: blob needs %u octets, but only %zu left", octetCount, inStream->size - inStream->pos)
+               return -3;
+           }
+           const SwampBlob* existingBlob = *(const SwampBlob**) target;
+           int isSame = self->reuse && existingBlob != 0 && existingBlob->octetCount == octetCount &&
+                        (octetCount == 0 || tc_memcmp(existingBlob->octets, inStream->p, octetCount) == 0);
+           if (!isSame) {
+               SwampBlob* newBlob = swampBlobAllocate(self->memory, octetCount == 0 ? 0 : inStream->p, octetCount);
+               *(const SwampBlob**) target = newBlob;
+           }
+           inStream->p += octetCount;
+           inStream->pos += octetCount;
            break;
        }
+       case SwtiTypeUnmanaged: {
+           const SwtiUnmanagedType* unmanagedType = (const SwtiUnmanagedType*) tiType;
+           if (self->creator == 0) {
+               CLOG_ERROR("tried to deserialize unmanaged '%s', but no creator was provided", unmanagedType->internal.name)
+               return -2;
+           }
 
-       case SwtiTypeTuple: {
-           const SwtiTupleType* tupleType = (const SwtiTupleType*) tiType;
-           for (size_t i = 0; i < tupleType->fieldCount; ++i) {
-               const SwtiTupleTypeField* field = &tupleType->fields[i];
-               swampDumpFromOctetsHelper(inStream, field->fieldType, creator, context, (uint8_t *)target + field->memoryOffsetInfo.memoryOffset, memory, targetUnmanagedMemory);
+           SwampUnmanaged* unmanagedValue = swampUnmanagedMemoryAllocate(self->targetUnmanagedMemory, unmanagedType->internal.name);
+           self->creator(self->context, unmanagedType, unmanagedValue);
+           int errorCode = unmanagedValue->deSerialize(unmanagedValue->ptr, inStream->p, inStream->size - inStream->pos);
+           if (errorCode < 0) {
+               CLOG_SOFT_ERROR("could not deserialize unmanaged type %s %d", unmanagedType->internal.name, errorCode)
+               return errorCode;
            }
+           inStream->p += errorCode;
+           inStream->pos += errorCode;
+           *(const SwampUnmanaged**)target = unmanagedValue;
            break;
        }
+       default:
+           CLOG_ERROR("swampDumpFromOctetsHelper: can not deserialize dump from type %d", tiType->type)
+           return -1;
+           break;
+   }
+
+   return 0;
+}
+
+static int readEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+   OctetReader* self = (OctetReader*) voidSelf;
+   FldInStream* inStream = self->inStream;
 
+   if (frame->descriptor && frame->descriptor->hasFixedOctetCount &&
+       inStream->size - inStream->pos < frame->descriptor->fixedOctetCount) {
+       CLOG_SOFT_ERROR("swampDumpFromOctets: needs %zu octets for '%s', but only %zu left",
+                       frame->descriptor->fixedOctetCount, frame->type->name, inStream->size - inStream->pos)
+       return -3;
+   }
+
+   switch (frame->type->type) {
        case SwtiTypeCustom: {
-           const SwtiCustomType* custom = (const SwtiCustomType*) tiType;
-           uint8_t enumIndex;
-           fldInStreamReadUInt8(inStream, &enumIndex);
-           const SwtiCustomTypeVariant* variant = custom->variantTypes[enumIndex];
-           *(uint8_t*) target = enumIndex;
-           for (size_t i = 0; i < variant->paramCount; ++i) {
-               const SwtiCustomTypeVariantField* field = &variant->fields[i];
-               swampDumpFromOctetsHelper(inStream, field->fieldType, creator, context, (uint8_t *)target + field->memoryOffsetInfo.memoryOffset, memory, targetUnmanagedMemory);
+           int errorCode = fldInStreamReadUInt8(inStream, &frame->variant);
+           if (errorCode < 0) {
+               return errorCode;
+           }
+           if (self->reuse && *frame->value != frame->variant) {
+               // The parameters of the previous variant must not be mistaken for existing values
+               tc_mem_clear(frame->value, swtiGetMemorySize(frame->type));
            }
+           *frame->value = frame->variant;
            break;
        }
 
        case SwtiTypeArray: {
-           const SwtiArrayType* arrayType = (const SwtiArrayType*) tiType;
+           const SwtiArrayType* arrayType = (const SwtiArrayType*) frame->type;
            uint8_t arrayLength;
-           fldInStreamReadUInt8(inStream, &arrayLength);
-           SwampArray* array = swampArrayAllocatePrepare(memory, arrayLength, arrayType->memoryInfo.memorySize, arrayType->memoryInfo.memoryAlign);
-           for (size_t i = 0; i < arrayLength; ++i) {
-               swampDumpFromOctetsHelper(inStream, arrayType->itemType, creator, context, (uint8_t *)array->value + i * array->itemSize, memory, targetUnmanagedMemory);
+           int errorCode = fldInStreamReadUInt8(inStream, &arrayLength);
+           if (errorCode < 0) {
+               return errorCode;
            }
-
-           *(const SwampArray**) target = array;
-       }            break;
-
+           const SwampArray* array = *(const SwampArray**) frame->value;
+           if (!self->reuse || array == 0 || array->count != arrayLength || array->itemSize != arrayType->memoryInfo.memorySize) {
+               array = swampArrayAllocatePrepare(self->memory, arrayLength, arrayType->memoryInfo.memorySize, arrayType->memoryInfo.memoryAlign);
+               if (self->reuse) {
+                   tc_mem_clear((void*) array->value, array->count * array->itemSize);
+               }
+               *(const SwampArray**) frame->value = array;
+           }
+           frame->items = (uint8_t*) array->value;
+           frame->itemSize = array->itemSize;
+           frame->count = arrayLength;
+           break;
+       }
 
        case SwtiTypeList: {
-           const SwtiListType* listType = (const SwtiListType*) tiType;
+           const SwtiListType* listType = (const SwtiListType*) frame->type;
            uint8_t listLength;
-           fldInStreamReadUInt8(inStream, &listLength);
-           SwampList* list = swampListAllocatePrepare(memory, listLength, listType->memoryInfo.memorySize, listType->memoryInfo.memoryAlign);
-           for (size_t i = 0; i < listLength; ++i) {
-               swampDumpFromOctetsHelper(inStream, listType->itemType, creator, context, (uint8_t *)list->value + i * list->itemSize, memory, targetUnmanagedMemory);
+           int errorCode = fldInStreamReadUInt8(inStream, &listLength);
+           if (errorCode < 0) {
+               return errorCode;
+           }
+           const SwampList* list = *(const SwampList**) frame->value;
+           if (!self->reuse || list == 0 || list->count != listLength || list->itemSize != listType->memoryInfo.memorySize) {
+               list = swampListAllocatePrepare(self->memory, listLength, listType->memoryInfo.memorySize, listType->memoryInfo.memoryAlign);
+               if (self->reuse) {
+                   tc_mem_clear((void*) list->value, list->count * list->itemSize);
+               }
+               *(const SwampList**) frame->value = list;
            }
+           frame->items = (uint8_t*) list->value;
+           frame->itemSize = list->itemSize;
+           frame->count = listLength;
+           break;
+       }
+
+       default:
+           break;
+   }
 
-           *(const SwampList**) target = list;
+   return 0;
+}
 
-       } break;
+static const SwampDumpWalkVisitor octetReader = {readScalar, readEnter, 0, 0, 0};
+
+/// Skipped String, Blob, List and Array values get empty ones, so FillZero never leaves a null pointer behind.
+static int fillEmptyScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+   OctetReader* self = (OctetReader*) voidSelf;
+
+   switch (frame->type->type) {
+       case SwtiTypeString:
+           *(const SwampString**) frame->value = swampStringAllocateWithSize(self->memory, "", 0);
+           break;
+       case SwtiTypeBlob:
+           *(const SwampBlob**) frame->value = swampBlobAllocate(self->memory, 0, 0);
+           break;
+       default:
+           break;
+   }
 
-       case SwtiTypeAlias: {
-           const SwtiAliasType* alias = (const SwtiAliasType*) tiType;
-           return swampDumpFromOctetsHelper(inStream, alias->targetType, creator, context, target, memory, targetUnmanagedMemory);
+   return 0;
+}
+
+static int fillEmptyEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+   OctetReader* self = (OctetReader*) voidSelf;
+
+   switch (frame->type->type) {
+       case SwtiTypeCustom:
+           frame->variant = *frame->value;
+           break;
+       case SwtiTypeArray: {
+           const SwtiArrayType* arrayType = (const SwtiArrayType*) frame->type;
+           *(const SwampArray**) frame->value = swampArrayAllocatePrepare(self->memory, 0, arrayType->memoryInfo.memorySize, arrayType->memoryInfo.memoryAlign);
+           frame->count = 0;
+           break;
        }
-       case SwtiTypeFunction: {
-           CLOG_SOFT_ERROR("functions can not be serialized")
-           return -1;
+       case SwtiTypeList: {
+           const SwtiListType* listType = (const SwtiListType*) frame->type;
+           *(const SwampList**) frame->value = swampListAllocatePrepare(self->memory, 0, listType->memoryInfo.memorySize, listType->memoryInfo.memoryAlign);
+           frame->count = 0;
+           break;
+       }
+       default:
+           break;
+   }
+
+   return 0;
+}
+
+/// Fills in memory that is already cleared, so custom types are the first variant.
+static const SwampDumpWalkVisitor emptyFiller = {fillEmptyScalar, fillEmptyEnter, 0, 0, 0};
+
+static int fillEmpty(OctetReader* self, const SwtiType* type, void* value)
+{
+   tc_mem_clear(value, swtiGetMemorySize(type));
+
+   SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+   SwampDumpWalker walker;
+   swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &emptyFiller, self);
+
+   int errorCode = swampDumpWalk(&walker, type, value, 0, 0);
+   swampDumpWalkerDestroy(&walker);
+
+   return errorCode;
+}
+
+/// The frame userPointer is the projection node of the frame, or null when the whole value is decoded.
+static int projectItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+   OctetReader* self = (OctetReader*) voidSelf;
+   const SwampDumpProjectionNode* node = (const SwampDumpProjectionNode*) parent->userPointer;
+
+   if (node == 0) {
+       return SwampDumpWalkContinue;
+   }
+
+   size_t i = (parent->type->type == SwtiTypeList || parent->type->type == SwtiTypeArray) ? 0 : parent->index;
+   uint8_t selection;
+   if (parent->type->type == SwtiTypeCustom) {
+       // The parameters belong to the variant node of the variant that was read
+       selection = node->selections[parent->variant];
+       node = node->children[parent->variant];
+   } else {
+       selection = SwampDumpProjectionPartial;
+   }
+   if (selection == SwampDumpProjectionPartial) {
+       selection = node->selections[i];
+       node = node->children[i];
+   }
+
+   switch (selection) {
+       case SwampDumpProjectionWhole:
+           child->userPointer = 0;
+           return SwampDumpWalkContinue;
+       case SwampDumpProjectionPartial:
+           child->userPointer = (void*) node;
+           return SwampDumpWalkContinue;
+       default: {
+           int errorCode = swampDumpSkipOctetsRaw(self->inStream, child->type);
+           if (errorCode < 0) {
+               return errorCode;
+           }
+           if (self->fill == SwampDumpProjectionFillZero && (errorCode = fillEmpty(self, child->type, child->value)) < 0) {
+               return errorCode;
+           }
+           return SwampDumpWalkSkip;
+       }
+   }
+}
+
+static const SwampDumpWalkVisitor octetProjector = {readScalar, readEnter, projectItem, 0, 0};
+
+static int swampDumpFromOctetsHelper(FldInStream* inStream, const SwtiType* tiType,
+                             unmanagedTypeCreator creator, void* context, void* target, SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory, int reuse)
+{
+   OctetReader reader;
+   reader.inStream = inStream;
+   reader.creator = creator;
+   reader.context = context;
+   reader.memory = memory;
+   reader.targetUnmanagedMemory = targetUnmanagedMemory;
+   reader.fill = SwampDumpProjectionFillUntouched;
+   reader.reuse = reuse;
+
+   SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+   SwampDumpWalker walker;
+   swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &octetReader, &reader);
+
+   int errorCode = swampDumpWalk(&walker, tiType, target, 0, 0);
+   swampDumpWalkerDestroy(&walker);
+
+   return errorCode;
+}
+
+static int skipOctets(FldInStream* inStream, size_t octetCount)
+{
+   if (inStream->size - inStream->pos < octetCount) {
+       CLOG_SOFT_ERROR("swampDumpSkipOctets: needs %zu octets, but only %zu left", octetCount, inStream->size - inStream->pos)
+       return -3;
+   }
+   inStream->p += octetCount;
+   inStream->pos += octetCount;
+
+   return 0;
+}
+
+static int skipScalar(void* self, SwampDumpWalkFrame* frame)
+{
+   FldInStream* inStream = (FldInStream*) self;
+
+   switch (frame->type->type) {
+       case SwtiTypeBoolean:
+           return skipOctets(inStream, sizeof(SwampBool));
+       case SwtiTypeInt:
+       case SwtiTypeFixed:
+       case SwtiTypeRefId:
+           return skipOctets(inStream, sizeof(SwampInt32));
+       case SwtiTypeString: {
+           uint8_t stringLengthIncludingTerminator;
+           int errorCode = fldInStreamReadUInt8(inStream, &stringLengthIncludingTerminator);
+           if (errorCode < 0) {
+               return errorCode;
+           }
+           return skipOctets(inStream, stringLengthIncludingTerminator);
        }
        case SwtiTypeBlob: {
            uint32_t octetCount;
@@ -111,42 +369,75 @@ static int swampDumpFromOctetsHelper(FldInStream* inStream, const SwtiType* tiTy
            if (errorCode < 0) {
                return errorCode;
            }
-           SwampBlob* newBlob = swampBlobAllocate(memory, octetCount == 0 ? 0 : inStream->p, octetCount);
-           inStream->p += octetCount;
-           inStream->pos += octetCount;
-           *(const SwampBlob**) target = newBlob;
-           break;
+           return skipOctets(inStream, octetCount);
        }
-       case SwtiTypeUnmanaged: {
-           const SwtiUnmanagedType* unmanagedType = (const SwtiUnmanagedType*) tiType;
-           if (creator == 0) {
-               CLOG_ERROR("tried to deserialize unmanaged '%s', but no creator was provided", unmanagedType->internal.name)
-               return -2;
-           }
+       default:
+           CLOG_SOFT_ERROR("swampDumpSkipOctets: can not skip type %d", frame->type->type)
+           return -1;
+   }
+}
 
-           SwampUnmanaged* unmanagedValue = swampUnmanagedMemoryAllocate(targetUnmanagedMemory, unmanagedType->internal.name);
-           //swampUnmanagedMemoryAdd(targetUnmanagedMemory, unmanagedValue);
-           creator(context, unmanagedType, unmanagedValue);
-           int errorCode = unmanagedValue->deSerialize(unmanagedValue->ptr, inStream->p, inStream->size - inStream->pos);
+/// Composites with a fixed octet count, and Lists and Arrays of them, are skipped in one step.
+static int skipEnter(void* self, SwampDumpWalkFrame* frame)
+{
+   FldInStream* inStream = (FldInStream*) self;
+
+   switch (frame->type->type) {
+       case SwtiTypeCustom:
+           return fldInStreamReadUInt8(inStream, &frame->variant);
+       case SwtiTypeList:
+       case SwtiTypeArray: {
+           uint8_t count;
+           int errorCode = fldInStreamReadUInt8(inStream, &count);
            if (errorCode < 0) {
-               CLOG_SOFT_ERROR("could not deserialize unmanaged type %s %d", unmanagedType->internal.name, errorCode)
                return errorCode;
            }
-           inStream->p += errorCode;
-           inStream->pos += errorCode;
-           *(const SwampUnmanaged**)target = unmanagedValue;
+           const SwampDumpTypeDescriptor* item = frame->descriptor ? frame->descriptor->fields[0].descriptor : 0;
+           if (item != 0 && item->hasFixedOctetCount) {
+               return skipOctets(inStream, count * item->fixedOctetCount);
+           }
+           frame->count = count;
            break;
        }
        default:
-           CLOG_ERROR("swampDumpFromOctetsHelper: can not deserialize dump from type %d", tiType->type)
-           return -1;
            break;
    }
 
-
    return 0;
 }
 
+static int skipItem(void* self, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+   const SwampDumpTypeDescriptor* descriptor = child->descriptor;
+
+   if (descriptor != 0 && descriptor->hasFixedOctetCount) {
+       int errorCode = skipOctets((FldInStream*) self, descriptor->fixedOctetCount);
+       return errorCode < 0 ? errorCode : SwampDumpWalkSkip;
+   }
+
+   return SwampDumpWalkContinue;
+}
+
+/// Walks the types only, the frames have no values.
+static const SwampDumpWalkVisitor octetSkipper = {skipScalar, skipEnter, skipItem, 0, 0};
+
+int swampDumpSkipOctetsRaw(FldInStream* inStream, const SwtiType* tiType)
+{
+   const SwampDumpTypeDescriptor* descriptor = swampDumpDescriptorFind(tiType);
+   if (descriptor != 0 && descriptor->hasFixedOctetCount) {
+       return skipOctets(inStream, descriptor->fixedOctetCount);
+   }
+
+   SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+   SwampDumpWalker walker;
+   swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &octetSkipper, inStream);
+
+   int errorCode = swampDumpWalk(&walker, tiType, 0, 0, 0);
+   swampDumpWalkerDestroy(&walker);
+
+   return errorCode;
+}
+
 static int readVersion(FldInStream* inStream)
 {
    uint8_t major, minor, patch;
@@ -171,11 +462,65 @@ int swampDumpFromOctets(FldInStream* inStream, const SwtiType* tiType,
        return error;
    }
 
-   return swampDumpFromOctetsHelper(inStream, tiType, creator, context, target, memory, targetUnmanagedMemory);
+   return swampDumpFromOctetsHelper(inStream, tiType, creator, context, target, memory, targetUnmanagedMemory, 0);
 }
 
 int swampDumpFromOctetsRaw(FldInStream* inStream, const SwtiType* tiType,
                           unmanagedTypeCreator creator, void* context, void* target, SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)
 {
-   return swampDumpFromOctetsHelper(inStream, tiType, creator, context, target, memory, targetUnmanagedMemory);
+   return swampDumpFromOctetsHelper(inStream, tiType, creator, context, target, memory, targetUnmanagedMemory, 0);
+}
+
+int swampDumpFromOctetsReuse(FldInStream* inStream, const SwtiType* tiType,
+                            unmanagedTypeCreator creator, void* context, void* target, SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)
+{
+   int error;
+   if ((error = readVersion(inStream)) < 0) {
+       return error;
+   }
+
+   return swampDumpFromOctetsHelper(inStream, tiType, creator, context, target, memory, targetUnmanagedMemory, 1);
+}
+
+int swampDumpFromOctetsReuseRaw(FldInStream* inStream, const SwtiType* tiType,
+                               unmanagedTypeCreator creator, void* context, void* target, SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)
+{
+   return swampDumpFromOctetsHelper(inStream, tiType, creator, context, target, memory, targetUnmanagedMemory, 1);
+}
+
+int swampDumpFromOctetsProjectedRaw(FldInStream* inStream, const SwampDumpProjection* projection,
+                                   SwampDumpProjectionFill fill, unmanagedTypeCreator creator, void* context,
+                                   void* target, SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)
+{
+   OctetReader reader;
+   reader.inStream = inStream;
+   reader.creator = creator;
+   reader.context = context;
+   reader.memory = memory;
+   reader.targetUnmanagedMemory = targetUnmanagedMemory;
+   reader.fill = fill;
+   reader.reuse = 0;
+
+   SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+   SwampDumpWalker walker;
+   swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &octetProjector, &reader);
+   walker.rootUserPointer = projection->root;
+
+   int errorCode = swampDumpWalk(&walker, projection->type, target, 0, 0);
+   swampDumpWalkerDestroy(&walker);
+
+   return errorCode;
+}
+
+int swampDumpFromOctetsProjected(FldInStream* inStream, const SwampDumpProjection* projection,
+                                SwampDumpProjectionFill fill, unmanagedTypeCreator creator, void* context,
+                                void* target, SwampDynamicMemory* memory, SwampUnmanagedMemory* targetUnmanagedMemory)
+{
+   int error;
+   if ((error = readVersion(inStream)) < 0) {
+       return error;
+   }
+
+   return swampDumpFromOctetsProjectedRaw(inStream, projection, fill, creator, context, target, memory,
+                                          targetUnmanagedMemory);
 }
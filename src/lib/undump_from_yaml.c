@@ -6,54 +6,138 @@
 
 #include <clog/clog.h>
 #include <flood/in_stream.h>
-#include <flood/text_in_stream.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-dump/format.h>
+#include <swamp-dump/walk.h>
 #include <swamp-runtime/dynamic_memory.h>
 #include <swamp-runtime/swamp_allocate.h>
 #include <swamp-runtime/types.h>
 #include <swamp-typeinfo/typeinfo.h>
 
-static int detectIndentation(FldTextInStream* inStream)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/// Characters in the input buffer. They are neither copied nor zero terminated.
+typedef struct YamlSpan {
+    const char* characters;
+    size_t count;
+} YamlSpan;
+
+/// Reads directly from the input buffer. Copying the scanner is how a position is saved and restored.
+typedef struct YamlScanner {
+    const char* p;
+    const char* end;
+    const char* lineStart;
+    int line;
+} YamlScanner;
+
+/// Returns the first `ch` in [p, end), or `end`. Sixteen characters are compared at a time.
+static const char* findCharacter(const char* p, const char* end, char ch)
 {
-    char ch;
-    int column;
-    while (1) {
-        if (inStream->inStream->pos == inStream->inStream->size) {
-            column = 0;
+#if defined(__SSE2__)
+    const __m128i pattern = _mm_set1_epi8(ch);
+    for (; end - p >= 16; p += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*) p);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, pattern)) != 0) {
             break;
         }
-        int error = fldTextInStreamReadCh(inStream, &ch);
-        if (error < 0) {
-            return error;
+    }
+#endif
+
+    while (p < end && *p != ch) {
+        p++;
+    }
+
+    return p;
+}
+
+/// Returns the first character in [p, end) that is not a space, or `end`.
+static const char* skipSpaces(const char* p, const char* end)
+{
+#if defined(__SSE2__)
+    const __m128i space = _mm_set1_epi8(' ');
+    for (; end - p >= 16; p += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*) p);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, space)) != 0xffff) {
+            break;
         }
-        if (ch == 10) {
-        } else if (ch == 32) {
-        } else if (ch == 13) {
-            // Just ignore strange CR characters
-        } else {
-            fldTextInStreamUnreadCh(inStream);
-            column = inStream->column;
+    }
+#endif
+
+    while (p < end && *p == ' ') {
+        p++;
+    }
+
+    return p;
+}
+
+static void scannerInit(YamlScanner* self, const uint8_t* octets, size_t count)
+{
+    self->p = (const char*) octets;
+    self->end = self->p + count;
+    self->lineStart = self->p;
+    self->line = 1;
+}
+
+static int scannerColumn(const YamlScanner* self)
+{
+    return (int) (self->p - self->lineStart);
+}
+
+/// `lineEnd` is the '\n' that ends the current line, or the end of the buffer.
+static void scannerNextLine(YamlScanner* self, const char* lineEnd)
+{
+    self->p = lineEnd == self->end ? lineEnd : lineEnd + 1;
+    self->lineStart = self->p;
+    self->line++;
+}
+
+static int isLineEnd(const YamlScanner* self, const char* p)
+{
+    return p == self->end || *p == '\n' || (*p == '\r' && (p + 1 == self->end || p[1] == '\n'));
+}
+
+static int spanEqual(YamlSpan span, const char* s, size_t count)
+{
+    return span.count == count && tc_memcmp(span.characters, s, count) == 0;
+}
+
+/// Skips spaces and empty lines. Returns the indentation level of the first character found.
+static int detectIndentation(YamlScanner* self)
+{
+    while (1) {
+        const char* p = skipSpaces(self->p, self->end);
+        if (p == self->end) {
+            self->p = p;
+            return 0;
+        }
+        if (!isLineEnd(self, p)) {
+            self->p = p;
             break;
         }
+        scannerNextLine(self, findCharacter(p, self->end, '\n'));
     }
 
+    int column = scannerColumn(self);
     if ((column % 2) != 0) {
-        CLOG_SOFT_ERROR("not a proper indentation column:%d '%c'", column + 1, *inStream->inStream->p)
+        CLOG_SOFT_ERROR("%d:%d: not a proper indentation column '%c'", self->line, column + 1, *self->p)
         return -4;
     }
 
     return column / 2;
 }
 
-static int requireIndentation(FldTextInStream* inStream, int requiredIndentation)
+static int requireIndentation(YamlScanner* self, int requiredIndentation)
 {
-    int indentation = detectIndentation(inStream);
+    int indentation = detectIndentation(self);
     if (indentation < 0) {
         return indentation;
     }
 
     if (indentation != requiredIndentation) {
-        CLOG_SOFT_ERROR("%s:unexpected indentation.  required %d but encountered %d",
-                        fldTextInStreamPositionString(inStream), requiredIndentation, indentation)
+        CLOG_SOFT_ERROR("%d:%d: unexpected indentation.  required %d but encountered %d", self->line,
+                        scannerColumn(self) + 1, requiredIndentation, indentation)
         return -4;
     }
 
@@ -75,78 +159,74 @@ static int isAlphaNum(char c)
     return isAlpha(c) || isNumber(c);
 }
 
-static int skipLeadingSpaces(FldTextInStream* inStream)
+static void skipLeadingSpaces(YamlScanner* self)
 {
-    char ch;
-    int spacesSkipped = 0;
+    self->p = skipSpaces(self->p, self->end);
+}
 
-    while (1) {
-        int error = fldTextInStreamReadCh(inStream, &ch);
-        if (error < 0) {
-            return error;
-        }
-        if (ch == 32) {
-            spacesSkipped++;
-        } else {
-            fldTextInStreamUnreadCh(inStream);
-            break;
+static int readVariableIdentifier(YamlScanner* self, YamlSpan* identifier)
+{
+    const char* p = self->p;
+
+    if (p < self->end && isAlpha(*p)) {
+        for (p++; p < self->end && isAlphaNum(*p); ++p) {
         }
     }
 
-    return spacesSkipped;
+    identifier->characters = self->p;
+    identifier->count = (size_t) (p - self->p);
+    self->p = p;
+
+    return (int) identifier->count;
 }
 
-static int readVariableIdentifier(FldTextInStream* inStream, const char** fieldName)
+static int readTypeIdentifierValue(YamlScanner* self, YamlSpan* identifier)
 {
-    char ch;
-    int charsFound = 0;
-    static char name[128];
+    skipLeadingSpaces(self);
 
-    while (1) {
-        int error = fldTextInStreamReadCh(inStream, &ch);
-        if (error < 0) {
-            return error;
-        }
-        if ((charsFound == 0 && isAlpha(ch)) || isAlphaNum(ch)) {
-            name[charsFound++] = ch;
-        } else {
-            fldTextInStreamUnreadCh(inStream);
-            break;
-        }
-    }
-    name[charsFound] = 0;
-    *fieldName = name;
-
-    return charsFound;
+    return readVariableIdentifier(self, identifier);
 }
 
-static int readTypeIdentifierValue(FldTextInStream* inStream, const char** fieldName)
+/// Reads the rest of the line, without the line end, and moves to the next line.
+static void readStringUntilEndOfLine(YamlScanner* self, YamlSpan* foundString)
 {
-    int skipErr = skipLeadingSpaces(inStream);
-    if (skipErr < 0) {
-        return skipErr;
+    const char* lineEnd = findCharacter(self->p, self->end, '\n');
+    const char* stringEnd = lineEnd;
+
+    if (stringEnd > self->p && stringEnd[-1] == '\r') {
+        // Windows support
+        stringEnd--;
     }
 
-    return readVariableIdentifier(inStream, fieldName);
+    foundString->characters = self->p;
+    foundString->count = (size_t) (stringEnd - self->p);
+    scannerNextLine(self, lineEnd);
 }
 
-static int skipWhitespaceAndEndOfLine(FldTextInStream* inStream)
+/// Reads up to the next space or line end, which is left in the buffer. Several values can share a line.
+static void readToken(YamlScanner* self, YamlSpan* token)
 {
-    int errorCode = skipLeadingSpaces(inStream);
-    if (errorCode < 0) {
-        return errorCode;
-    }
+    const char* p = self->p;
 
-    char ch;
-    int error = fldTextInStreamReadCh(inStream, &ch);
-    if (error < 0) {
-        return error;
+    while (p < self->end && *p != ' ' && *p != '\n' && *p != '\r') {
+        p++;
     }
 
-    if (ch != 10) {
+    token->characters = self->p;
+    token->count = (size_t) (p - self->p);
+    self->p = p;
+}
+
+static int skipWhitespaceAndEndOfLine(YamlScanner* self)
+{
+    skipLeadingSpaces(self);
+
+    if (!isLineEnd(self, self->p)) {
         return -5;
     }
 
+    scannerNextLine(self, findCharacter(self->p, self->end, '\n'));
+
     return 0;
 }
 
@@ -156,378 +236,348 @@ typedef enum Marker {
     MarkerAscii,
 } Marker;
 
-static int skipWhitespaceAndBreakMarkerEndOfLine(FldTextInStream* inStream, Marker* marker)
+/// Reads the rest of a blob key line, which is empty, ">" for text rows or ">x" for hex rows.
+static int readBlobMarker(YamlScanner* self, Marker* marker)
 {
-    int errorCode = skipLeadingSpaces(inStream);
-    if (errorCode < 0) {
-        return errorCode;
-    }
+    skipLeadingSpaces(self);
 
-    char ch;
-    int error = fldTextInStreamReadCh(inStream, &ch);
-    if (error < 0) {
-        return error;
+    if (isLineEnd(self, self->p)) {
+        *marker = MarkerNone;
+        return skipWhitespaceAndEndOfLine(self);
     }
 
-    if (ch == 10) {
-        *marker = MarkerNone;
-        return 0;
-    } else if (ch == '>') {
-        char ch2;
+    if (*self->p != '>') {
+        CLOG_SOFT_ERROR("%d:%d: expected '>' before the blob rows, but received '%c'", self->line,
+                        scannerColumn(self) + 1, *self->p)
+        return -5;
+    }
 
-        int endError = fldTextInStreamReadCh(inStream, &ch2);
-        if (endError < 0) {
-            return error;
-        }
-        if (ch2 == 'x') {
-            *marker = MarkerHex;
-        }
+    self->p++;
+    if (self->p < self->end && *self->p == 'x') {
+        *marker = MarkerHex;
+        self->p++;
+    } else {
         *marker = MarkerAscii;
-        if (ch2 == 10) {
-            return 0;
-        }
     }
 
-    return skipWhitespaceAndEndOfLine(inStream);
+    return skipWhitespaceAndEndOfLine(self);
 }
 
-static int readBoolean(FldTextInStream* inStream)
+static int readBoolean(YamlScanner* self)
 {
-    const char* foundName;
+    YamlSpan foundName;
 
-    int skipError = skipLeadingSpaces(inStream);
-    if (skipError < 0) {
-        return skipError;
-    }
-    int errorCode = readVariableIdentifier(inStream, &foundName);
-    if (errorCode < 0) {
-        return errorCode;
-    }
+    skipLeadingSpaces(self);
+    readVariableIdentifier(self, &foundName);
 
-    if (tc_str_equal(foundName, "true")) {
+    if (spanEqual(foundName, "true", 4)) {
         return 1;
-    } else if (tc_str_equal(foundName, "false")) {
+    } else if (spanEqual(foundName, "false", 5)) {
         return 0;
     }
 
-    CLOG_SOFT_ERROR("expected a boolean, but received '%s'", foundName);
+    CLOG_SOFT_ERROR("expected a boolean, but received '%.*s'", (int) foundName.count, foundName.characters)
 
     return -5;
 }
 
-static int readStringUntilEndOfLine(FldTextInStream* inStream, const char** foundString)
-{
-    char ch;
-    int charsFound = 0;
-    static char name[128];
-
-    while (1) {
-        int error = fldTextInStreamReadCh(inStream, &ch);
-        if (error < 0) {
-            return error;
-        }
-        if (ch == 10) {
-            break;
-        } else if (ch == 13) {
-            // Windows support
-            continue;
-        } else {
-            name[charsFound++] = ch;
-        }
-    }
-    name[charsFound] = 0;
-    *foundString = name;
-
-    return charsFound;
-}
-
-static int readBlob(FldTextInStream* inStream, int indentation, SwampDynamicMemory* dynamicMemory, const SwampBlob** out)
+static int readBlob(YamlScanner* self, int indentation, Marker marker, SwampDynamicMemory* dynamicMemory,
+                    const SwampBlob** out)
 {
-    FldTextInStreamState save;
-
-    uint8_t* buf = tc_malloc(16 * 1024);
-    uint8_t* p = buf;
+    size_t capacity = 16 * 1024;
+    size_t count = 0;
+    uint8_t* buf = tc_malloc(capacity);
 
     while (1) {
-        fldTextInStreamTell(inStream, &save);
-        int detectedIndentation = detectIndentation(inStream);
+        YamlScanner probe = *self;
+        int detectedIndentation = detectIndentation(&probe);
         if (detectedIndentation < 0) {
-            fldTextInStreamSeek(inStream, &save);
+            tc_free(buf);
             return detectedIndentation;
         }
-        if (detectedIndentation != indentation) {
-            fldTextInStreamSeek(inStream, &save);
+        if (detectedIndentation != indentation || probe.p == probe.end) {
             break;
         }
+        *self = probe;
+
+        YamlSpan row;
+        readStringUntilEndOfLine(self, &row);
 
-        const char* foundString;
-        int charCount = readStringUntilEndOfLine(inStream, &foundString);
-        if (charCount < 0) {
-            return charCount;
+        while (count + row.count > capacity) {
+            capacity *= 2;
+            buf = tc_realloc(buf, capacity);
         }
 
-        for (size_t i = 0; i < charCount; ++i) {
-            *p++ = foundString[i];
+        if (marker == MarkerHex) {
+            int octetCount = swampDumpParseHexPairs(row.characters, row.count, buf + count);
+            if (octetCount < 0) {
+                CLOG_SOFT_ERROR("'%.*s' is not a row of hex pairs", (int) row.count, row.characters)
+                tc_free(buf);
+                return -5;
+            }
+            count += (size_t) octetCount;
+        } else {
+            tc_memcpy_octets(buf + count, row.characters, row.count);
+            count += row.count;
         }
     }
 
-    *out = swampBlobAllocate(dynamicMemory, buf, p - buf);
+    *out = swampBlobAllocate(dynamicMemory, buf, count);
 
     tc_free(buf);
 
     return 0;
 }
 
-static int readStringValue(FldTextInStream* inStream, const char** foundString)
+static void readStringValue(YamlScanner* self, YamlSpan* foundString)
 {
-    int errorCode = skipLeadingSpaces(inStream);
-    if (errorCode < 0) {
-        return errorCode;
-    }
+    skipLeadingSpaces(self);
 
-    return readStringUntilEndOfLine(inStream, foundString);
+    readStringUntilEndOfLine(self, foundString);
 }
 
-static int checkListContinuation(FldTextInStream* inStream, int indentation)
+/// Returns 1 and moves past the "- " if a sequence item follows on `indentation`, 0 if the sequence has ended.
+/// The dash of an empty item may end the line.
+static int checkListContinuation(YamlScanner* self, int indentation)
 {
-    FldTextInStreamState save;
-
-    fldTextInStreamTell(inStream, &save);
+    YamlScanner probe = *self;
 
-    int detectedIndentation = detectIndentation(inStream);
+    int detectedIndentation = detectIndentation(&probe);
     if (detectedIndentation < 0) {
         CLOG_WARN("list wasn't continued because indentation returned error")
-        fldTextInStreamSeek(inStream, &save);
         return detectedIndentation;
     }
 
-    if (detectedIndentation != indentation) {
-        fldTextInStreamSeek(inStream, &save);
+    if (detectedIndentation != indentation || probe.p == probe.end) {
         return 0;
     }
 
-    char ch;
-    int error = fldTextInStreamReadCh(inStream, &ch);
-    if (error < 0) {
-        fldTextInStreamSeek(inStream, &save);
-        return 0;
+    if (*probe.p != '-') {
+        return -4;
     }
+    probe.p++;
 
-    if (ch != '-') {
+    if (probe.p < probe.end && *probe.p == ' ') {
+        probe.p++;
+    } else if (!isLineEnd(&probe, probe.p)) {
         return -4;
     }
 
-    error = fldTextInStreamReadCh(inStream, &ch);
-    if (error < 0) {
-        return error;
-    }
+    *self = probe;
+
+    return 1;
+}
 
-    if (ch != 32) {
+/// Tuple items and the parameters of variants that are not inline are sequence items that can not be left out.
+static int requireSequenceItem(YamlScanner* self, int indentation)
+{
+    int didContinue = checkListContinuation(self, indentation);
+    if (didContinue < 0) {
+        return didContinue;
+    }
+    if (!didContinue) {
+        CLOG_SOFT_ERROR("%d:%d: expected a '- ' item", self->line, scannerColumn(self) + 1)
         return -4;
     }
 
-    return 1;
+    return 0;
 }
 
-static int readIntegerValue(FldTextInStream* inStream, int32_t* v)
+static int readIntegerValue(YamlScanner* self, int32_t* v)
 {
-    int errorCode = skipLeadingSpaces(inStream);
+    YamlSpan foundString;
+
+    skipLeadingSpaces(self);
+    readToken(self, &foundString);
+
+    int errorCode = swampDumpParseInt32(foundString.characters, foundString.count, v);
     if (errorCode < 0) {
+        CLOG_SOFT_ERROR("'%.*s' is not an Int", (int) foundString.count, foundString.characters)
         return errorCode;
     }
 
-    const char* foundString;
-    errorCode = readStringUntilEndOfLine(inStream, &foundString);
+    return 0;
+}
+
+static int readFixedValue(YamlScanner* self, int32_t* v)
+{
+    YamlSpan foundString;
+
+    skipLeadingSpaces(self);
+    readToken(self, &foundString);
+
+    int errorCode = swampDumpParseFixed32(foundString.characters, foundString.count, v);
     if (errorCode < 0) {
+        CLOG_SOFT_ERROR("'%.*s' is not a Fixed", (int) foundString.count, foundString.characters)
         return errorCode;
     }
 
-    *v = atoi(foundString);
-
     return 0;
 }
 
-static int readFieldNameColonWithIndentation(FldTextInStream* inStream, int requiredIndentation, const char** fieldName)
+static int readFieldNameColonWithIndentation(YamlScanner* self, int requiredIndentation, YamlSpan* fieldName)
 {
-    int errorCode = requireIndentation(inStream, requiredIndentation);
+    int errorCode = requireIndentation(self, requiredIndentation);
     if (errorCode < 0) {
         CLOG_SOFT_ERROR("couldn't read fieldname and colon because indentation is wrong")
         return errorCode;
     }
 
-    int charactersRead = readVariableIdentifier(inStream, fieldName);
-    if (charactersRead < 0) {
-        return charactersRead;
-    }
+    int charactersRead = readVariableIdentifier(self, fieldName);
 
-    char ch;
-    int error = fldTextInStreamReadCh(inStream, &ch);
-    if (error < 0) {
-        return error;
+    if (self->p == self->end || *self->p != ':') {
+        CLOG_SOFT_ERROR("expected colon after %.*s", (int) fieldName->count, fieldName->characters)
+        return -6;
     }
+    self->p++;
 
-    if (ch != ':') {
-        CLOG_SOFT_ERROR("expected colon after %s", *fieldName)
-        return -6;
+    return charactersRead;
+}
+
+typedef struct YamlReader {
+    YamlScanner* scanner;
+    SwampDynamicMemory* dynamicMemory;
+} YamlReader;
+
+#define YAML_MAX_LIST_LENGTH (256)
+
+/// Record, List, Array, Tuple and Blob values start on the line after their key, one indentation level deeper.
+static int typeIsBlock(const SwtiType* unaliasedType)
+{
+    switch (unaliasedType->type) {
+        case SwtiTypeRecord:
+        case SwtiTypeList:
+        case SwtiTypeArray:
+        case SwtiTypeTuple:
+        case SwtiTypeBlob:
+            return 1;
+        default:
+            return 0;
     }
+}
 
-    return 0;
+static const SwtiType* unaliasedTypeOf(const SwampDumpWalkFrame* frame)
+{
+    return frame->descriptor ? frame->descriptor->unaliased : swtiUnalias(frame->type);
 }
 
-static int swampDumpFromYamlHelper(FldTextInStream* inStream, int indentation, SwampDynamicMemory* dynamicMemory,
-                                   const SwtiType* tiType, uint8_t* target, size_t expectedSize)
+static void checkExpectedSize(const SwtiType* unaliasedType, size_t expectedSize)
 {
-    switch (tiType->type) {
+    if (unaliasedType->type == SwtiTypeRecord) {
+        if (((const SwtiRecordType*) unaliasedType)->memoryInfo.memorySize != expectedSize) {
+            CLOG_ERROR("wrong allocation in record")
+        }
+    } else if (unaliasedType->type == SwtiTypeArray) {
+        if (expectedSize != 8) {
+            CLOG_ERROR("needs space to story array pointer")
+        }
+    }
+}
+
+static int readScalar(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    YamlReader* self = (YamlReader*) voidSelf;
+    YamlScanner* scanner = self->scanner;
+    uint8_t* target = frame->value;
+
+    switch (frame->type->type) {
         case SwtiTypeInt: {
             int32_t v;
-            int errorCode = readIntegerValue(inStream, &v);
+            int errorCode = readIntegerValue(scanner, &v);
             if (errorCode < 0) {
                 return errorCode;
             }
             *(SwampInt32*) target = v;
         } break;
+        case SwtiTypeFixed: {
+            int32_t v;
+            int errorCode = readFixedValue(scanner, &v);
+            if (errorCode < 0) {
+                return errorCode;
+            }
+            *(SwampFixed32*) target = v;
+        } break;
         case SwtiTypeRefId: {
             int32_t v;
-            int errorCode = readIntegerValue(inStream, &v);
+            int errorCode = readIntegerValue(scanner, &v);
             if (errorCode < 0) {
                 return errorCode;
             }
             *(SwampInt32*) target = v;
         } break;
         case SwtiTypeBoolean: {
-            int truth = readBoolean(inStream);
+            int truth = readBoolean(scanner);
             if (truth < 0) {
                 return truth;
             }
             *(SwampBool*) target = truth;
         } break;
         case SwtiTypeString: {
-            const char* characters;
-            int errorCode = readStringValue(inStream, &characters);
-            if (errorCode < 0) {
-                return errorCode;
-            }
-            *(const SwampString**) target = swampStringAllocate(dynamicMemory, (const char*) characters);
+            YamlSpan characters;
+            readStringValue(scanner, &characters);
+            *(const SwampString**) target = swampStringAllocateWithSize(self->dynamicMemory, characters.characters,
+                                                                        characters.count);
             break;
         }
-        case SwtiTypeRecord: {
-            const SwtiRecordType* record = (const SwtiRecordType*) tiType;
-            if (record->memoryInfo.memorySize != expectedSize) {
-                CLOG_ERROR("wrong allocation in record")
+        case SwtiTypeFunction: {
+            CLOG_SOFT_ERROR("functions can not be serialized")
+            return -1;
+        }
+        case SwtiTypeResourceName: {
+            CLOG_SOFT_ERROR("resource names can not be serialized")
+            return -1;
+        }
+        case SwtiTypeBlob: {
+            Marker marker;
+            int errorCode = readBlobMarker(scanner, &marker);
+            if (errorCode < 0) {
+                return errorCode;
             }
-            // uint8_t* temp = swampDynamicMemoryAlloc(self, 1, record->memoryInfo.memorySize);
-            for (size_t i = 0; i < record->fieldCount; ++i) {
-                const SwtiRecordTypeField* field = &record->fields[i];
-                const char* foundName;
-                int errorCode = readFieldNameColonWithIndentation(inStream, indentation, &foundName);
-                if (errorCode < 0) {
-                    CLOG_SOFT_ERROR("couldn't read field '%s' encountered '%s' errorCode:%d", field->name, foundName,
-                                    errorCode)
-                    return errorCode;
-                }
-                if (!tc_str_equal(foundName, field->name)) {
-                    CLOG_SOFT_ERROR("field name mismatch. Expected '%s' but got '%s'", field->name, foundName)
-                    return -6;
-                }
-                int subIndentation = indentation;
-                const SwtiType* unaliasedType = swtiUnalias(field->fieldType);
-                if ((unaliasedType->type == SwtiTypeRecord) || (unaliasedType->type == SwtiTypeList) ||
-                    (unaliasedType->type == SwtiTypeBlob)) {
-                    Marker marker;
-                    int skipError = skipWhitespaceAndBreakMarkerEndOfLine(inStream, &marker);
-                    if (skipError < 0) {
-                        CLOG_SOFT_ERROR("this wasn't a end of line")
-                        return skipError;
-                    }
-                    subIndentation++;
-                }
-                int resultCode = swampDumpFromYamlHelper(inStream, subIndentation, dynamicMemory, field->fieldType,
-                                                         target + field->memoryOffsetInfo.memoryOffset,
-                                                         field->memoryOffsetInfo.memoryInfo.memorySize);
-                if (resultCode < 0) {
-                    CLOG_SOFT_ERROR("couldn't read value for field %s' (%d)", field->name, resultCode)
-                    return resultCode;
-                }
+            const SwampBlob* blob;
+            errorCode = readBlob(scanner, frame->indentation, marker, self->dynamicMemory, &blob);
+            if (errorCode < 0) {
+                return errorCode;
             }
-
+            *(const SwampBlob**) target = blob;
             break;
         }
-        case SwtiTypeArray: {
-            const SwtiArrayType* array = (const SwtiArrayType*) tiType;
-            if (expectedSize != 8) {
-                CLOG_ERROR("needs space to story array pointer")
-            }
+        default:
+            CLOG_ERROR("can not deserialize dump from type %d", frame->type->type)
+            return -1;
+            break;
+    }
 
-            uint8_t listLength = 0;
-            const int maxListLength = 256;
-            indentation ++;
-            uint8_t* tempBuffer = tc_malloc(array->memoryInfo.memorySize * maxListLength);
-            while (1) {
-                int didContinue = checkListContinuation(inStream, indentation);
-                if (didContinue < 0) {
-                    return didContinue;
-                }
-                if (!didContinue) {
-                    break;
-                }
-                int errorCode = swampDumpFromYamlHelper(inStream, indentation + 1, dynamicMemory, array->itemType,
-                                                        tempBuffer + listLength * array->memoryInfo.memorySize,
-                                                        array->memoryInfo.memorySize);
-                if (errorCode < 0) {
-                    CLOG_SOFT_ERROR("couldn't read list item %d", listLength);
-                    return errorCode;
-                }
-                listLength++;
-            }
-            indentation --;
-            const SwampArray* newArray = swampArrayAllocate(
-                dynamicMemory, tempBuffer, listLength, array->memoryInfo.memorySize, array->memoryInfo.memoryAlign);
-            tc_free(tempBuffer);
-            *(const SwampArray**) target = newArray;
+    return 0;
+}
+
+static int readEnter(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    YamlReader* self = (YamlReader*) voidSelf;
+
+    switch (frame->type->type) {
+        case SwtiTypeArray: {
+            const SwtiArrayType* array = (const SwtiArrayType*) frame->type;
+            frame->itemSize = array->memoryInfo.memorySize;
+            frame->items = tc_malloc(frame->itemSize * YAML_MAX_LIST_LENGTH);
+            frame->count = YAML_MAX_LIST_LENGTH;
             break;
         }
         case SwtiTypeList: {
-            const SwtiListType* list = (const SwtiListType*) tiType;
-            uint8_t listLength = 0;
-            const int maxListLength = 256;
-
-            uint8_t* tempBuffer = tc_malloc(list->memoryInfo.memorySize * maxListLength);
-            while (1) {
-                int didContinue = checkListContinuation(inStream, indentation);
-                if (didContinue < 0) {
-                    return didContinue;
-                }
-                if (!didContinue) {
-                    break;
-                }
-                int errorCode = swampDumpFromYamlHelper(inStream, indentation + 1, dynamicMemory, list->itemType,
-                                                        tempBuffer + listLength * list->memoryInfo.memorySize,
-                                                        list->memoryInfo.memorySize);
-                if (errorCode < 0) {
-                    CLOG_SOFT_ERROR("couldn't read list item %d", listLength)
-                    return errorCode;
-                }
-                listLength++;
-            }
-
-            const SwampList* newList = swampListAllocate(dynamicMemory, tempBuffer, listLength,
-                                                         list->memoryInfo.memorySize, list->memoryInfo.memoryAlign);
-            tc_free(tempBuffer);
-            *(const SwampList**) target = newList;
+            const SwtiListType* list = (const SwtiListType*) frame->type;
+            frame->itemSize = list->memoryInfo.memorySize;
+            frame->items = tc_malloc(frame->itemSize * YAML_MAX_LIST_LENGTH);
+            frame->count = YAML_MAX_LIST_LENGTH;
             break;
         }
         case SwtiTypeCustom: {
-            const SwtiCustomType* custom = (const SwtiCustomType*) tiType;
-            const char* foundVariantName;
-            int errCode = readTypeIdentifierValue(inStream, &foundVariantName);
-            if (errCode < 0) {
-                return errCode;
-            }
+            const SwtiCustomType* custom = (const SwtiCustomType*) frame->type;
+            YamlSpan foundVariantName;
+            readTypeIdentifierValue(self->scanner, &foundVariantName);
 
             int enumIndex = -1;
             for (size_t i = 0; i < custom->variantCount; ++i) {
                 const SwtiCustomTypeVariant* variant = custom->variantTypes[i];
-                if (tc_str_equal(variant->name, foundVariantName)) {
+                if (spanEqual(foundVariantName, variant->name, tc_strlen(variant->name))) {
                     enumIndex = i;
                     break;
                 }
@@ -536,64 +586,180 @@ static int swampDumpFromYamlHelper(FldTextInStream* inStream, int indentation, S
                 return -4;
             }
 
-            const SwtiCustomTypeVariant* variant = custom->variantTypes[enumIndex];
-            *target = (uint8_t) enumIndex;
-            for (size_t i = 0; i < variant->paramCount; ++i) {
-                const SwtiType* paramType = variant->fields[i].fieldType;
-                SwtiMemoryOffsetInfo offsetInfo = variant->fields[i].memoryOffsetInfo;
-                swampDumpFromYamlHelper(inStream, indentation, dynamicMemory, paramType,
-                                        target + offsetInfo.memoryOffset, offsetInfo.memoryInfo.memorySize);
-            }
-
+            *frame->value = (uint8_t) enumIndex;
+            frame->variant = (uint8_t) enumIndex;
             break;
         }
-        case SwtiTypeAlias: {
-            const SwtiAliasType* alias = (const SwtiAliasType*) tiType;
-            return swampDumpFromYamlHelper(inStream, indentation, dynamicMemory, alias->targetType, target,
-                                           expectedSize);
-        }
-        case SwtiTypeFunction: {
-            CLOG_SOFT_ERROR("functions can not be serialized")
-            return -1;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static int readItem(void* voidSelf, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    YamlReader* self = (YamlReader*) voidSelf;
+    YamlScanner* scanner = self->scanner;
+
+    switch (parent->type->type) {
+        case SwtiTypeRecord: {
+            const SwtiRecordTypeField* field = &((const SwtiRecordType*) parent->type)->fields[parent->index];
+            YamlSpan foundName;
+            int errorCode = readFieldNameColonWithIndentation(scanner, parent->indentation, &foundName);
+            if (errorCode < 0) {
+                CLOG_SOFT_ERROR("couldn't read field '%s' errorCode:%d", field->name, errorCode)
+                return errorCode;
+            }
+            size_t nameLength = parent->descriptor ? parent->descriptor->fields[parent->index].nameLength
+                                                   : tc_strlen(field->name);
+            if (!spanEqual(foundName, field->name, nameLength)) {
+                CLOG_SOFT_ERROR("field name mismatch. Expected '%s' but got '%.*s'", field->name,
+                                (int) foundName.count, foundName.characters)
+                return -6;
+            }
+            const SwtiType* unaliasedType = unaliasedTypeOf(child);
+            if (typeIsBlock(unaliasedType)) {
+                // Blobs read their '>' marker on this line themselves
+                if (unaliasedType->type != SwtiTypeBlob) {
+                    int skipError = skipWhitespaceAndEndOfLine(scanner);
+                    if (skipError < 0) {
+                        CLOG_SOFT_ERROR("this wasn't a end of line")
+                        return skipError;
+                    }
+                }
+                child->indentation++;
+            }
+            checkExpectedSize(unaliasedType, field->memoryOffsetInfo.memoryInfo.memorySize);
+            break;
         }
-        case SwtiTypeResourceName: {
-            CLOG_SOFT_ERROR("resource names can not be serialized")
-            return -1;
+        case SwtiTypeArray:
+        case SwtiTypeList: {
+            int didContinue = checkListContinuation(scanner, parent->indentation);
+            if (didContinue < 0) {
+                CLOG_SOFT_ERROR("couldn't read list item %zu", parent->index)
+                return didContinue;
+            }
+            if (!didContinue) {
+                return SwampDumpWalkDone;
+            }
+            child->indentation = parent->indentation + 1;
+            checkExpectedSize(unaliasedTypeOf(child), parent->itemSize);
+            break;
         }
-        case SwtiTypeBlob: {
-            const SwampBlob* blob;
-            int errorCode = readBlob(inStream, indentation, dynamicMemory, &blob);
+        case SwtiTypeTuple: {
+            int errorCode = requireSequenceItem(scanner, parent->indentation);
             if (errorCode < 0) {
                 return errorCode;
             }
-            *(const SwampBlob**) target = blob;
+            child->indentation = parent->indentation + 1;
+            break;
+        }
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) parent->type;
+            const SwtiCustomTypeVariant* variant = custom->variantTypes[parent->variant];
+            const SwtiCustomTypeVariantField* field = &variant->fields[parent->index];
+            if (!swampDumpYamlVariantIsInline(variant)) {
+                int errorCode = requireSequenceItem(scanner, parent->indentation + 1);
+                if (errorCode < 0) {
+                    return errorCode;
+                }
+                child->indentation = parent->indentation + 2;
+            } else if (typeIsBlock(unaliasedTypeOf(child))) {
+                child->indentation = parent->indentation + 1;
+            }
+            checkExpectedSize(unaliasedTypeOf(child), field->memoryOffsetInfo.memoryInfo.memorySize);
+            break;
+        }
+        default:
+            break;
+    }
+
+    return SwampDumpWalkContinue;
+}
+
+static int readLeave(void* voidSelf, SwampDumpWalkFrame* frame)
+{
+    YamlReader* self = (YamlReader*) voidSelf;
+
+    switch (frame->type->type) {
+        case SwtiTypeArray: {
+            const SwtiArrayType* array = (const SwtiArrayType*) frame->type;
+            const SwampArray* newArray = swampArrayAllocate(self->dynamicMemory, frame->items, frame->count,
+                                                            array->memoryInfo.memorySize,
+                                                            array->memoryInfo.memoryAlign);
+            tc_free(frame->items);
+            frame->items = 0;
+            *(const SwampArray**) frame->value = newArray;
+            break;
+        }
+        case SwtiTypeList: {
+            const SwtiListType* list = (const SwtiListType*) frame->type;
+            const SwampList* newList = swampListAllocate(self->dynamicMemory, frame->items, frame->count,
+                                                         list->memoryInfo.memorySize, list->memoryInfo.memoryAlign);
+            tc_free(frame->items);
+            frame->items = 0;
+            *(const SwampList**) frame->value = newList;
             break;
         }
         default:
-            CLOG_ERROR("can not deserialize dump from type %d", tiType->type)
-            return -1;
             break;
     }
 
     return 0;
 }
 
+static const SwampDumpWalkVisitor yamlReader = {readScalar, readEnter, readItem, readLeave, 0};
+
+static int swampDumpFromYamlHelper(YamlScanner* scanner, SwampDynamicMemory* dynamicMemory,
+                                   const SwtiType* tiType, uint8_t* target)
+{
+    YamlReader reader;
+    reader.scanner = scanner;
+    reader.dynamicMemory = dynamicMemory;
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, SWAMP_DUMP_WALK_INLINE_DEPTH, &yamlReader, &reader);
+
+    checkExpectedSize(swtiUnalias(tiType), swtiGetMemorySize(tiType));
+
+    int errorCode = swampDumpWalk(&walker, tiType, target, 0, 0);
+    if (errorCode < 0) {
+        for (size_t i = 0; i < walker.depth; ++i) {
+            SwampDumpWalkFrame* frame = &walker.frames[i];
+            if ((frame->type->type == SwtiTypeList || frame->type->type == SwtiTypeArray) && frame->items != 0) {
+                tc_free(frame->items);
+            }
+        }
+    }
+    swampDumpWalkerDestroy(&walker);
+
+    return errorCode;
+}
+
 int swampDumpFromYaml(FldInStream* inStream, const SwtiType* tiType, SwampDynamicMemory* dynamicMemory, void* target)
 {
-    FldTextInStream textStream;
-    fldTextInStreamInit(&textStream, inStream);
+    YamlScanner scanner;
+    scannerInit(&scanner, inStream->p, inStream->size - inStream->pos);
 
-    if (*inStream->p == '%') {
-        const char* foundString;
-        readStringUntilEndOfLine(&textStream, &foundString);
-        if (!tc_str_equal("%YAML 1.2", foundString)) {
+    if (scanner.p < scanner.end && *scanner.p == '%') {
+        YamlSpan foundString;
+        readStringUntilEndOfLine(&scanner, &foundString);
+        if (!spanEqual(foundString, "%YAML 1.2", 9)) {
             return -2;
         }
-        readStringUntilEndOfLine(&textStream, &foundString);
-        if (!tc_str_equal("---", foundString)) {
+        readStringUntilEndOfLine(&scanner, &foundString);
+        if (!spanEqual(foundString, "---", 3)) {
             return -2;
         }
     }
 
-    return swampDumpFromYamlHelper(&textStream, 0, dynamicMemory, tiType, target, swtiGetMemorySize(tiType));
+    int errorCode = swampDumpFromYamlHelper(&scanner, dynamicMemory, tiType, target);
+
+    size_t consumed = (size_t) ((const uint8_t*) scanner.p - inStream->p);
+    inStream->p += consumed;
+    inStream->pos += consumed;
+
+    return errorCode;
 }
@@ -0,0 +1,298 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include <clog/clog.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+static int isComposite(const SwtiType* type)
+{
+    switch (type->type) {
+        case SwtiTypeRecord:
+        case SwtiTypeTuple:
+        case SwtiTypeCustom:
+        case SwtiTypeCustomVariant:
+        case SwtiTypeList:
+        case SwtiTypeArray:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/// The frame takes the target type of the alias chain, and its descriptor follows along.
+static void resolveAlias(SwampDumpWalkFrame* frame)
+{
+    frame->alias = 0;
+    while (frame->type->type == SwtiTypeAlias) {
+        if (frame->alias == 0) {
+            frame->alias = frame->type;
+        }
+        if (frame->descriptor != 0) {
+            frame->descriptor = frame->descriptor->fields[0].descriptor;
+        }
+        frame->type = ((const SwtiAliasType*) frame->type)->targetType;
+    }
+}
+
+static void prepareFrame(const SwampDumpWalker* self, SwampDumpWalkFrame* frame)
+{
+    frame->items = 0;
+    frame->itemSize = 0;
+    frame->count = 0;
+    frame->index = 0;
+    frame->variant = 0;
+
+    switch (frame->type->type) {
+        case SwtiTypeRecord:
+            frame->count = ((const SwtiRecordType*) frame->type)->fieldCount;
+            break;
+        case SwtiTypeTuple:
+            frame->count = ((const SwtiTupleType*) frame->type)->fieldCount;
+            break;
+        case SwtiTypeCustomVariant:
+            frame->count = ((const SwtiCustomTypeVariant*) frame->type)->paramCount;
+            break;
+        case SwtiTypeCustom:
+            if (self->visitor->readsValues) {
+                frame->variant = *frame->value;
+            }
+            break;
+        case SwtiTypeList:
+            if (self->visitor->readsValues) {
+                const SwampList* list = *(const SwampList**) frame->value;
+                frame->items = (uint8_t*) list->value;
+                frame->itemSize = list->itemSize;
+                frame->count = list->count;
+            }
+            break;
+        case SwtiTypeArray:
+            if (self->visitor->readsValues) {
+                const SwampArray* array = *(const SwampArray**) frame->value;
+                frame->items = (uint8_t*) array->value;
+                frame->itemSize = array->itemSize;
+                frame->count = array->count;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/// Without a value, only the types are walked and no value address is ever formed.
+static void prepareChild(const SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    size_t i = parent->index;
+    uint8_t* base = parent->value;
+    size_t offset = 0;
+
+    switch (parent->type->type) {
+        case SwtiTypeRecord: {
+            const SwtiRecordTypeField* field = &((const SwtiRecordType*) parent->type)->fields[i];
+            child->type = field->fieldType;
+            offset = field->memoryOffsetInfo.memoryOffset;
+        } break;
+        case SwtiTypeTuple: {
+            const SwtiTupleTypeField* field = &((const SwtiTupleType*) parent->type)->fields[i];
+            child->type = field->fieldType;
+            offset = field->memoryOffsetInfo.memoryOffset;
+        } break;
+        case SwtiTypeCustom: {
+            const SwtiCustomType* custom = (const SwtiCustomType*) parent->type;
+            const SwtiCustomTypeVariantField* field = &custom->variantTypes[parent->variant]->fields[i];
+            child->type = field->fieldType;
+            offset = field->memoryOffsetInfo.memoryOffset;
+        } break;
+        case SwtiTypeCustomVariant: {
+            const SwtiCustomTypeVariantField* field = &((const SwtiCustomTypeVariant*) parent->type)->fields[i];
+            child->type = field->fieldType;
+            offset = field->memoryOffsetInfo.memoryOffset;
+        } break;
+        case SwtiTypeList:
+            child->type = ((const SwtiListType*) parent->type)->itemType;
+            base = parent->items;
+            offset = i * parent->itemSize;
+            break;
+        case SwtiTypeArray:
+            child->type = ((const SwtiArrayType*) parent->type)->itemType;
+            base = parent->items;
+            offset = i * parent->itemSize;
+            break;
+        default:
+            break;
+    }
+
+    child->value = base == 0 ? 0 : base + offset;
+
+    const SwampDumpTypeDescriptor* descriptor = parent->descriptor;
+    if (descriptor == 0) {
+        child->descriptor = 0;
+    } else if (parent->type->type == SwtiTypeCustom) {
+        child->descriptor = descriptor->variants[parent->variant]->fields[i].descriptor;
+    } else if (parent->type->type == SwtiTypeList || parent->type->type == SwtiTypeArray) {
+        child->descriptor = descriptor->fields[0].descriptor;
+    } else {
+        child->descriptor = descriptor->fields[i].descriptor;
+    }
+
+    child->flags = parent->flags;
+    child->indentation = parent->indentation;
+    child->userPointer = parent->userPointer;
+
+    resolveAlias(child);
+}
+
+static int visit(SwampDumpWalker* self, SwampDumpWalkFrame* frame)
+{
+    const SwampDumpWalkVisitor* visitor = self->visitor;
+
+    if (!isComposite(frame->type)) {
+        return visitor->scalar(self->self, frame);
+    }
+
+    prepareFrame(self, frame);
+    if (visitor->enter) {
+        int error = visitor->enter(self->self, frame);
+        if (error < 0) {
+            return error;
+        }
+    }
+
+    if (frame->type->type == SwtiTypeCustom) {
+        const SwtiCustomType* custom = (const SwtiCustomType*) frame->type;
+        if (frame->variant >= custom->variantCount) {
+            CLOG_SOFT_ERROR("swampDumpWalk: illegal variant index %d for '%s'", frame->variant, custom->internal.name)
+            return -2;
+        }
+        frame->count = custom->variantTypes[frame->variant]->paramCount;
+    }
+
+    self->depth++;
+
+    return 0;
+}
+
+void swampDumpWalkerInit(SwampDumpWalker* self, SwampDumpWalkFrame* frames, size_t capacity,
+                         const SwampDumpWalkVisitor* visitor, void* visitorSelf)
+{
+    self->frames = frames;
+    self->capacity = capacity;
+    self->visitor = visitor;
+    self->self = visitorSelf;
+    self->rootUserPointer = 0;
+    self->depth = 0;
+    self->ownsFrames = 0;
+}
+
+void swampDumpWalkerDestroy(SwampDumpWalker* self)
+{
+    if (self->ownsFrames) {
+        tc_free(self->frames);
+    }
+    self->frames = 0;
+    self->capacity = 0;
+    self->ownsFrames = 0;
+}
+
+static int grow(SwampDumpWalker* self)
+{
+    size_t capacity = self->capacity == 0 ? SWAMP_DUMP_WALK_INLINE_DEPTH : self->capacity * 2;
+    SwampDumpWalkFrame* frames = tc_malloc_type_count(SwampDumpWalkFrame, capacity);
+    if (frames == 0) {
+        CLOG_SOFT_ERROR("swampDumpWalk: out of memory for %zu frames", capacity)
+        return -3;
+    }
+
+    if (self->depth > 0) {
+        tc_memcpy_octets(frames, self->frames, self->depth * sizeof(SwampDumpWalkFrame));
+    }
+    if (self->ownsFrames) {
+        tc_free(self->frames);
+    }
+    self->frames = frames;
+    self->capacity = capacity;
+    self->ownsFrames = 1;
+
+    return 0;
+}
+
+/// Walks `value` depth first without recursion. For each composite: enter(), then item() and a visit for every
+/// child, then leave(). The parent's `index` is the child index when item() is called. enter() may start `index`
+/// later and item() may raise it to pass over children, the walk goes on at `index + 1`. On error the walk stops
+/// and `depth` frames are left on the stack, so the caller can release what the visitor acquired in them.
+/// Frame pointers are only valid during a callback, the stack can move to the heap between callbacks.
+/// A visitor that does not read values can walk a zero `value`, then every frame value is zero.
+int swampDumpWalk(SwampDumpWalker* self, const SwtiType* type, void* value, int flags, int indentation)
+{
+    const SwampDumpWalkVisitor* visitor = self->visitor;
+    int error;
+
+    self->depth = 0;
+    if (self->capacity == 0 && (error = grow(self)) < 0) {
+        return error;
+    }
+
+    SwampDumpWalkFrame* root = &self->frames[0];
+    root->type = type;
+    root->value = value;
+    root->descriptor = swampDumpDescriptorFind(type);
+    root->flags = flags;
+    root->indentation = indentation;
+    root->userPointer = self->rootUserPointer;
+    resolveAlias(root);
+
+    if ((error = visit(self, root)) < 0) {
+        return error;
+    }
+
+    while (self->depth > 0) {
+        SwampDumpWalkFrame* top = &self->frames[self->depth - 1];
+        if (top->index >= top->count) {
+            self->depth--;
+            if (visitor->leave) {
+                if ((error = visitor->leave(self->self, top)) < 0) {
+                    return error;
+                }
+            }
+            continue;
+        }
+
+        if (self->depth == self->capacity) {
+            if ((error = grow(self)) < 0) {
+                return error;
+            }
+            top = &self->frames[self->depth - 1];
+        }
+
+        SwampDumpWalkFrame* child = &self->frames[self->depth];
+        prepareChild(top, child);
+
+        int result = SwampDumpWalkContinue;
+        if (visitor->item) {
+            result = visitor->item(self->self, top, child);
+            if (result < 0) {
+                return result;
+            }
+        }
+
+        if (result == SwampDumpWalkDone) {
+            top->count = top->index;
+            continue;
+        }
+
+        top->index++;
+        if (result == SwampDumpWalkSkip) {
+            continue;
+        }
+
+        if ((error = visit(self, child)) < 0) {
+            return error;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/out_stream.h>
+#include <stdlib.h>
+#include <string.h>
+#include <swamp-dump/dump_ascii.h>
+#include <swamp-dump/dump_ascii_no_color.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+/// Copies `colored` without its escape sequences into `plain` and checks that no escape repeats the active color.
+static int stripColors(const char* colored, char* plain, size_t maxCount)
+{
+    int activeColor = SWAMP_DUMP_ASCII_COLOR_UNKNOWN;
+    size_t length = 0;
+    for (const char* p = colored; *p != 0;) {
+        if (*p != '\033') {
+            SWAMP_DUMP_TEST_CHECK(length + 1 < maxCount)
+            plain[length++] = *p++;
+            continue;
+        }
+        SWAMP_DUMP_TEST_CHECK(p[1] == '[')
+        char* end;
+        int color = (int) strtol(p + 2, &end, 10);
+        SWAMP_DUMP_TEST_CHECK(*end == 'm' && color != activeColor)
+        activeColor = color;
+        p = end + 1;
+    }
+    plain[length] = 0;
+
+    return 0;
+}
+
+static int colorElision(const SwampDumpTestFixture* fixture)
+{
+    char colored[2048];
+    char expected[1024];
+    char plain[1024];
+    SWAMP_DUMP_TEST_CHECK(swampDumpToAsciiString(fixture->value, fixture->type, 0, colored, sizeof(colored)) != 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpToAsciiStringNoColor(fixture->value, fixture->type, 0, expected,
+                                                        sizeof(expected)) != 0)
+    if (stripColors(colored, plain, sizeof(plain)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strcmp(plain, expected) == 0)
+
+    // The terminal gets its own colors back
+    size_t length = strlen(colored);
+    SWAMP_DUMP_TEST_CHECK(length > 4 && strcmp(colored + length - 4, "\033[0m") == 0)
+
+    // Brackets that follow each other share one escape
+    SWAMP_DUMP_TEST_CHECK(strstr(colored, "\033[94m[ {") != 0)
+
+    return 0;
+}
+
+static const char* styledText = "{ a: True | name: \"hello\"\n | pos: { x: 10 | y: 120 }\n"
+                                " | ar: [ { x: 11 | y: 121 }\n   | { x: 12 | y: 122 } ]\n"
+                                " | ma: Just 99\n | ti: blob 20 }";
+
+static int styled(const SwampDumpTestFixture* fixture, const SwampDumpAsciiStyle* style, int useColor, char* target,
+                  size_t maxCount)
+{
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, (uint8_t*) target, maxCount - 1);
+    int result = useColor ? swampDumpToAsciiStyled(fixture->value, fixture->type, 0, 0, style, 0, &outStream)
+                          : swampDumpToAsciiStyledNoColor(fixture->value, fixture->type, 0, 0, style, 0, &outStream);
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+    target[outStream.pos] = 0;
+
+    return 0;
+}
+
+static size_t escapeCount(const char* text)
+{
+    size_t count = 0;
+    for (const char* p = strchr(text, '\033'); p != 0; p = strchr(p + 1, '\033')) {
+        count++;
+    }
+
+    return count;
+}
+
+/// Both dumpers take their colors, indentation and punctuation from the same style table.
+static int styles(const SwampDumpTestFixture* fixture)
+{
+    char expected[1024];
+    char text[2048];
+    char plain[1024];
+    SWAMP_DUMP_TEST_CHECK(swampDumpToAsciiStringNoColor(fixture->value, fixture->type, 0, expected,
+                                                        sizeof(expected)) != 0)
+    if (styled(fixture, &swampDumpAsciiStyleDefault, 0, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, expected) == 0)
+
+    SwampDumpAsciiStyle style = swampDumpAsciiStyleDefault;
+    style.colors[SwampDumpAsciiTokenFieldName] = 36;
+    style.indentation = "  ";
+    style.separator = " | ";
+    style.assign = ": ";
+    if (styled(fixture, &style, 0, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, styledText) == 0)
+
+    if (styled(fixture, &style, 1, text, sizeof(text)) < 0 || stripColors(text, plain, sizeof(plain)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strcmp(plain, styledText) == 0)
+    SWAMP_DUMP_TEST_CHECK(strstr(text, "\033[36mname\033[32m: ") != 0)
+
+    // A single color is set once
+    for (size_t i = 0; i < SwampDumpAsciiTokenCount; ++i) {
+        style.colors[i] = 37;
+    }
+    if (styled(fixture, &style, 1, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    const char* start = "\033[37m{ a: True";
+    SWAMP_DUMP_TEST_CHECK(escapeCount(text) == 1 && strncmp(text, start, strlen(start)) == 0)
+
+    return 0;
+}
+
+static int budgeted(const void* value, const SwtiType* type, size_t maxDepth, size_t maxItemCount,
+                    size_t maxPreviewLength, size_t maxOctetCount, char* target, size_t maxCount)
+{
+    SwampDumpAsciiBudget budget = {maxDepth, maxItemCount, maxPreviewLength, maxOctetCount};
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, (uint8_t*) target, maxCount - 1);
+    SWAMP_DUMP_TEST_CHECK(swampDumpToAsciiStyledNoColor(value, type, 0, 0, &swampDumpAsciiStyleDefault, &budget,
+                                                        &outStream) == 0)
+    target[outStream.pos] = 0;
+
+    return 0;
+}
+
+static const char* depthOneText = "{ a = True, name = \"hello\"\n, pos = ...\n, ar = ...\n, ma = Just 99\n"
+                                  ", ti = blob 20 }";
+
+static const char* depthTwoText = "{ a = True, name = \"hello\"\n, pos = { x = 10, y = 120 }\n"
+                                  ", ar = [ ...\n    , ... ]\n, ma = Just 99\n, ti = blob 20 }";
+
+static const char* deepText = "{ f = { f = { f = ... } } }";
+
+static int budgets(const SwampDumpTestFixture* fixture, const SwtiChunk* deepChunk, size_t deepDepth)
+{
+    const void* value = fixture->value;
+    const SwtiType* type = fixture->type;
+    char full[1024];
+    char text[1024];
+    if (budgeted(value, type, 0, 0, 0, 0, full, sizeof(full)) < 0) {
+        return -1;
+    }
+
+    // Custom types do not add a level
+    if (budgeted(value, type, 1, 0, 0, 0, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, depthOneText) == 0)
+    if (budgeted(value, type, 2, 0, 0, 0, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, depthTwoText) == 0)
+
+    if (budgeted(value, type, 0, 1, 0, 0, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strstr(text, "{ x = 11, y = 121 }\n    , ... 1 more ]") != 0)
+    SWAMP_DUMP_TEST_CHECK(strstr(text, "x = 12") == 0)
+    if (budgeted(value, type, 0, 2, 0, 0, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, full) == 0)
+
+    if (budgeted(value, type, 0, 0, 2, 0, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strstr(text, "name = \"he...\"") != 0)
+
+    // Stops at the first token after the budget, with what was written so far intact
+    if (budgeted(value, type, 0, 0, 0, 40, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    size_t length = strlen(text);
+    SWAMP_DUMP_TEST_CHECK(length >= 40 && length < 40 + 8 && strncmp(text, full, length) == 0)
+
+    // Only the levels within the budget are visited, however deep the value is
+    const SwtiType* deepType = deepChunk->types[deepDepth];
+    const char* deepYaml = swampDumpTestDeepYaml(deepDepth, 42);
+    const void* deepValue = swampDumpTestValueFromYaml(deepYaml, deepType, fixture->memory);
+    SWAMP_DUMP_TEST_CHECK(deepValue != 0)
+    if (budgeted(deepValue, deepType, 3, 0, 0, 0, text, sizeof(text)) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, deepText) == 0)
+
+    return 0;
+}
+
+int swampDumpTestAscii(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    if (colorElision(&fixture) < 0) {
+        return -1;
+    }
+
+    if (styles(&fixture) < 0) {
+        return -1;
+    }
+
+    SwtiChunk deepChunk;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestDeepTypes(&deepChunk, SWAMP_DUMP_TEST_MAX_DEEP_DEPTH, SwtiTypeInt) == 0)
+    int result = budgets(&fixture, &deepChunk, SWAMP_DUMP_TEST_MAX_DEEP_DEPTH);
+    swtiChunkDestroy(&deepChunk);
+
+    return result;
+}
@@ -0,0 +1,24 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <swamp-dump/hash.h>
+#include <swamp-typeinfo/chunk.h>
+
+/// swamp_dump_codegen --bake made this from the Cool fixture YAML, see CMakeLists.txt.
+extern const void* const swampTestBakedCool;
+
+/// The baked constant must be the very value that the YAML reader makes at run time.
+int swampDumpTestBake(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(fixture.value, swampTestBakedCool, fixture.type))
+    SWAMP_DUMP_TEST_CHECK(swampDumpHash(fixture.value, fixture.type) == swampDumpHash(swampTestBakedCool, fixture.type))
+
+    return 0;
+}
@@ -0,0 +1,194 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "types.h"
+
+#include <clog/clog.h>
+#include <clog/console.h>
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/entropy.h>
+#include <swamp-dump/query.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <time.h>
+
+clog_config g_clog;
+
+#define BENCHMARK_ITEM_COUNT (200)
+#define BENCHMARK_ROUND_COUNT (2000)
+
+/// Every round decodes into the same memory, so the rounds measure decoding and not running out of memory.
+static uint8_t decodeMemoryOctets[64 * 1024];
+
+static double megabytesPerSecond(size_t octetCount, clock_t start)
+{
+    double seconds = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    return seconds <= 0 ? 0 : (double) octetCount * BENCHMARK_ROUND_COUNT / (seconds * 1024 * 1024);
+}
+
+/// A Cool value whose `ar` holds BENCHMARK_ITEM_COUNT positions that move a little from one item to the next.
+static const void* slowlyMovingCool(const SwtiType* type, SwampDynamicMemory* memory)
+{
+    static char yaml[BENCHMARK_ITEM_COUNT * 32 + 128];
+    size_t length = (size_t) snprintf(yaml, sizeof(yaml), "%%YAML 1.2\n---\na: true\nname: hello\npos:\n  x: 10\n"
+                                                          "  y: 120\nar:\n");
+    for (size_t i = 0; i < BENCHMARK_ITEM_COUNT; ++i) {
+        length += (size_t) snprintf(yaml + length, sizeof(yaml) - length, "  - x: %zu\n    y: %zu\n", i, 100 + i / 4);
+    }
+    snprintf(yaml + length, sizeof(yaml) - length, "ma: Just 99\nti: >\n  1234567890abcdefghij\n");
+
+    return swampDumpTestValueFromYaml(yaml, type, memory);
+}
+
+/// Prints the ratio of the entropy coded dump against the plain one, and how fast both are written and read.
+static int benchmarkEntropy(const SwtiType* type, const void* value)
+{
+    static uint8_t plainOctets[BENCHMARK_ITEM_COUNT * 16 + 256];
+    static uint8_t entropyOctets[BENCHMARK_ITEM_COUNT * 16 + 256];
+    FldOutStream plainStream;
+    FldOutStream entropyStream;
+    SwampDynamicMemory memory;
+    FldInStream inStream;
+
+    clock_t start = clock();
+    for (size_t round = 0; round < BENCHMARK_ROUND_COUNT; ++round) {
+        fldOutStreamInit(&plainStream, plainOctets, sizeof(plainOctets));
+        if (swampDumpToOctets(&plainStream, value, type) < 0) {
+            return -1;
+        }
+    }
+    double plainWrite = megabytesPerSecond(plainStream.pos, start);
+
+    start = clock();
+    for (size_t round = 0; round < BENCHMARK_ROUND_COUNT; ++round) {
+        fldOutStreamInit(&entropyStream, entropyOctets, sizeof(entropyOctets));
+        if (swampDumpToOctetsEntropy(&entropyStream, value, type) < 0) {
+            return -1;
+        }
+    }
+    double entropyWrite = megabytesPerSecond(plainStream.pos, start);
+
+    start = clock();
+    for (size_t round = 0; round < BENCHMARK_ROUND_COUNT; ++round) {
+        swampDynamicMemoryInit(&memory, decodeMemoryOctets, sizeof(decodeMemoryOctets));
+        void* decoded = swampDynamicMemoryAlloc(&memory, 1, swtiGetMemorySize(type));
+        fldInStreamInit(&inStream, plainOctets, plainStream.pos);
+        if (swampDumpFromOctets(&inStream, type, 0, 0, decoded, &memory, 0) < 0) {
+            return -1;
+        }
+    }
+    double plainRead = megabytesPerSecond(plainStream.pos, start);
+
+    start = clock();
+    for (size_t round = 0; round < BENCHMARK_ROUND_COUNT; ++round) {
+        swampDynamicMemoryInit(&memory, decodeMemoryOctets, sizeof(decodeMemoryOctets));
+        void* decoded = swampDynamicMemoryAlloc(&memory, 1, swtiGetMemorySize(type));
+        fldInStreamInit(&inStream, entropyOctets, entropyStream.pos);
+        if (swampDumpFromOctetsEntropy(&inStream, type, decoded, &memory) < 0) {
+            return -1;
+        }
+    }
+    double entropyRead = megabytesPerSecond(plainStream.pos, start);
+
+    printf("entropy: %zu plain octets, %zu entropy coded (%.1f%%)\n", plainStream.pos, entropyStream.pos,
+           100.0 * (double) entropyStream.pos / (double) plainStream.pos);
+    printf("entropy: write %.1f MB/s (plain %.1f MB/s), read %.1f MB/s (plain %.1f MB/s)\n", entropyWrite,
+           plainWrite, entropyRead, plainRead);
+
+    return 0;
+}
+
+static double microsecondsPerRound(clock_t start)
+{
+    return (double) (clock() - start) * 1000000.0 / CLOCKS_PER_SEC / BENCHMARK_ROUND_COUNT;
+}
+
+/// Prints how long it takes to read the last field of a value with a query, against decoding all of it.
+static int benchmarkQuery(const SwtiType* type, const void* value, const char* descriptorsText)
+{
+    static uint8_t octets[BENCHMARK_ITEM_COUNT * 16 + 256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    if (swampDumpToOctets(&outStream, value, type) < 0) {
+        return -1;
+    }
+
+    SwampDumpQuery query;
+    if (swampDumpQueryCompile(&query, type, "ti") < 0) {
+        return -1;
+    }
+
+    SwampDumpQueryResult result;
+    clock_t start = clock();
+    for (size_t round = 0; round < BENCHMARK_ROUND_COUNT; ++round) {
+        if (swampDumpQueryOctets(&query, octets, outStream.pos, &result) < 0) {
+            return -1;
+        }
+    }
+    double queryTime = microsecondsPerRound(start);
+
+    SwampDynamicMemory memory;
+    FldInStream inStream;
+    start = clock();
+    for (size_t round = 0; round < BENCHMARK_ROUND_COUNT; ++round) {
+        swampDynamicMemoryInit(&memory, decodeMemoryOctets, sizeof(decodeMemoryOctets));
+        void* decoded = swampDynamicMemoryAlloc(&memory, 1, swtiGetMemorySize(type));
+        fldInStreamInit(&inStream, octets, outStream.pos);
+        if (swampDumpFromOctets(&inStream, type, 0, 0, decoded, &memory, 0) < 0) {
+            return -1;
+        }
+    }
+    double decodeTime = microsecondsPerRound(start);
+
+    printf("query: 'ti' of %zu octets %s in %.3f us, a full decode takes %.3f us\n", outStream.pos, descriptorsText,
+           queryTime, decodeTime);
+
+    return 0;
+}
+
+/// Not a test: prints numbers for the encoders to compare between changes. Build it with optimizations on.
+int main()
+{
+    g_clog.log = clog_console;
+
+    SwtiChunk chunk;
+    if (swampDumpTestTypes(&chunk) < 0) {
+        return 1;
+    }
+
+    SwampDumpTestFixture fixture;
+    int result = swampDumpTestFixtureInit(&fixture, &chunk);
+    const void* moving = result < 0 ? 0 : slowlyMovingCool(fixture.type, fixture.memory);
+    if (moving == 0) {
+        result = -1;
+    }
+    if (result == 0) {
+        result = benchmarkEntropy(fixture.type, moving);
+    }
+    if (result == 0) {
+        result = benchmarkQuery(fixture.type, fixture.value, "without descriptors");
+    }
+    if (result == 0) {
+        result = benchmarkQuery(fixture.type, moving, "without descriptors");
+    }
+
+    SwampDumpDescriptorCache descriptors;
+    if (result == 0 && (result = swampDumpDescriptorCacheInit(&descriptors, &chunk)) == 0) {
+        swampDumpDescriptorCachePublish(&descriptors);
+        result = benchmarkQuery(fixture.type, fixture.value, "with descriptors");
+        if (result == 0) {
+            result = benchmarkQuery(fixture.type, moving, "with descriptors");
+        }
+        swampDumpDescriptorCacheUnpublish(&descriptors);
+        swampDumpDescriptorCacheDestroy(&descriptors);
+    }
+    swtiChunkDestroy(&chunk);
+
+    return result < 0 ? 1 : 0;
+}
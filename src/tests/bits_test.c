@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/quantize.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+static const char* outOfRangeCoolYaml = "%YAML 1.2\n---\na: false\nname: hello\npos:\n  x: 300\n  y: -4\nar:\n"
+                                        "  - x: 11\n    y: 121\nma: Not\nti: >\n  1234567890abcdefghij\n";
+
+static const char* clampedCoolYaml = "%YAML 1.2\n---\na: false\nname: hello\npos:\n  x: 255\n  y: 0\nar:\n"
+                                     "  - x: 11\n    y: 121\nma: Not\nti: >\n  1234567890abcdefghij\n";
+
+static int roundTrip(const void* value, const SwtiType* type, const SwampDumpQuantization* quantization,
+                     const void* expected, SwampDynamicMemory* memory)
+{
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToBits(&outStream, value, type, quantization) == 0)
+
+    uint8_t plainOctets[256];
+    FldOutStream plainStream;
+    fldOutStreamInit(&plainStream, plainOctets, sizeof(plainOctets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&plainStream, value, type) == 0)
+    SWAMP_DUMP_TEST_CHECK(outStream.pos < plainStream.pos)
+
+    void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromBits(&inStream, type, quantization, decoded, memory) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(expected, decoded, type))
+
+    return 0;
+}
+
+int swampDumpTestBits(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* outOfRange = swampDumpTestValueFromYaml(outOfRangeCoolYaml, fixture.type, fixture.memory);
+    const void* clamped = swampDumpTestValueFromYaml(clampedCoolYaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(outOfRange != 0 && clamped != 0)
+
+    const SwtiType* position = chunk->types[SWAMP_DUMP_TEST_TYPE_POSITION];
+    const SwampDumpQuantizedField fields[] = {
+        {position, "x", 0, 255, 1},
+        {position, "y", 0, 1023, 1},
+    };
+    SwampDumpQuantization quantization;
+    SWAMP_DUMP_TEST_CHECK(swampDumpQuantizationInit(&quantization, fields, sizeof(fields) / sizeof(fields[0])) == 0)
+    SWAMP_DUMP_TEST_CHECK(quantization.entries[0].bitCount == 8 && quantization.entries[1].bitCount == 10)
+
+    int result = roundTrip(fixture.value, fixture.type, &quantization, fixture.value, fixture.memory);
+    if (result == 0) {
+        result = roundTrip(outOfRange, fixture.type, &quantization, clamped, fixture.memory);
+    }
+    swampDumpQuantizationDestroy(&quantization);
+
+    return result;
+}
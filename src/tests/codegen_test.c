@@ -0,0 +1,83 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "swamp_test_generated.h"
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+/// The serializers that swamp_dump_codegen generated from the test types must be interchangeable with the library.
+int swampDumpTestCodegen(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    uint8_t generated[256];
+    uint8_t library[256];
+    FldOutStream generatedStream;
+    FldOutStream libraryStream;
+    fldOutStreamInit(&generatedStream, generated, sizeof(generated));
+    fldOutStreamInit(&libraryStream, library, sizeof(library));
+    SWAMP_DUMP_TEST_CHECK(swampTestCoolToOctets(&generatedStream, fixture.value) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&libraryStream, fixture.value, fixture.type) == 0)
+    SWAMP_DUMP_TEST_CHECK(generatedStream.pos == libraryStream.pos)
+    SWAMP_DUMP_TEST_CHECK(memcmp(generated, library, libraryStream.pos) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampTestCoolOctetCount(fixture.value) == (int) generatedStream.pos)
+
+    void* decoded = swampDynamicMemoryAlloc(fixture.memory, 1, swtiGetMemorySize(fixture.type));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, generated, generatedStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctets(&inStream, fixture.type, 0, 0, decoded, fixture.memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(fixture.value, decoded, fixture.type))
+
+    decoded = swampDynamicMemoryAlloc(fixture.memory, 1, swtiGetMemorySize(fixture.type));
+    fldInStreamInit(&inStream, library, libraryStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampTestCoolFromOctets(&inStream, 0, 0, decoded, fixture.memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(inStream.pos == libraryStream.pos)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(fixture.value, decoded, fixture.type))
+
+    // The generated decoder must reject every truncation without reading past the end. Each prefix gets an
+    // allocation of its own, so an address sanitizer can see an overread.
+    for (size_t count = 0; count < libraryStream.pos; ++count) {
+        uint8_t* prefix = tc_malloc(count);
+        tc_memcpy_octets(prefix, library, count);
+        fldInStreamInit(&inStream, prefix, count);
+        int result = swampTestCoolFromOctets(&inStream, 0, 0, decoded, fixture.memory, 0);
+        tc_free(prefix);
+        SWAMP_DUMP_TEST_CHECK(result < 0)
+        SWAMP_DUMP_TEST_CHECK(inStream.pos <= count)
+    }
+
+    // The generated encoder must fail, not truncate, when the stream is too small
+    for (size_t count = 0; count < libraryStream.pos; ++count) {
+        fldOutStreamInit(&generatedStream, generated, count);
+        SWAMP_DUMP_TEST_CHECK(swampTestCoolToOctets(&generatedStream, fixture.value) < 0)
+    }
+
+    // A variant index that the custom type does not have
+    const SwtiRecordType* record = (const SwtiRecordType*) swtiUnalias(fixture.type);
+    size_t maybeOffset = 0;
+    for (size_t i = 0; i < record->fieldCount; ++i) {
+        if (tc_str_equal(record->fields[i].name, "ma")) {
+            maybeOffset = record->fields[i].memoryOffsetInfo.memoryOffset;
+        }
+    }
+    uint8_t* broken = swampDynamicMemoryAlloc(fixture.memory, 1, swtiGetMemorySize(fixture.type));
+    tc_memcpy_octets(broken, fixture.value, swtiGetMemorySize(fixture.type));
+    broken[maybeOffset] = 7;
+    SWAMP_DUMP_TEST_CHECK(swampTestCoolOctetCount(broken) < 0)
+    fldOutStreamInit(&generatedStream, generated, sizeof(generated));
+    SWAMP_DUMP_TEST_CHECK(swampTestCoolToOctets(&generatedStream, broken) < 0)
+
+    return 0;
+}
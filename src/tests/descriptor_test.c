@@ -0,0 +1,120 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/descriptor.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+static int dumpOctets(const void* value, const SwtiType* type, uint8_t* octets, size_t octetCount, size_t* written)
+{
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, octetCount);
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, value, type) == 0)
+    *written = outStream.pos;
+
+    return 0;
+}
+
+/// The published descriptors must give the same octets and values as deriving everything on each call.
+static int dumpWithDescriptors(const SwampDumpTestFixture* fixture, const uint8_t* expectedOctets,
+                               size_t expectedOctetCount)
+{
+    uint8_t octets[256];
+    size_t octetCount;
+    if (dumpOctets(fixture->value, fixture->type, octets, sizeof(octets), &octetCount) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(octetCount == expectedOctetCount)
+    SWAMP_DUMP_TEST_CHECK(memcmp(octets, expectedOctets, octetCount) == 0)
+
+    void* decoded = swampDynamicMemoryAlloc(fixture->memory, 1, swtiGetMemorySize(fixture->type));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, octetCount);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctets(&inStream, fixture->type, 0, 0, decoded, fixture->memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(fixture->value, decoded, fixture->type))
+
+    return 0;
+}
+
+static int publishBoth(const SwampDumpTestFixture* fixture, const SwtiChunk* chunk,
+                       SwampDumpDescriptorCache* descriptors, SwampDumpDescriptorCache* otherDescriptors,
+                       const SwtiChunk* otherChunk)
+{
+    const SwtiType* position = chunk->types[SWAMP_DUMP_TEST_TYPE_POSITION];
+    const SwtiType* otherPosition = otherChunk->types[SWAMP_DUMP_TEST_TYPE_POSITION];
+
+    uint8_t octets[256];
+    size_t octetCount;
+    if (dumpOctets(fixture->value, fixture->type, octets, sizeof(octets), &octetCount) < 0) {
+        return -1;
+    }
+
+    SWAMP_DUMP_TEST_CHECK(swampDumpDescriptorFind(fixture->type) == 0)
+    swampDumpDescriptorCachePublish(descriptors);
+    swampDumpDescriptorCachePublish(otherDescriptors);
+    // Publishing twice must not link the cache in twice
+    swampDumpDescriptorCachePublish(descriptors);
+
+    const SwampDumpTypeDescriptor* found = swampDumpDescriptorFind(fixture->type);
+    SWAMP_DUMP_TEST_CHECK(found != 0 && found == swampDumpDescriptorCacheFind(descriptors, fixture->type))
+    SWAMP_DUMP_TEST_CHECK(found->type == fixture->type && !found->isSimple && !found->hasFixedOctetCount)
+    SWAMP_DUMP_TEST_CHECK(swampDumpDescriptorFind(otherPosition) == swampDumpDescriptorCacheFind(otherDescriptors,
+                                                                                                  otherPosition))
+
+    const SwampDumpTypeDescriptor* positionDescriptor = swampDumpDescriptorFind(position);
+    SWAMP_DUMP_TEST_CHECK(positionDescriptor != 0 && positionDescriptor->fieldCount == 2)
+    SWAMP_DUMP_TEST_CHECK(positionDescriptor->hasFixedOctetCount && positionDescriptor->fixedOctetCount == 4 + 4)
+    SWAMP_DUMP_TEST_CHECK(swampDumpDescriptorFind(chunk->types[SWAMP_DUMP_TEST_TYPE_INT])->isSimple)
+
+    if (dumpWithDescriptors(fixture, octets, octetCount) < 0) {
+        return -1;
+    }
+
+    // The other cache stays published when the first one is taken out
+    swampDumpDescriptorCacheUnpublish(descriptors);
+    SWAMP_DUMP_TEST_CHECK(swampDumpDescriptorFind(fixture->type) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpDescriptorFind(otherPosition) != 0)
+    if (dumpWithDescriptors(fixture, octets, octetCount) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int swampDumpTestDescriptor(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    SwtiChunk otherChunk;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestTypes(&otherChunk) == 0)
+
+    SwampDumpDescriptorCache descriptors;
+    SwampDumpDescriptorCache otherDescriptors;
+    int result = swampDumpDescriptorCacheInit(&descriptors, chunk);
+    if (result == 0) {
+        result = swampDumpDescriptorCacheInit(&otherDescriptors, &otherChunk);
+        if (result == 0) {
+            result = publishBoth(&fixture, chunk, &descriptors, &otherDescriptors, &otherChunk);
+            swampDumpDescriptorCacheUnpublish(&descriptors);
+            swampDumpDescriptorCacheUnpublish(&otherDescriptors);
+            swampDumpDescriptorCacheDestroy(&otherDescriptors);
+        }
+        swampDumpDescriptorCacheDestroy(&descriptors);
+    }
+    swtiChunkDestroy(&otherChunk);
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpDescriptorFind(fixture.type) == 0)
+
+    return 0;
+}
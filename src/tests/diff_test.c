@@ -0,0 +1,94 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/diff.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+static const char* longerCoolYaml = "%YAML 1.2\n---\na: true\nname: hello\npos:\n  x: 10\n  y: 120\nar:\n  - x: 11\n"
+                                    "    y: 121\n  - x: 12\n    y: 122\n  - x: 13\n    y: 123\nma: Just 99\nti: >\n"
+                                    "  1234567890abcdefghij\n";
+
+static const char* shorterCoolYaml = "%YAML 1.2\n---\na: true\nname: hello\npos:\n  x: 10\n  y: 120\nar:\n  - x: 11\n"
+                                     "    y: 5\nma: Not\nti: >\n  1234567890abcdefghij\n";
+
+static const char* addedText = "Cool.ar: 2 -> 3 items\nCool.ar[2]: + { x = 13, y = 123 }\n";
+
+static const char* removedText = "Cool.ar: 2 -> 1 items\nCool.ar[0].y: 121 -> 5\nCool.ar[1]: - { x = 12, y = 122 }\n"
+                                 "Cool.ma: Just 99 -> Not\n";
+
+static int diff(const void* a, const void* b, const SwtiType* type, int useColor, char* target, size_t maxCount,
+                int* differenceCount)
+{
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, (uint8_t*) target, maxCount - 1);
+    *differenceCount = useColor ? swampDumpDiffToAscii(a, b, type, 0, 0, &outStream)
+                                : swampDumpDiffToAsciiNoColor(a, b, type, 0, 0, &outStream);
+    target[outStream.pos] = 0;
+    SWAMP_DUMP_TEST_CHECK(*differenceCount >= 0)
+
+    return 0;
+}
+
+static int expectDiff(const void* a, const void* b, const SwtiType* type, const char* expected,
+                      int expectedDifferenceCount)
+{
+    char text[1024];
+    int differenceCount;
+    if (diff(a, b, type, 0, text, sizeof(text), &differenceCount) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(differenceCount == expectedDifferenceCount)
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, expected) == 0)
+
+    // The colored diff has the same text and gives the terminal its colors back at the end
+    char colored[2048];
+    if (diff(a, b, type, 1, colored, sizeof(colored), &differenceCount) < 0) {
+        return -1;
+    }
+    size_t length = 0;
+    for (const char* p = colored; *p != 0; ++p) {
+        if (*p == '\033') {
+            p = strchr(p, 'm');
+            SWAMP_DUMP_TEST_CHECK(p != 0)
+            continue;
+        }
+        text[length++] = *p;
+    }
+    text[length] = 0;
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, expected) == 0)
+    size_t coloredLength = strlen(colored);
+    SWAMP_DUMP_TEST_CHECK(coloredLength > 4 && strcmp(colored + coloredLength - 4, "\033[0m") == 0)
+
+    return 0;
+}
+
+int swampDumpTestDiff(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* longer = swampDumpTestValueFromYaml(longerCoolYaml, fixture.type, fixture.memory);
+    const void* shorter = swampDumpTestValueFromYaml(shorterCoolYaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(longer != 0 && shorter != 0)
+
+    if (expectDiff(fixture.value, longer, fixture.type, addedText, 2) < 0 ||
+        expectDiff(fixture.value, shorter, fixture.type, removedText, 4) < 0) {
+        return -1;
+    }
+
+    // Nothing differs, so not even a color reset is written
+    char colored[64];
+    int differenceCount;
+    if (diff(fixture.value, fixture.value, fixture.type, 1, colored, sizeof(colored), &differenceCount) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(differenceCount == 0 && colored[0] == 0)
+
+    return 0;
+}
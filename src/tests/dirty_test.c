@@ -0,0 +1,103 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/dirty.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+static const char* changedCoolYaml = "%YAML 1.2\n---\na: true\nname: world\npos:\n  x: 10\n  y: 7\nar:\n  - x: 11\n"
+                                     "    y: 121\n  - x: 12\n    y: 122\nma: Not\nti: >\n  1234567890abcdefghij\n";
+
+static const char* movedCoolYaml = "%YAML 1.2\n---\na: true\nname: world\npos:\n  x: 5\n  y: 7\nar:\n  - x: 11\n"
+                                   "    y: 121\n  - x: 12\n    y: 122\nma: Not\nti: >\n  1234567890abcdefghij\n";
+
+/// Only `pos.x` has changed. Counts the calls in `context`.
+static size_t onlyPositionX(void* context, const SwtiRecordType* recordType, const void* record, size_t fieldIndex,
+                            SwampDumpFieldChange* change)
+{
+    (void) record;
+
+    (*(size_t*) context)++;
+    for (size_t i = fieldIndex; i < recordType->fieldCount; ++i) {
+        const char* name = recordType->fields[i].name;
+        if (strcmp(name, "pos") == 0 || strcmp(name, "x") == 0) {
+            *change = name[0] == 'p' ? SwampDumpFieldDescend : SwampDumpFieldChanged;
+            return i;
+        }
+    }
+
+    return recordType->fieldCount;
+}
+
+static int merge(const uint8_t* octets, size_t octetCount, const SwtiType* type, void* target,
+                 SwampDynamicMemory* memory)
+{
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, octetCount);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctetsDirtyMerge(&inStream, type, 0, 0, target, memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(inStream.pos == octetCount)
+
+    return 0;
+}
+
+int swampDumpTestDirty(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* changed = swampDumpTestValueFromYaml(changedCoolYaml, fixture.type, fixture.memory);
+    const void* moved = swampDumpTestValueFromYaml(movedCoolYaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(changed != 0 && moved != 0)
+
+    // The receiver holds a copy of the first value
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, fixture.value, fixture.type) == 0)
+    void* target = swampDynamicMemoryAlloc(fixture.memory, 1, swtiGetMemorySize(fixture.type));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctets(&inStream, fixture.type, 0, 0, target, fixture.memory, 0) == 0)
+
+    // name, pos and ma
+    const uint8_t dirtyMask[] = {0x16};
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctetsDirtyMask(&outStream, changed, fixture.type, dirtyMask) == 0)
+    if (merge(octets, outStream.pos, fixture.type, target, fixture.memory) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(changed, target, fixture.type))
+
+    // Header, the masks of Cool and Position and the x coordinate
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    size_t callCount = 0;
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctetsDirty(&outStream, moved, fixture.type, onlyPositionX, &callCount) == 0)
+    SWAMP_DUMP_TEST_CHECK(outStream.pos == 3 + 1 + 1 + 4)
+    // One call for each of the two changed fields, and one for each of the two records to find nothing more
+    SWAMP_DUMP_TEST_CHECK(callCount == 2 + 2)
+    if (merge(octets, outStream.pos, fixture.type, target, fixture.memory) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(moved, target, fixture.type))
+
+    // Nothing changed, nothing is merged
+    const uint8_t cleanMask[] = {0};
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctetsDirtyMask(&outStream, fixture.value, fixture.type, cleanMask) == 0)
+    SWAMP_DUMP_TEST_CHECK(outStream.pos == 3 + 1)
+    if (merge(octets, outStream.pos, fixture.type, target, fixture.memory) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(moved, target, fixture.type))
+
+    return 0;
+}
@@ -0,0 +1,49 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/dump_ascii_no_color.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+int swampDumpTestOctets(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, fixture.value, fixture.type) == 0)
+
+    void* decoded = swampDynamicMemoryAlloc(fixture.memory, 1, swtiGetMemorySize(fixture.type));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctets(&inStream, fixture.type, 0, 0, decoded, fixture.memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(inStream.pos == outStream.pos)
+
+    uint8_t again[256];
+    FldOutStream againStream;
+    fldOutStreamInit(&againStream, again, sizeof(again));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&againStream, decoded, fixture.type) == 0)
+    SWAMP_DUMP_TEST_CHECK(againStream.pos == outStream.pos)
+    SWAMP_DUMP_TEST_CHECK(memcmp(again, octets, outStream.pos) == 0)
+
+    fldInStreamInit(&inStream, octets + 3, outStream.pos - 3);
+    SWAMP_DUMP_TEST_CHECK(swampDumpSkipOctetsRaw(&inStream, fixture.type) == 0)
+    SWAMP_DUMP_TEST_CHECK(inStream.pos == outStream.pos - 3)
+
+    char text[1024];
+    const char* ascii = swampDumpToAsciiStringNoColor(decoded, fixture.type, 0, text, sizeof(text));
+    SWAMP_DUMP_TEST_CHECK(ascii != 0 && strstr(ascii, "Just 99") != 0)
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/entropy.h>
+#include <swamp-dump/hash.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+static int compareAsOctets(const void* a, const SwtiType* aType, const void* b, const SwtiType* bType)
+{
+    uint8_t aOctets[256];
+    uint8_t bOctets[256];
+    FldOutStream aStream;
+    FldOutStream bStream;
+    fldOutStreamInit(&aStream, aOctets, sizeof(aOctets));
+    fldOutStreamInit(&bStream, bOctets, sizeof(bOctets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&aStream, a, aType) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&bStream, b, bType) == 0)
+    SWAMP_DUMP_TEST_CHECK(aStream.pos == bStream.pos)
+    SWAMP_DUMP_TEST_CHECK(memcmp(aOctets, bOctets, aStream.pos) == 0)
+
+    return 0;
+}
+
+/// A dump is decoded, and encoded again, with types that are deserialized again, as a reader in another process
+/// would. No context may depend on where the types happen to live.
+static int decodeWithOtherTypes(const uint8_t* octets, size_t octetCount, const void* value, const SwtiType* type,
+                                const SwtiChunk* otherChunk, SwampDynamicMemory* memory)
+{
+    const SwtiType* otherType = otherChunk->types[SWAMP_DUMP_TEST_TYPE_COOL];
+    SWAMP_DUMP_TEST_CHECK(otherType != type)
+
+    void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(otherType));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, octetCount);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctetsEntropy(&inStream, otherType, decoded, memory) == 0)
+    if (compareAsOctets(value, type, decoded, otherType) < 0) {
+        return -1;
+    }
+
+    uint8_t otherOctets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, otherOctets, sizeof(otherOctets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctetsEntropy(&outStream, decoded, otherType) == 0)
+    SWAMP_DUMP_TEST_CHECK(outStream.pos == octetCount)
+    SWAMP_DUMP_TEST_CHECK(memcmp(otherOctets, octets, octetCount) == 0)
+
+    return 0;
+}
+
+int swampDumpTestEntropy(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctetsEntropy(&outStream, fixture.value, fixture.type) == 0)
+
+    void* decoded = swampDynamicMemoryAlloc(fixture.memory, 1, swtiGetMemorySize(fixture.type));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctetsEntropy(&inStream, fixture.type, decoded, fixture.memory) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(fixture.value, decoded, fixture.type))
+
+    // Allocations of different sizes in between move the deserialized types to other addresses each time
+    for (size_t i = 0; i < 16; ++i) {
+        void* padding = tc_malloc(16 + i * 40);
+        SwtiChunk otherChunk;
+        SWAMP_DUMP_TEST_CHECK(swampDumpTestTypes(&otherChunk) == 0)
+        int result = decodeWithOtherTypes(octets, outStream.pos, fixture.value, fixture.type, &otherChunk,
+                                          fixture.memory);
+        swtiChunkDestroy(&otherChunk);
+        tc_free(padding);
+        if (result < 0) {
+            return result;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <swamp-dump/format.h>
+#include <swamp-typeinfo/chunk.h>
+
+/// Lengths around the 16 and 32 octet steps of the vector paths, so every path and every tail is taken.
+static const size_t vectorEdgeCounts[] = {0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65};
+
+static int printableReference(const uint8_t* octets, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        if (octets[i] < 32 || octets[i] > 126) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int hexPairs(void)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    uint8_t octets[1 + 65 + 1];
+    char pairs[2 * sizeof(octets) + 1];
+    char expected[sizeof(pairs)];
+
+    for (size_t c = 0; c < sizeof(vectorEdgeCounts) / sizeof(vectorEdgeCounts[0]); ++c) {
+        size_t count = vectorEdgeCounts[c];
+        // Starts one octet in, so the loads are not aligned either
+        for (size_t i = 0; i < count; ++i) {
+            octets[1 + i] = (uint8_t) (i * 37 + count * 11 + 0x9a);
+            expected[i * 2] = hex[octets[1 + i] >> 4];
+            expected[i * 2 + 1] = hex[octets[1 + i] & 0xf];
+        }
+        memset(pairs, '#', sizeof(pairs));
+        swampDumpFormatHexPairs(pairs, octets + 1, count);
+        SWAMP_DUMP_TEST_CHECK(memcmp(pairs, expected, count * 2) == 0 && pairs[count * 2] == '#')
+
+        uint8_t parsed[sizeof(octets)];
+        SWAMP_DUMP_TEST_CHECK(swampDumpParseHexPairs(pairs, count * 2, parsed) == (int) count)
+        SWAMP_DUMP_TEST_CHECK(count == 0 || memcmp(parsed, octets + 1, count) == 0)
+    }
+
+    return 0;
+}
+
+static int printable(void)
+{
+    // Just outside and just inside the printable range, and octets that are negative as signed
+    static const uint8_t edges[] = {0, 31, 32, 126, 127, 128, 200, 255};
+    uint8_t octets[1 + 65 + 1];
+
+    for (size_t c = 0; c < sizeof(vectorEdgeCounts) / sizeof(vectorEdgeCounts[0]); ++c) {
+        size_t count = vectorEdgeCounts[c];
+        memset(octets, 'a', sizeof(octets));
+        SWAMP_DUMP_TEST_CHECK(swampDumpOctetsArePrintable(octets + 1, count) == 1)
+
+        for (size_t position = 0; position < count; ++position) {
+            for (size_t e = 0; e < sizeof(edges); ++e) {
+                octets[1 + position] = edges[e];
+                int result = swampDumpOctetsArePrintable(octets + 1, count);
+                SWAMP_DUMP_TEST_CHECK(result == printableReference(octets + 1, count))
+            }
+            octets[1 + position] = 'a';
+        }
+
+        // Outside of the range that is checked
+        octets[0] = 0;
+        octets[1 + count] = 0;
+        SWAMP_DUMP_TEST_CHECK(swampDumpOctetsArePrintable(octets + 1, count) == 1)
+    }
+
+    return 0;
+}
+
+typedef struct FormatCase {
+    int32_t value;
+    const char* text;
+} FormatCase;
+
+static const FormatCase intCases[] = {
+    {0, "0"}, {9, "9"}, {10, "10"}, {-1, "-1"}, {99, "99"}, {100, "100"}, {-1000000, "-1000000"},
+    {INT32_MAX, "2147483647"}, {INT32_MIN, "-2147483648"},
+};
+
+static const FormatCase fixedCases[] = {
+    {0, "0.000"}, {1, "0.001"}, {-1, "-0.001"}, {-999, "-0.999"}, {1000, "1.000"}, {-12500, "-12.500"},
+    {INT32_MAX, "2147483.647"}, {INT32_MIN, "-2147483.648"},
+};
+
+/// Parses `text` and expects `expected` back, or the error `expected` when it is negative.
+static int parseCase(int (*parse)(const char*, size_t, int32_t*), const char* text, int expectedResult,
+                     int32_t expected)
+{
+    int32_t value = 0x5a5a5a5a;
+    int result = parse(text, strlen(text), &value);
+    if (result != expectedResult || (result == 0 && value != expected)) {
+        fprintf(stderr, "parsing '%s' gave %d and %d, expected %d and %d\n", text, result, value, expectedResult,
+                expected);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int formatCases(size_t (*format)(char*, int32_t), int (*parse)(const char*, size_t, int32_t*),
+                       const FormatCase* cases, size_t caseCount)
+{
+    for (size_t i = 0; i < caseCount; ++i) {
+        char text[SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT + 1];
+        memset(text, '#', sizeof(text));
+        size_t length = format(text, cases[i].value);
+        SWAMP_DUMP_TEST_CHECK(length == strlen(cases[i].text) && length <= SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT)
+        SWAMP_DUMP_TEST_CHECK(memcmp(text, cases[i].text, length) == 0 && text[length] == '#')
+        if (parseCase(parse, cases[i].text, 0, cases[i].value) < 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static int boundaries(void)
+{
+    char text[SWAMP_DUMP_FORMAT_MAX_OCTET_COUNT];
+    SWAMP_DUMP_TEST_CHECK(swampDumpFormatUInt32(text, UINT32_MAX) == 10 && memcmp(text, "4294967295", 10) == 0)
+
+    size_t intCaseCount = sizeof(intCases) / sizeof(intCases[0]);
+    size_t fixedCaseCount = sizeof(fixedCases) / sizeof(fixedCases[0]);
+    if (formatCases(swampDumpFormatInt32, swampDumpParseInt32, intCases, intCaseCount) < 0 ||
+        formatCases(swampDumpFormatFixed32, swampDumpParseFixed32, fixedCases, fixedCaseCount) < 0) {
+        return -1;
+    }
+
+    // One past each end does not fit, malformed text is told apart from that
+    if (parseCase(swampDumpParseInt32, "2147483648", -2, 0) < 0 ||
+        parseCase(swampDumpParseInt32, "-2147483649", -2, 0) < 0 ||
+        parseCase(swampDumpParseInt32, "99999999999999999999", -2, 0) < 0 ||
+        parseCase(swampDumpParseInt32, "+7  ", 0, 7) < 0 || parseCase(swampDumpParseInt32, "", -1, 0) < 0 ||
+        parseCase(swampDumpParseInt32, "-", -1, 0) < 0 || parseCase(swampDumpParseInt32, "12a", -1, 0) < 0 ||
+        parseCase(swampDumpParseInt32, "1.5", -1, 0) < 0) {
+        return -1;
+    }
+
+    if (parseCase(swampDumpParseFixed32, "2147483.648", -2, 0) < 0 ||
+        parseCase(swampDumpParseFixed32, "-2147483.649", -2, 0) < 0 ||
+        parseCase(swampDumpParseFixed32, "2147484", -2, 0) < 0 ||
+        parseCase(swampDumpParseFixed32, "-2147483.6480", 0, INT32_MIN) < 0 ||
+        parseCase(swampDumpParseFixed32, "-2147483.6481", -1, 0) < 0 ||
+        parseCase(swampDumpParseFixed32, "12", 0, 12000) < 0 ||
+        parseCase(swampDumpParseFixed32, "-12.5", 0, -12500) < 0 ||
+        parseCase(swampDumpParseFixed32, "0.125 ", 0, 125) < 0 || parseCase(swampDumpParseFixed32, ".5", -1, 0) < 0 ||
+        parseCase(swampDumpParseFixed32, "1.2.3", -1, 0) < 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int swampDumpTestFormat(const SwtiChunk* chunk)
+{
+    (void) chunk;
+
+    if (boundaries() < 0 || hexPairs() < 0) {
+        return -1;
+    }
+
+    return printable();
+}
@@ -0,0 +1,49 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+static const char* renamedCoolYaml = "%YAML 1.2\n---\na: true\nname: world\npos:\n  x: 10\n  y: 120\nar:\n  - x: 11\n"
+                                     "    y: 121\n  - x: 12\n    y: 122\nma: Just 99\nti: >\n  1234567890abcdefghij\n";
+
+int swampDumpTestHash(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* renamed = swampDumpTestValueFromYaml(renamedCoolYaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(renamed != 0)
+
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, fixture.value, fixture.type) == 0)
+
+    // Padding and unused variant memory of the copy are garbage, which neither the hash nor equality may see
+    size_t memorySize = swtiGetMemorySize(fixture.type);
+    void* decoded = swampDynamicMemoryAlloc(fixture.memory, 1, memorySize);
+    memset(decoded, 0xaa, memorySize);
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctets(&inStream, fixture.type, 0, 0, decoded, fixture.memory, 0) == 0)
+
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(fixture.value, decoded, fixture.type))
+    SWAMP_DUMP_TEST_CHECK(swampDumpHash(fixture.value, fixture.type) == swampDumpHash(decoded, fixture.type))
+    uint64_t hash = swampDumpHash(fixture.value, fixture.type);
+    SWAMP_DUMP_TEST_CHECK(hash == swampDumpHashOctets(octets + 3, outStream.pos - 3))
+
+    SWAMP_DUMP_TEST_CHECK(!swampDumpEqual(fixture.value, renamed, fixture.type))
+    SWAMP_DUMP_TEST_CHECK(swampDumpHash(fixture.value, fixture.type) != swampDumpHash(renamed, fixture.type))
+
+    return 0;
+}
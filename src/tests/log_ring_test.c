@@ -0,0 +1,124 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/out_stream.h>
+#include <stdio.h>
+#include <string.h>
+#include <swamp-dump/log_ring.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+#define LOG_RING_TEST_POSITION_COUNT (8)
+
+/// An entry header and an encoded Position take 24 octets, so the ring holds three of them and a gap.
+#define LOG_RING_TEST_CAPACITY (80)
+
+static int expectEntry(SwampDumpLogRing* ring, SwampDynamicMemory* memory, int32_t x)
+{
+    char text[128];
+    char expected[32];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, (uint8_t*) text, sizeof(text) - 1);
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingRenderNoColor(ring, memory, &outStream) == 1)
+    text[outStream.pos] = 0;
+    snprintf(expected, sizeof(expected), "{ x = %d, y = %d }", x, 100 + x);
+    SWAMP_DUMP_TEST_CHECK(strcmp(text, expected) == 0)
+
+    return 0;
+}
+
+static int expectEmpty(SwampDumpLogRing* ring)
+{
+    SwampDumpLogEntry entry;
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPeek(ring, &entry) == 0)
+
+    return 0;
+}
+
+static int expectCounts(const SwampDumpLogRing* ring, size_t pushedCount, size_t droppedCount)
+{
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPushedCount(ring) == pushedCount)
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingDroppedCount(ring) == droppedCount)
+
+    return 0;
+}
+
+/// Fills the ring, drops what does not fit, wraps around to the start and reads the entries back in order.
+static int wrap(const SwtiType* position, const void* const* positions, const void* cool, const SwtiType* coolType,
+                SwampDynamicMemory* memory)
+{
+    uint64_t ringOctets[LOG_RING_TEST_CAPACITY / sizeof(uint64_t)];
+    SwampDumpLogRing ring;
+    swampDumpLogRingInit(&ring, (uint8_t*) ringOctets, sizeof(ringOctets));
+    if (expectEmpty(&ring) < 0) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+        SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPush(&ring, positions[i], position, 0) == 0)
+    }
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPush(&ring, positions[3], position, 0) < 0)
+    // Never fits, however empty the ring is
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPush(&ring, cool, coolType, 0) < 0)
+    if (expectCounts(&ring, 3, 2) < 0 || expectEntry(&ring, memory, 0) < 0) {
+        return -1;
+    }
+
+    // Only 16 octets before the tail, the wrap has to wait for the next release
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPush(&ring, positions[3], position, 0) < 0)
+    if (expectEntry(&ring, memory, 1) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPush(&ring, positions[3], position, 0) == 0)
+    // Between the new head and the tail there is no room left
+    SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPush(&ring, positions[4], position, 0) < 0)
+    if (expectCounts(&ring, 4, 4) < 0) {
+        return -1;
+    }
+
+    if (expectEntry(&ring, memory, 2) < 0 || expectEntry(&ring, memory, 3) < 0 || expectEmpty(&ring) < 0) {
+        return -1;
+    }
+
+    // Two in and two out each lap, so the records start at another offset every time the ring wraps
+    size_t pushedCount = 0;
+    size_t readCount = 0;
+    for (size_t lap = 0; lap < 40; ++lap) {
+        for (size_t i = 0; i < 2; ++i, ++pushedCount) {
+            const void* value = positions[pushedCount % LOG_RING_TEST_POSITION_COUNT];
+            SWAMP_DUMP_TEST_CHECK(swampDumpLogRingPush(&ring, value, position, 0) == 0)
+        }
+        for (size_t i = 0; i < 2; ++i, ++readCount) {
+            if (expectEntry(&ring, memory, (int32_t) (readCount % LOG_RING_TEST_POSITION_COUNT)) < 0) {
+                return -1;
+            }
+        }
+    }
+    if (expectCounts(&ring, 4 + pushedCount, 4) < 0) {
+        return -1;
+    }
+
+    return expectEmpty(&ring);
+}
+
+int swampDumpTestLogRing(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    const SwtiType* position = chunk->types[SWAMP_DUMP_TEST_TYPE_POSITION];
+    const void* positions[LOG_RING_TEST_POSITION_COUNT];
+    for (size_t i = 0; i < LOG_RING_TEST_POSITION_COUNT; ++i) {
+        char yaml[64];
+        snprintf(yaml, sizeof(yaml), "%%YAML 1.2\n---\nx: %d\ny: %d\n", (int) i, 100 + (int) i);
+        positions[i] = swampDumpTestValueFromYaml(yaml, position, fixture.memory);
+        SWAMP_DUMP_TEST_CHECK(positions[i] != 0)
+    }
+
+    return wrap(position, positions, fixture.value, fixture.type, fixture.memory);
+}
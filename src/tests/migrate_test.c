@@ -0,0 +1,188 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/migrate.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/deserialize.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+/// A later version of Cool: `a` and `ar` are removed, `count` and `pos.z` are added, the fields are in another order
+/// and the variants of Maybe are swapped.
+static const uint8_t readerTypeOctets[] = {
+    0, // Major
+    1, // Minor
+    3, // Patch
+    0x07, // Types that follow
+    SwtiTypeInt,
+    SwtiTypeAlias,
+    0x4,
+    'C',
+    'o',
+    'o',
+    'l',
+    2,
+    SwtiTypeRecord,
+    5,
+    5,
+    'c',
+    'o',
+    'u',
+    'n',
+    't',
+    0,
+    2,
+    't',
+    'i',
+    5,
+    3,
+    'p',
+    'o',
+    's',
+    3,
+    4,
+    'n',
+    'a',
+    'm',
+    'e',
+    4,
+    2,
+    'm',
+    'a',
+    6,
+    SwtiTypeRecord,
+    3,
+    1,
+    'y',
+    0,
+    1,
+    'x',
+    0,
+    1,
+    'z',
+    0,
+    SwtiTypeString,
+    SwtiTypeBlob,
+    SwtiTypeCustom,
+    5,
+    'M',
+    'a',
+    'y',
+    'b',
+    'e',
+    2,
+    4,
+    'J',
+    'u',
+    's',
+    't',
+    1,
+    0,
+    3,
+    'N',
+    'o',
+    't',
+    0,
+};
+
+#define READER_TYPE_COOL (1)
+
+static const char* readerCoolYaml = "%YAML 1.2\n---\ncount: 0\nti: >\n  1234567890abcdefghij\npos:\n  y: 120\n  x: 10\n"
+                                    "  z: 0\nname: hello\nma: Just 99\n";
+
+static int migrate(const void* value, const SwtiType* writerType, const SwtiType* readerType,
+                   SwampDynamicMemory* memory)
+{
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctetsWithSchema(&outStream, value, writerType) == 0)
+
+    // The writer type itself needs no plan
+    void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(writerType));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctetsWithSchema(&inStream, writerType, 0, 0, 0, 0, decoded, memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(value, decoded, writerType))
+
+    void* migrated = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(readerType));
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctetsWithSchema(&inStream, readerType, 0, 0, 0, 0, migrated, memory, 0) < 0)
+
+    SwampDumpMigrationPlan plan;
+    SWAMP_DUMP_TEST_CHECK(swampDumpMigrationPlanInit(&plan, writerType, readerType) == 0)
+    const SwampDumpMigrationPlan* plans[] = {&plan};
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    int result = swampDumpFromOctetsWithSchema(&inStream, readerType, plans, 1, 0, 0, migrated, memory, 0);
+    swampDumpMigrationPlanDestroy(&plan);
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+    SWAMP_DUMP_TEST_CHECK(inStream.pos == outStream.pos)
+
+    const void* expected = swampDumpTestValueFromYaml(readerCoolYaml, readerType, memory);
+    SWAMP_DUMP_TEST_CHECK(expected != 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(expected, migrated, readerType))
+
+    return 0;
+}
+
+#define DEEP_RECORD_DEPTH (20)
+
+/// Types that only differ far down must neither share a fingerprint nor be read as each other.
+static int deepDifference(SwampDynamicMemory* memory)
+{
+    SwtiChunk intChunk;
+    SwtiChunk boolChunk;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestDeepTypes(&intChunk, DEEP_RECORD_DEPTH, SwtiTypeInt) == 0)
+    if (swampDumpTestDeepTypes(&boolChunk, DEEP_RECORD_DEPTH, SwtiTypeBoolean) < 0) {
+        swtiChunkDestroy(&intChunk);
+        return -1;
+    }
+    const SwtiType* intType = intChunk.types[DEEP_RECORD_DEPTH];
+    const SwtiType* boolType = boolChunk.types[DEEP_RECORD_DEPTH];
+
+    uint8_t octets[64];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    void* value = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(intType));
+    tc_mem_clear(value, swtiGetMemorySize(intType));
+    int result = swampDumpToOctetsWithSchema(&outStream, value, intType);
+
+    void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(boolType));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    int decodeResult = swampDumpFromOctetsWithSchema(&inStream, boolType, 0, 0, 0, 0, decoded, memory, 0);
+    int differs = swampDumpTypeFingerprint(intType) != swampDumpTypeFingerprint(boolType);
+
+    swtiChunkDestroy(&boolChunk);
+    swtiChunkDestroy(&intChunk);
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+    SWAMP_DUMP_TEST_CHECK(differs)
+    SWAMP_DUMP_TEST_CHECK(decodeResult < 0)
+
+    return 0;
+}
+
+int swampDumpTestMigrate(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    SwtiChunk readerChunk;
+    SWAMP_DUMP_TEST_CHECK(swtiDeserialize(readerTypeOctets, sizeof(readerTypeOctets), &readerChunk) == 0)
+    int result = migrate(fixture.value, fixture.type, readerChunk.types[READER_TYPE_COOL], fixture.memory);
+    swtiChunkDestroy(&readerChunk);
+    if (result < 0) {
+        return result;
+    }
+
+    return deepDifference(fixture.memory);
+}
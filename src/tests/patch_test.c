@@ -0,0 +1,101 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/query.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+static const char* patchedCoolYaml = "%YAML 1.2\n---\na: false\nname: hello\npos:\n  x: -77\n  y: 120\nar:\n"
+                                     "  - x: 11\n    y: 121\n  - x: 12\n    y: 122\nma: Just 99\nti: >\n"
+                                     "  1234567890abcdefghij\n";
+
+static const char* longerCoolYaml = "%YAML 1.2\n---\na: false\nname: hello\npos:\n  x: -77\n  y: 120\nar:\n"
+                                    "  - x: 1\n    y: 2\n  - x: 3\n    y: 4\n  - x: 5\n    y: 6\nma: Just 99\nti: >\n"
+                                    "  1234567890abcdefghij\n";
+
+static int encode(const void* value, const SwtiType* type, uint8_t* octets, size_t capacity, size_t* octetCount)
+{
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, capacity);
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, value, type) == 0)
+    *octetCount = outStream.pos;
+
+    return 0;
+}
+
+static int decodesTo(const uint8_t* octets, size_t octetCount, const void* expected, const SwtiType* type,
+                     SwampDynamicMemory* memory)
+{
+    void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, octetCount);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctets(&inStream, type, 0, 0, decoded, memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(inStream.pos == octetCount)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(expected, decoded, type))
+
+    return 0;
+}
+
+static int patch(const SwtiType* type, const char* path, uint8_t* octets, size_t octetCount, int32_t value)
+{
+    SwampDumpQuery query;
+    SWAMP_DUMP_TEST_CHECK(swampDumpQueryCompile(&query, type, path) == 0)
+
+    return swampDumpPatchOctets(&query, octets, octetCount, value);
+}
+
+int swampDumpTestPatch(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* patched = swampDumpTestValueFromYaml(patchedCoolYaml, fixture.type, fixture.memory);
+    const void* longer = swampDumpTestValueFromYaml(longerCoolYaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(patched != 0 && longer != 0)
+
+    uint8_t octets[256];
+    size_t octetCount;
+    if (encode(fixture.value, fixture.type, octets, sizeof(octets), &octetCount) < 0) {
+        return -1;
+    }
+
+    SWAMP_DUMP_TEST_CHECK(patch(fixture.type, "a", octets, octetCount, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(patch(fixture.type, "pos.x", octets, octetCount, -77) == 0)
+    if (decodesTo(octets, octetCount, patched, fixture.type, fixture.memory) < 0) {
+        return -1;
+    }
+
+    // Not and Just do not have the same parameters, and a string has no fixed size
+    SWAMP_DUMP_TEST_CHECK(patch(fixture.type, "ma", octets, octetCount, 0) < 0)
+    SWAMP_DUMP_TEST_CHECK(patch(fixture.type, "name", octets, octetCount, 0) < 0)
+
+    // The list is replaced with the longer list of another value
+    uint8_t longerOctets[256];
+    size_t longerOctetCount;
+    if (encode(longer, fixture.type, longerOctets, sizeof(longerOctets), &longerOctetCount) < 0) {
+        return -1;
+    }
+    SwampDumpQuery query;
+    SwampDumpQueryResult replacement;
+    SWAMP_DUMP_TEST_CHECK(swampDumpQueryCompile(&query, fixture.type, "ar") == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpQueryOctets(&query, longerOctets, longerOctetCount, &replacement) == 0)
+
+    size_t splicedOctetCount;
+    SWAMP_DUMP_TEST_CHECK(swampDumpSpliceOctets(&query, octets, octetCount, octetCount, replacement.octets,
+                                                replacement.octetCount, &splicedOctetCount) < 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpSpliceOctets(&query, octets, octetCount, sizeof(octets), replacement.octets,
+                                                replacement.octetCount, &splicedOctetCount) == 0)
+    SWAMP_DUMP_TEST_CHECK(splicedOctetCount == longerOctetCount)
+    SWAMP_DUMP_TEST_CHECK(memcmp(octets, longerOctets, longerOctetCount) == 0)
+
+    return decodesTo(octets, splicedOctetCount, longer, fixture.type, fixture.memory);
+}
@@ -0,0 +1,108 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/projection.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+#include <tiny-libc/tiny_libc.h>
+
+static const char* otherCoolYaml = "%YAML 1.2\n---\na: false\nname: world\npos:\n  x: 10\n  y: 7\nar:\n  - x: 11\n"
+                                   "    y: 121\n  - x: 12\n    y: 122\nma: Just 5\nti: >\n  1234567890abcdefghij\n";
+
+/// The fixture, with `pos.y` and `ma` taken from the other value.
+static const char* mergedCoolYaml = "%YAML 1.2\n---\na: true\nname: hello\npos:\n  x: 10\n  y: 7\nar:\n  - x: 11\n"
+                                    "    y: 121\n  - x: 12\n    y: 122\nma: Just 5\nti: >\n  1234567890abcdefghij\n";
+
+static const uint8_t* fieldOf(const void* value, const SwtiType* type, const char* name)
+{
+    const SwtiRecordType* record = (const SwtiRecordType*) swtiUnalias(type);
+    for (size_t i = 0; i < record->fieldCount; ++i) {
+        if (tc_str_equal(record->fields[i].name, name)) {
+            return (const uint8_t*) value + record->fields[i].memoryOffsetInfo.memoryOffset;
+        }
+    }
+
+    return 0;
+}
+
+static int project(const SwtiType* type, const char* const* paths, size_t pathCount, const uint8_t* octets,
+                   size_t octetCount, SwampDumpProjectionFill fill, void* target, SwampDynamicMemory* memory)
+{
+    SwampDumpProjection projection;
+    SWAMP_DUMP_TEST_CHECK(swampDumpProjectionInit(&projection, type, paths, pathCount) == 0)
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, octetCount);
+    int result = swampDumpFromOctetsProjected(&inStream, &projection, fill, 0, 0, target, memory, 0);
+    swampDumpProjectionDestroy(&projection);
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+    SWAMP_DUMP_TEST_CHECK(inStream.pos == octetCount)
+
+    return 0;
+}
+
+int swampDumpTestProjection(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* other = swampDumpTestValueFromYaml(otherCoolYaml, fixture.type, fixture.memory);
+    const void* merged = swampDumpTestValueFromYaml(mergedCoolYaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(other != 0 && merged != 0)
+
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, other, fixture.type) == 0)
+    size_t octetCount = outStream.pos;
+
+    // Only the selected parts of the other value are written over a copy of the fixture
+    size_t memorySize = swtiGetMemorySize(fixture.type);
+    void* target = swampDynamicMemoryAlloc(fixture.memory, 1, memorySize);
+    tc_memcpy_octets(target, fixture.value, memorySize);
+    const char* const paths[] = {"pos.y", "ma.Just.0"};
+    if (project(fixture.type, paths, 2, octets, octetCount, SwampDumpProjectionFillUntouched, target,
+                fixture.memory) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(merged, target, fixture.type))
+
+    // Everything else is zero, and strings, blobs and lists are empty instead of null
+    target = swampDynamicMemoryAlloc(fixture.memory, 1, memorySize);
+    if (project(fixture.type, paths, 2, octets, octetCount, SwampDumpProjectionFillZero, target, fixture.memory) <
+        0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(*(const SwampBool*) fieldOf(target, fixture.type, "a") == 0)
+    const SwampString* name = *(const SwampString**) fieldOf(target, fixture.type, "name");
+    SWAMP_DUMP_TEST_CHECK(name != 0 && name->characterCount == 0)
+    const SwampList* ar = *(const SwampList**) fieldOf(target, fixture.type, "ar");
+    SWAMP_DUMP_TEST_CHECK(ar != 0 && ar->count == 0)
+    const SwampBlob* ti = *(const SwampBlob**) fieldOf(target, fixture.type, "ti");
+    SWAMP_DUMP_TEST_CHECK(ti != 0 && ti->octetCount == 0)
+    const SwtiType* position = chunk->types[SWAMP_DUMP_TEST_TYPE_POSITION];
+    const uint8_t* pos = fieldOf(target, fixture.type, "pos");
+    SWAMP_DUMP_TEST_CHECK(*(const SwampInt32*) fieldOf(pos, position, "x") == 0)
+    SWAMP_DUMP_TEST_CHECK(*(const SwampInt32*) fieldOf(pos, position, "y") == 7)
+    const SwtiCustomType* maybe = (const SwtiCustomType*) chunk->types[SWAMP_DUMP_TEST_TYPE_MAYBE];
+    const uint8_t* ma = fieldOf(target, fixture.type, "ma");
+    size_t justOffset = maybe->variantTypes[1]->fields[0].memoryOffsetInfo.memoryOffset;
+    SWAMP_DUMP_TEST_CHECK(ma[0] == 1 && *(const SwampInt32*) (ma + justOffset) == 5)
+
+    // Variants and parameters that the custom type does not have
+    SwampDumpProjection projection;
+    const char* const unknownVariant[] = {"ma.Maybe.0"};
+    const char* const unknownParameter[] = {"ma.Just.1"};
+    SWAMP_DUMP_TEST_CHECK(swampDumpProjectionInit(&projection, fixture.type, unknownVariant, 1) < 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpProjectionInit(&projection, fixture.type, unknownParameter, 1) < 0)
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/query.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+static int query(const SwtiType* type, const char* path, const uint8_t* octets, size_t octetCount,
+                 SwampDumpQueryResult* result)
+{
+    SwampDumpQuery compiled;
+    if (swampDumpQueryCompile(&compiled, type, path) < 0) {
+        fprintf(stderr, "could not compile query '%s'\n", path);
+        return -1;
+    }
+
+    return swampDumpQueryOctets(&compiled, octets, octetCount, result);
+}
+
+static int queryInt(const SwtiType* type, const char* path, const uint8_t* octets, size_t octetCount,
+                    int32_t expected)
+{
+    SwampDumpQueryResult result;
+    SWAMP_DUMP_TEST_CHECK(query(type, path, octets, octetCount, &result) == 0)
+    SWAMP_DUMP_TEST_CHECK(result.value == expected)
+
+    return 0;
+}
+
+static const char* secondPositionYaml = "%YAML 1.2\n---\nx: 12\ny: 122\n";
+
+/// Reads the items of `ar` straight out of the octets, in any order and range.
+static int strideList(const SwtiChunk* chunk, const uint8_t* octets, size_t octetCount, SwampDynamicMemory* memory)
+{
+    const SwtiType* listType = chunk->types[SWAMP_DUMP_TEST_TYPE_POSITION_LIST];
+    const SwtiType* position = chunk->types[SWAMP_DUMP_TEST_TYPE_POSITION];
+    const void* second = swampDumpTestValueFromYaml(secondPositionYaml, position, memory);
+    SWAMP_DUMP_TEST_CHECK(second != 0)
+
+    SwampDumpQueryResult result;
+    SWAMP_DUMP_TEST_CHECK(query(chunk->types[SWAMP_DUMP_TEST_TYPE_COOL], "ar", octets, octetCount, &result) == 0)
+
+    SwampDumpFixedStrideList list;
+    SWAMP_DUMP_TEST_CHECK(swampDumpFixedStrideListInit(&list, listType, result.octets, result.octetCount) == 0)
+    SWAMP_DUMP_TEST_CHECK(list.count == 2 && list.stride == 4 + 4)
+    const uint8_t* item = swampDumpFixedStrideListItem(&list, 1);
+    SWAMP_DUMP_TEST_CHECK(item == result.octets + 1 + 8 && item[3] == 12 && item[7] == 122)
+    SWAMP_DUMP_TEST_CHECK(swampDumpFixedStrideListItem(&list, 2) == 0)
+
+    size_t itemSize = swtiGetMemorySize(position);
+    uint8_t* items = swampDynamicMemoryAlloc(memory, 2, itemSize);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFixedStrideListDecode(&list, 1, 1, items) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(second, items, position))
+    SWAMP_DUMP_TEST_CHECK(swampDumpFixedStrideListDecode(&list, 0, 2, items) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(second, items + itemSize, position))
+    SWAMP_DUMP_TEST_CHECK(swampDumpFixedStrideListDecode(&list, 2, 0, items) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpFixedStrideListDecode(&list, 1, 2, items) < 0)
+
+    // The count promises more items than there are octets, and a record is no list
+    SWAMP_DUMP_TEST_CHECK(swampDumpFixedStrideListInit(&list, listType, result.octets, result.octetCount - 1) < 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpFixedStrideListInit(&list, position, result.octets, result.octetCount) < 0)
+
+    return 0;
+}
+
+int swampDumpTestQuery(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const SwtiType* type = fixture.type;
+
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, fixture.value, type) == 0)
+    size_t octetCount = outStream.pos;
+
+    if (queryInt(type, "a", octets, octetCount, 1) < 0 || queryInt(type, "pos.y", octets, octetCount, 120) < 0 ||
+        queryInt(type, "ar[1].x", octets, octetCount, 12) < 0 || queryInt(type, "ma", octets, octetCount, 1) < 0 ||
+        queryInt(type, "ma.Just.0", octets, octetCount, 99) < 0) {
+        return -1;
+    }
+
+    SwampDumpQueryResult result;
+    SWAMP_DUMP_TEST_CHECK(query(type, "name", octets, octetCount, &result) == 0)
+    SWAMP_DUMP_TEST_CHECK(result.octetCount == 1 + 6 && memcmp(result.octets + 1, "hello", 6) == 0)
+
+    // Paths that the value does not have
+    SWAMP_DUMP_TEST_CHECK(query(type, "ar[2].x", octets, octetCount, &result) == 1)
+    SWAMP_DUMP_TEST_CHECK(query(type, "ma.Not", octets, octetCount, &result) == 1)
+
+    // Paths that the type does not have
+    SwampDumpQuery compiled;
+    SWAMP_DUMP_TEST_CHECK(swampDumpQueryCompile(&compiled, type, "pos.z") < 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpQueryCompile(&compiled, type, "ma.Just.1") < 0)
+
+    // ti is the last field, so it is cut off by every truncation
+    SWAMP_DUMP_TEST_CHECK(swampDumpQueryCompile(&compiled, type, "ti") == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpQueryOctets(&compiled, octets, octetCount, &result) == 0)
+    SWAMP_DUMP_TEST_CHECK(result.octets + result.octetCount == octets + octetCount)
+    for (size_t count = 0; count < octetCount; ++count) {
+        SWAMP_DUMP_TEST_CHECK(swampDumpQueryOctets(&compiled, octets, count, &result) < 0)
+    }
+
+    return strideList(chunk, octets, octetCount, fixture.memory);
+}
@@ -0,0 +1,115 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/out_stream.h>
+#include <stdio.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/replay.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+#define REPLAY_TEST_TICK_COUNT (10)
+#define REPLAY_TEST_KEYFRAME_INTERVAL (4)
+#define REPLAY_TEST_MAX_STATE (256)
+
+/// Cool values where only `pos.x`, and every third tick `name`, changes.
+static int recordedValues(const void** values, const SwtiType* type, SwampDynamicMemory* memory)
+{
+    for (size_t tick = 0; tick < REPLAY_TEST_TICK_COUNT; ++tick) {
+        char yaml[256];
+        snprintf(yaml, sizeof(yaml),
+                 "%%YAML 1.2\n---\na: false\nname: %s\npos:\n  x: %zu\n  y: 120\nar:\n  - x: 11\n    y: 121\n"
+                 "ma: Not\nti: >\n  1234567890abcdefghij\n",
+                 (tick / 3) % 2 ? "world" : "hello", tick * 10);
+        values[tick] = swampDumpTestValueFromYaml(yaml, type, memory);
+        SWAMP_DUMP_TEST_CHECK(values[tick] != 0)
+    }
+
+    return 0;
+}
+
+static int record(FldOutStream* outStream, const void** values, const SwtiType* type, int finish)
+{
+    SwampDumpReplayRecorder recorder;
+    SWAMP_DUMP_TEST_CHECK(swampDumpReplayRecorderInit(&recorder, outStream, type, REPLAY_TEST_KEYFRAME_INTERVAL,
+                                                      REPLAY_TEST_MAX_STATE) == 0)
+    int result = 0;
+    for (size_t tick = 0; tick < REPLAY_TEST_TICK_COUNT && result == 0; ++tick) {
+        result = swampDumpReplayRecorderAdd(&recorder, values[tick]);
+    }
+    if (result == 0 && finish) {
+        result = swampDumpReplayRecorderFinish(&recorder);
+    }
+    size_t keyframeCount = recorder.keyframeCount;
+    swampDumpReplayRecorderDestroy(&recorder);
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+    SWAMP_DUMP_TEST_CHECK(keyframeCount == (REPLAY_TEST_TICK_COUNT + REPLAY_TEST_KEYFRAME_INTERVAL - 1) /
+                                               REPLAY_TEST_KEYFRAME_INTERVAL)
+
+    return 0;
+}
+
+/// Seeks forward within a keyframe run, across keyframes and backwards, and past the end.
+static int play(const uint8_t* octets, size_t octetCount, const void** values, const SwtiType* type,
+                SwampDynamicMemory* memory)
+{
+    static const size_t ticks[] = {0, 1, 2, 3, 9, 5, 6, 4, 8, 7, 0};
+
+    SwampDumpReplayPlayer player;
+    SWAMP_DUMP_TEST_CHECK(swampDumpReplayPlayerInit(&player, octets, octetCount, type, REPLAY_TEST_MAX_STATE) == 0)
+    SWAMP_DUMP_TEST_CHECK(player.entryCount == REPLAY_TEST_TICK_COUNT)
+    SWAMP_DUMP_TEST_CHECK(player.keyframeCount == 3)
+
+    int result = 0;
+    for (size_t i = 0; i < sizeof(ticks) / sizeof(ticks[0]) && result == 0; ++i) {
+        void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+        result = swampDumpReplayPlayerSeek(&player, ticks[i], 0, 0, decoded, memory, 0);
+        if (result == 0 && !swampDumpEqual(values[ticks[i]], decoded, type)) {
+            fprintf(stderr, "replay: tick %zu differs\n", ticks[i]);
+            result = -1;
+        }
+    }
+    if (result == 0) {
+        void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+        result = swampDumpReplayPlayerSeek(&player, REPLAY_TEST_TICK_COUNT, 0, 0, decoded, memory, 0) < 0 ? 0 : -1;
+    }
+    swampDumpReplayPlayerDestroy(&player);
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+
+    return 0;
+}
+
+int swampDumpTestReplay(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* values[REPLAY_TEST_TICK_COUNT];
+    if (recordedValues(values, fixture.type, fixture.memory) < 0) {
+        return -1;
+    }
+
+    uint8_t octets[2048];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    if (record(&outStream, values, fixture.type, 1) < 0) {
+        return -1;
+    }
+    size_t finishedOctetCount = outStream.pos;
+    if (play(octets, finishedOctetCount, values, fixture.type, fixture.memory) < 0) {
+        return -1;
+    }
+
+    // Without the seek table the player has to find the keyframes itself
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    if (record(&outStream, values, fixture.type, 0) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(outStream.pos < finishedOctetCount)
+
+    return play(octets, outStream.pos, values, fixture.type, fixture.memory);
+}
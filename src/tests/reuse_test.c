@@ -0,0 +1,120 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <string.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-runtime/types.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+/// `pos.y`, the items of `ar` and the Just value differ from the fixture, the counts and variants do not.
+static const char* movedCoolYaml = "%YAML 1.2\n---\na: true\nname: hello\npos:\n  x: 10\n  y: 7\nar:\n  - x: 1\n"
+                                   "    y: 2\n  - x: 3\n    y: 4\nma: Just 5\nti: >\n  1234567890abcdefghij\n";
+
+/// `ar` has another count, `ma` another variant, `name` and `ti` other octets.
+static const char* reshapedCoolYaml = "%YAML 1.2\n---\na: true\nname: world\npos:\n  x: 10\n  y: 7\nar:\n"
+                                      "  - x: 1\n    y: 2\nma: Not\nti: >\n  abcdefghij\n";
+
+typedef struct CoolPointers {
+    const void* name;
+    const void* ar;
+    const void* ti;
+} CoolPointers;
+
+static const void* pointerField(const SwtiType* type, const void* value, const char* name)
+{
+    const SwtiRecordType* record = (const SwtiRecordType*) swtiUnalias(type);
+    for (size_t i = 0; i < record->fieldCount; ++i) {
+        if (strcmp(record->fields[i].name, name) == 0) {
+            return *(const void* const*) ((const uint8_t*) value + record->fields[i].memoryOffsetInfo.memoryOffset);
+        }
+    }
+
+    return 0;
+}
+
+static CoolPointers pointersOf(const SwtiType* type, const void* value)
+{
+    CoolPointers pointers = {pointerField(type, value, "name"), pointerField(type, value, "ar"),
+                             pointerField(type, value, "ti")};
+    return pointers;
+}
+
+/// Decodes `value` on top of `target` and returns the number of octets that the decode allocated in `allocated`.
+static int reuse(const void* value, const SwtiType* type, void* target, SwampDynamicMemory* memory,
+                 size_t* allocated)
+{
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, value, type) == 0)
+
+    const uint8_t* before = memory->p;
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctetsReuse(&inStream, type, 0, 0, target, memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(inStream.pos == outStream.pos)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(value, target, type))
+    *allocated = (size_t) (memory->p - before);
+
+    return 0;
+}
+
+int swampDumpTestReuse(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* moved = swampDumpTestValueFromYaml(movedCoolYaml, fixture.type, fixture.memory);
+    const void* reshaped = swampDumpTestValueFromYaml(reshapedCoolYaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(moved != 0 && reshaped != 0)
+
+    // A zeroed target has nothing to reuse
+    size_t memorySize = swtiGetMemorySize(fixture.type);
+    void* target = swampDynamicMemoryAlloc(fixture.memory, 1, memorySize);
+    memset(target, 0, memorySize);
+    size_t allocated;
+    if (reuse(fixture.value, fixture.type, target, fixture.memory, &allocated) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(allocated > 0)
+    CoolPointers first = pointersOf(fixture.type, target);
+
+    // The same value again allocates nothing
+    if (reuse(fixture.value, fixture.type, target, fixture.memory, &allocated) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(allocated == 0)
+
+    // Items change in place while the counts and variants stay the same
+    if (reuse(moved, fixture.type, target, fixture.memory, &allocated) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(allocated == 0)
+    CoolPointers kept = pointersOf(fixture.type, target);
+    SWAMP_DUMP_TEST_CHECK(kept.name == first.name && kept.ar == first.ar && kept.ti == first.ti)
+
+    // Only what changed shape is allocated again
+    if (reuse(reshaped, fixture.type, target, fixture.memory, &allocated) < 0) {
+        return -1;
+    }
+    SWAMP_DUMP_TEST_CHECK(allocated > 0)
+    CoolPointers changed = pointersOf(fixture.type, target);
+    SWAMP_DUMP_TEST_CHECK(changed.name != first.name && changed.ar != first.ar && changed.ti != first.ti)
+
+    // Back to Just, the parameter of the new variant must be read, not taken from before
+    if (reuse(moved, fixture.type, target, fixture.memory, &allocated) < 0) {
+        return -1;
+    }
+    CoolPointers again = pointersOf(fixture.type, target);
+    SWAMP_DUMP_TEST_CHECK(again.ar != changed.ar)
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/store.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+/// Only the name differs from the fixture, so every sub-value can be shared with it.
+static const char* renamedCoolYaml = "%YAML 1.2\n---\na: true\nname: world\npos:\n  x: 10\n  y: 120\nar:\n  - x: 11\n"
+                                     "    y: 121\n  - x: 12\n    y: 122\nma: Just 99\nti: >\n  1234567890abcdefghij\n";
+
+static int readBack(const SwampDumpStore* store, uint64_t rootHash, const void* expected, const SwtiType* type,
+                    SwampDynamicMemory* memory)
+{
+    void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreRead(store, rootHash, type, decoded, memory) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(expected, decoded, type))
+
+    return 0;
+}
+
+static int writeAndRead(SwampDumpStore* store, const void* value, const void* renamed, const SwtiType* type,
+                        SwampDynamicMemory* memory)
+{
+    uint64_t rootHash;
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreWrite(store, value, type, &rootHash) == 0)
+    SWAMP_DUMP_TEST_CHECK(store->chunkCount > 1)
+    if (readBack(store, rootHash, value, type, memory) < 0) {
+        return -1;
+    }
+
+    size_t chunkCount = store->chunkCount;
+    uint64_t sameHash;
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreWrite(store, value, type, &sameHash) == 0)
+    SWAMP_DUMP_TEST_CHECK(sameHash == rootHash)
+    SWAMP_DUMP_TEST_CHECK(store->chunkCount == chunkCount)
+
+    uint64_t renamedHash;
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreWrite(store, renamed, type, &renamedHash) == 0)
+    SWAMP_DUMP_TEST_CHECK(renamedHash != rootHash)
+    SWAMP_DUMP_TEST_CHECK(store->chunkCount == chunkCount + 1)
+    if (readBack(store, renamedHash, renamed, type, memory) < 0) {
+        return -1;
+    }
+
+    // The chunks are persisted and loaded into a store of their own
+    SwampDumpStore loaded;
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreInit(&loaded, 4, store->threshold) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreRead(&loaded, rootHash, type, swampDynamicMemoryAlloc(memory, 1,
+                                             swtiGetMemorySize(type)), memory) < 0)
+    for (size_t i = 0; i < store->capacity; ++i) {
+        const SwampDumpStoreChunk* chunk = &store->chunks[i];
+        if (chunk->octets != 0) {
+            SWAMP_DUMP_TEST_CHECK(swampDumpStoreAdd(&loaded, chunk->hash, chunk->octets, chunk->octetCount) == 0)
+        }
+    }
+    SWAMP_DUMP_TEST_CHECK(loaded.chunkCount == store->chunkCount)
+    int result = readBack(&loaded, rootHash, value, type, memory);
+    swampDumpStoreDestroy(&loaded);
+
+    return result;
+}
+
+/// The threshold decides which sub-values become chunks, so it is part of every key.
+static int thresholdChangesKeys(const void* value, const SwtiType* type)
+{
+    SwampDumpStore store;
+    SwampDumpStore other;
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreInit(&store, 4, 12) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreInit(&other, 4, 13) == 0)
+
+    uint64_t rootHash = 0;
+    uint64_t otherRootHash = 0;
+    int result = swampDumpStoreWrite(&store, value, type, &rootHash);
+    if (result == 0) {
+        result = swampDumpStoreWrite(&other, value, type, &otherRootHash);
+    }
+    swampDumpStoreDestroy(&other);
+    swampDumpStoreDestroy(&store);
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+    SWAMP_DUMP_TEST_CHECK(rootHash != otherRootHash)
+
+    return 0;
+}
+
+int swampDumpTestStore(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+    const void* renamed = swampDumpTestValueFromYaml(renamedCoolYaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(renamed != 0)
+
+    SwampDumpStore store;
+    SWAMP_DUMP_TEST_CHECK(swampDumpStoreInit(&store, 4, 12) == 0)
+    int result = writeAndRead(&store, fixture.value, renamed, fixture.type, fixture.memory);
+    swampDumpStoreDestroy(&store);
+    if (result < 0) {
+        return result;
+    }
+
+    return thresholdChangesKeys(fixture.value, fixture.type);
+}
@@ -0,0 +1,33 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_TESTS_H
+#define SWAMP_DUMP_TESTS_H
+
+struct SwtiChunk;
+
+/// Each test returns 0 on success and a negative value after reporting the first failed check.
+int swampDumpTestOctets(const struct SwtiChunk* chunk);
+int swampDumpTestCodegen(const struct SwtiChunk* chunk);
+int swampDumpTestHash(const struct SwtiChunk* chunk);
+int swampDumpTestYaml(const struct SwtiChunk* chunk);
+int swampDumpTestEntropy(const struct SwtiChunk* chunk);
+int swampDumpTestMigrate(const struct SwtiChunk* chunk);
+int swampDumpTestDirty(const struct SwtiChunk* chunk);
+int swampDumpTestBits(const struct SwtiChunk* chunk);
+int swampDumpTestStore(const struct SwtiChunk* chunk);
+int swampDumpTestQuery(const struct SwtiChunk* chunk);
+int swampDumpTestPatch(const struct SwtiChunk* chunk);
+int swampDumpTestProjection(const struct SwtiChunk* chunk);
+int swampDumpTestBake(const struct SwtiChunk* chunk);
+int swampDumpTestReplay(const struct SwtiChunk* chunk);
+int swampDumpTestWalk(const struct SwtiChunk* chunk);
+int swampDumpTestDescriptor(const struct SwtiChunk* chunk);
+int swampDumpTestReuse(const struct SwtiChunk* chunk);
+int swampDumpTestAscii(const struct SwtiChunk* chunk);
+int swampDumpTestFormat(const struct SwtiChunk* chunk);
+int swampDumpTestLogRing(const struct SwtiChunk* chunk);
+int swampDumpTestDiff(const struct SwtiChunk* chunk);
+
+#endif
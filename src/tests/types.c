@@ -0,0 +1,180 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "types.h"
+
+#include <clog/clog.h>
+#include <flood/in_stream.h>
+#include <stdio.h>
+#include <string.h>
+#include <swamp-dump/dump_yaml.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/deserialize.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+const uint8_t swampDumpTestTypeOctets[] = {
+    0, // Major
+    1, // Minor
+    3, // Patch
+    0x0b, // Types that follow
+    SwtiTypeInt,
+    SwtiTypeList,
+    0x05,
+    SwtiTypeArray,
+    0x05,
+    SwtiTypeAlias,
+    0x4,
+    'C',
+    'o',
+    'o',
+    'l',
+    4,
+    SwtiTypeRecord,
+    6,
+    1,
+    'a',
+    9,
+    4,
+    'n',
+    'a',
+    'm',
+    'e',
+    6,
+    3,
+    'p',
+    'o',
+    's',
+    5,
+    2,
+    'a',
+    'r',
+    1,
+    2,
+    'm',
+    'a',
+    8,
+    2,
+    't',
+    'i',
+    10,
+    SwtiTypeRecord,
+    2,
+    1,
+    'x',
+    0,
+    1,
+    'y',
+    0,
+    SwtiTypeString,
+    SwtiTypeFunction,
+    2,
+    1,
+    2,
+    SwtiTypeCustom,
+    5,
+    'M',
+    'a',
+    'y',
+    'b',
+    'e',
+    2,
+    3,
+    'N',
+    'o',
+    't',
+    0,
+    4,
+    'J',
+    'u',
+    's',
+    't',
+    1,
+    0,
+    SwtiTypeBoolean,
+    SwtiTypeBlob
+};
+
+const size_t swampDumpTestTypeOctetCount = sizeof(swampDumpTestTypeOctets);
+
+const char* swampDumpTestCoolYaml = "%YAML 1.2\n---\na: true\nname: hello\npos:\n  x: 10\n  y: 120\nar:\n  - x: 11\n"
+                                    "    y: 121\n  - x: 12\n    y: 122\nma: Just 99\nti: >\n  1234567890abcdefghij\n";
+
+int swampDumpTestTypes(SwtiChunk* chunk)
+{
+    int error = swtiDeserialize(swampDumpTestTypeOctets, swampDumpTestTypeOctetCount, chunk);
+    if (error < 0) {
+        CLOG_ERROR("deserialize problem")
+        return error;
+    }
+
+    return 0;
+}
+
+void* swampDumpTestValueFromYaml(const char* yaml, const SwtiType* type, SwampDynamicMemory* memory)
+{
+    void* value = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+    FldInStream inStream;
+
+    fldInStreamInit(&inStream, (const uint8_t*) yaml, strlen(yaml));
+    if (swampDumpFromYaml(&inStream, type, memory, value) < 0) {
+        fprintf(stderr, "could not read test value as '%s':\n%s\n", type->name, yaml);
+        return 0;
+    }
+
+    return value;
+}
+
+int swampDumpTestFixtureInit(SwampDumpTestFixture* self, const SwtiChunk* chunk)
+{
+    static uint8_t memoryOctets[256 * 1024];
+    static SwampDynamicMemory memory;
+
+    swampDynamicMemoryInit(&memory, memoryOctets, sizeof(memoryOctets));
+    self->memory = &memory;
+    self->type = chunk->types[SWAMP_DUMP_TEST_TYPE_COOL];
+    self->value = swampDumpTestValueFromYaml(swampDumpTestCoolYaml, self->type, &memory);
+
+    return self->value == 0 ? -1 : 0;
+}
+
+int swampDumpTestDeepTypes(SwtiChunk* chunk, size_t depth, uint8_t innermostKind)
+{
+    uint8_t octets[5 + SWAMP_DUMP_TEST_MAX_DEEP_DEPTH * 5];
+    size_t count = 0;
+
+    if (depth > SWAMP_DUMP_TEST_MAX_DEEP_DEPTH) {
+        return -1;
+    }
+    octets[count++] = 0;
+    octets[count++] = 1;
+    octets[count++] = 3;
+    octets[count++] = (uint8_t) (1 + depth);
+    octets[count++] = innermostKind;
+    for (size_t i = 0; i < depth; ++i) {
+        octets[count++] = SwtiTypeRecord;
+        octets[count++] = 1;
+        octets[count++] = 1;
+        octets[count++] = 'f';
+        octets[count++] = (uint8_t) i;
+    }
+
+    return swtiDeserialize(octets, count, chunk);
+}
+
+const char* swampDumpTestDeepYaml(size_t depth, int32_t innermost)
+{
+    static char yaml[32 + SWAMP_DUMP_TEST_MAX_DEEP_DEPTH * (2 * SWAMP_DUMP_TEST_MAX_DEEP_DEPTH + 4) + 12];
+
+    if (depth == 0 || depth > SWAMP_DUMP_TEST_MAX_DEEP_DEPTH) {
+        return 0;
+    }
+    size_t length = (size_t) snprintf(yaml, sizeof(yaml), "%%YAML 1.2\n---\n");
+    for (size_t i = 0; i + 1 < depth; ++i) {
+        length += (size_t) snprintf(yaml + length, sizeof(yaml) - length, "%*sf:\n", (int) (i * 2), "");
+    }
+    snprintf(yaml + length, sizeof(yaml) - length, "%*sf: %d\n", (int) ((depth - 1) * 2), "", innermost);
+
+    return yaml;
+}
@@ -0,0 +1,59 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#ifndef SWAMP_DUMP_TEST_TYPES_H
+#define SWAMP_DUMP_TEST_TYPES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+struct SwtiChunk;
+struct SwtiType;
+struct SwampDynamicMemory;
+
+/// The serialized type information the tests run on. CMakeLists.txt also feeds it to swamp_dump_codegen, so the
+/// generated serializers are made from the very same types.
+extern const uint8_t swampDumpTestTypeOctets[];
+extern const size_t swampDumpTestTypeOctetCount;
+
+/// Indices into the chunk.
+#define SWAMP_DUMP_TEST_TYPE_INT (0)
+#define SWAMP_DUMP_TEST_TYPE_POSITION_LIST (1)
+#define SWAMP_DUMP_TEST_TYPE_COOL (3)
+#define SWAMP_DUMP_TEST_TYPE_POSITION (5)
+#define SWAMP_DUMP_TEST_TYPE_MAYBE (8)
+
+/// A value of the Cool record that touches every type in the chunk.
+extern const char* swampDumpTestCoolYaml;
+
+int swampDumpTestTypes(struct SwtiChunk* chunk);
+
+/// Records nested `depth` levels deep, each with the single field `f`, with a scalar of `innermostKind` at the bottom.
+/// `chunk->types[depth]` is the outermost record.
+#define SWAMP_DUMP_TEST_MAX_DEEP_DEPTH (64)
+int swampDumpTestDeepTypes(struct SwtiChunk* chunk, size_t depth, uint8_t innermostKind);
+/// A value of the Int variant of those records. The text is overwritten by the next call.
+const char* swampDumpTestDeepYaml(size_t depth, int32_t innermost);
+
+/// The Cool fixture value, read into memory that every test shares. Each init starts over, so the values of the
+/// previous test are gone.
+typedef struct SwampDumpTestFixture {
+    struct SwampDynamicMemory* memory;
+    const struct SwtiType* type;
+    const void* value;
+} SwampDumpTestFixture;
+
+int swampDumpTestFixtureInit(SwampDumpTestFixture* self, const struct SwtiChunk* chunk);
+
+/// Values are always built from YAML, so the tests never depend on the memory layout of the types.
+void* swampDumpTestValueFromYaml(const char* yaml, const struct SwtiType* type, struct SwampDynamicMemory* memory);
+
+#define SWAMP_DUMP_TEST_CHECK(condition)                                                                               \
+    if (!(condition)) {                                                                                                \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);                                 \
+        return -1;                                                                                                     \
+    }
+
+#endif
@@ -0,0 +1,119 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <flood/out_stream.h>
+#include <swamp-dump/dump.h>
+#include <swamp-dump/hash.h>
+#include <swamp-dump/walk.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+/// Deeper than the frames that the callers keep on their stacks.
+#define WALK_TEST_DEPTH (40)
+
+typedef struct WalkCounter {
+    size_t enterCount;
+    size_t leaveCount;
+    size_t maxDepth;
+    int32_t innermost;
+} WalkCounter;
+
+static int countScalar(void* self, SwampDumpWalkFrame* frame)
+{
+    ((WalkCounter*) self)->innermost = *(const SwampInt32*) frame->value;
+    return 0;
+}
+
+static int countEnter(void* self, SwampDumpWalkFrame* frame)
+{
+    WalkCounter* counter = (WalkCounter*) self;
+    counter->enterCount++;
+    if ((size_t) frame->indentation > counter->maxDepth) {
+        counter->maxDepth = (size_t) frame->indentation;
+    }
+
+    return 0;
+}
+
+static int countItem(void* self, SwampDumpWalkFrame* parent, SwampDumpWalkFrame* child)
+{
+    (void) self;
+
+    child->indentation = parent->indentation + 1;
+    return SwampDumpWalkContinue;
+}
+
+static int countLeave(void* self, SwampDumpWalkFrame* frame)
+{
+    (void) frame;
+
+    ((WalkCounter*) self)->leaveCount++;
+    return 0;
+}
+
+static const SwampDumpWalkVisitor walkCounter = {countScalar, countEnter, countItem, countLeave, 1};
+
+/// Starts with `capacity` frames on the stack, the rest of the walk has to move them to the heap.
+static int walk(const SwtiType* type, void* value, SwampDumpWalkFrame* frames, size_t capacity)
+{
+    WalkCounter counter = {0, 0, 0, 0};
+    SwampDumpWalker walker;
+    swampDumpWalkerInit(&walker, frames, capacity, &walkCounter, &counter);
+    int result = swampDumpWalk(&walker, type, value, 0, 0);
+    int ownsFrames = walker.ownsFrames;
+    size_t grownCapacity = walker.capacity;
+    swampDumpWalkerDestroy(&walker);
+
+    SWAMP_DUMP_TEST_CHECK(result == 0)
+    SWAMP_DUMP_TEST_CHECK(ownsFrames && grownCapacity >= WALK_TEST_DEPTH)
+    SWAMP_DUMP_TEST_CHECK(counter.enterCount == WALK_TEST_DEPTH && counter.leaveCount == WALK_TEST_DEPTH)
+    SWAMP_DUMP_TEST_CHECK(counter.maxDepth == WALK_TEST_DEPTH - 1)
+    SWAMP_DUMP_TEST_CHECK(counter.innermost == 42)
+
+    return 0;
+}
+
+static int walkDeep(const SwtiType* type, SwampDynamicMemory* memory)
+{
+    void* value = swampDumpTestValueFromYaml(swampDumpTestDeepYaml(WALK_TEST_DEPTH, 42), type, memory);
+    SWAMP_DUMP_TEST_CHECK(value != 0)
+
+    SwampDumpWalkFrame frames[SWAMP_DUMP_WALK_INLINE_DEPTH];
+    if (walk(type, value, frames, SWAMP_DUMP_WALK_INLINE_DEPTH) < 0 || walk(type, value, 0, 0) < 0) {
+        return -1;
+    }
+
+    // The formats walk it too
+    uint8_t octets[256];
+    FldOutStream outStream;
+    fldOutStreamInit(&outStream, octets, sizeof(octets));
+    SWAMP_DUMP_TEST_CHECK(swampDumpToOctets(&outStream, value, type) == 0)
+    SWAMP_DUMP_TEST_CHECK(outStream.pos == 3 + 4)
+
+    void* decoded = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+    FldInStream inStream;
+    fldInStreamInit(&inStream, octets, outStream.pos);
+    SWAMP_DUMP_TEST_CHECK(swampDumpFromOctets(&inStream, type, 0, 0, decoded, memory, 0) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(value, decoded, type))
+
+    return 0;
+}
+
+int swampDumpTestWalk(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    SwtiChunk deepChunk;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestDeepTypes(&deepChunk, WALK_TEST_DEPTH, SwtiTypeInt) == 0)
+    int result = walkDeep(deepChunk.types[WALK_TEST_DEPTH], fixture.memory);
+    swtiChunkDestroy(&deepChunk);
+
+    return result;
+}
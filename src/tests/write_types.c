@@ -0,0 +1,46 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "types.h"
+
+#include <clog/clog.h>
+#include <string.h>
+
+clog_config g_clog;
+
+static int writeFile(const char* filename, const void* octets, size_t octetCount)
+{
+    FILE* fp = fopen(filename, "wb");
+    if (fp == 0) {
+        fprintf(stderr, "could not open '%s'\n", filename);
+        return -1;
+    }
+
+    size_t writtenCount = fwrite(octets, 1, octetCount, fp);
+    if (fclose(fp) != 0 || writtenCount != octetCount) {
+        fprintf(stderr, "could not write '%s'\n", filename);
+        return -1;
+    }
+
+    return 0;
+}
+
+/// Writes the test types, and optionally the Cool fixture value, to files as input for swamp_dump_codegen.
+int main(int argc, const char* argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: swamp_dump_test_types <output.swti> [cool.yaml]\n");
+        return 1;
+    }
+
+    if (writeFile(argv[1], swampDumpTestTypeOctets, swampDumpTestTypeOctetCount) < 0) {
+        return 1;
+    }
+
+    if (argc > 2 && writeFile(argv[2], swampDumpTestCoolYaml, strlen(swampDumpTestCoolYaml)) < 0) {
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*---------------------------------------------------------------------------------------------
+ *  Copyright (c) Peter Bjorklund. All rights reserved.
+ *  Licensed under the MIT License. See LICENSE in the project root for license information.
+ *--------------------------------------------------------------------------------------------*/
+#include "tests.h"
+#include "types.h"
+
+#include <flood/in_stream.h>
+#include <string.h>
+#include <swamp-dump/dump_yaml.h>
+#include <swamp-dump/hash.h>
+#include <swamp-runtime/dynamic_memory.h>
+#include <swamp-typeinfo/chunk.h>
+#include <swamp-typeinfo/typeinfo.h>
+
+/// Longer than the 16 characters that the scanner looks at in one step.
+static const char* longNameCoolYaml = "%YAML 1.2\n---\na: true\nname: a_name_that_spans_several_scanner_steps\npos:\n"
+                                      "  x: 10\n  y: 120\nar:\n  - x: 11\n    y: 121\n  - x: 12\n    y: 122\n"
+                                      "ma: Just 99\nti: >\n  1234567890abcdefghij\n";
+
+static const char* oddIndentationCoolYaml = "%YAML 1.2\n---\na: true\nname: hello\npos:\n   x: 10\n   y: 120\nar:\n"
+                                            "  - x: 11\n    y: 121\nma: Just 99\nti: >\n  1234567890abcdefghij\n";
+
+static const char* tooDeepCoolYaml = "%YAML 1.2\n---\na: true\nname: hello\npos:\n    x: 10\n    y: 120\nar:\n"
+                                     "  - x: 11\n    y: 121\nma: Just 99\nti: >\n  1234567890abcdefghij\n";
+
+/// Returns the result of swampDumpFromYaml() and checks that everything was read when it succeeds.
+static int readYaml(const char* yaml, size_t length, const SwtiType* type, SwampDynamicMemory* memory, void* target)
+{
+    FldInStream inStream;
+    fldInStreamInit(&inStream, (const uint8_t*) yaml, length);
+    int result = swampDumpFromYaml(&inStream, type, memory, target);
+    if (result == 0 && inStream.pos != length) {
+        fprintf(stderr, "read %zu of %zu characters\n", inStream.pos, length);
+        return -99;
+    }
+
+    return result;
+}
+
+/// The same document with "\r\n" line ends, and without the final line end, must give the same value.
+static int lineEnds(const char* yaml, const SwtiType* type, SwampDynamicMemory* memory)
+{
+    static char crlf[2048];
+    size_t length = 0;
+    for (const char* p = yaml; *p != 0; ++p) {
+        SWAMP_DUMP_TEST_CHECK(length + 2 < sizeof(crlf))
+        if (*p == '\n') {
+            crlf[length++] = '\r';
+        }
+        crlf[length++] = *p;
+    }
+
+    const void* expected = swampDumpTestValueFromYaml(yaml, type, memory);
+    SWAMP_DUMP_TEST_CHECK(expected != 0)
+    void* value = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+    SWAMP_DUMP_TEST_CHECK(readYaml(crlf, length, type, memory, value) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(expected, value, type))
+    SWAMP_DUMP_TEST_CHECK(readYaml(crlf, length - 2, type, memory, value) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(expected, value, type))
+    SWAMP_DUMP_TEST_CHECK(readYaml(yaml, strlen(yaml) - 1, type, memory, value) == 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(expected, value, type))
+
+    return 0;
+}
+
+static int indentationErrors(const SwtiType* type, SwampDynamicMemory* memory)
+{
+    void* value = swampDynamicMemoryAlloc(memory, 1, swtiGetMemorySize(type));
+    SWAMP_DUMP_TEST_CHECK(readYaml(oddIndentationCoolYaml, strlen(oddIndentationCoolYaml), type, memory, value) < 0)
+    SWAMP_DUMP_TEST_CHECK(readYaml(tooDeepCoolYaml, strlen(tooDeepCoolYaml), type, memory, value) < 0)
+
+    return 0;
+}
+
+int swampDumpTestYaml(const SwtiChunk* chunk)
+{
+    SwampDumpTestFixture fixture;
+    SWAMP_DUMP_TEST_CHECK(swampDumpTestFixtureInit(&fixture, chunk) == 0)
+
+    static char yaml[4096];
+    SWAMP_DUMP_TEST_CHECK(swampDumpToYamlString(fixture.value, fixture.type, 0, yaml, sizeof(yaml)) != 0)
+    const void* readBack = swampDumpTestValueFromYaml(yaml, fixture.type, fixture.memory);
+    SWAMP_DUMP_TEST_CHECK(readBack != 0)
+    SWAMP_DUMP_TEST_CHECK(swampDumpEqual(fixture.value, readBack, fixture.type))
+
+    static char yamlAgain[4096];
+    SWAMP_DUMP_TEST_CHECK(swampDumpToYamlString(readBack, fixture.type, 0, yamlAgain, sizeof(yamlAgain)) != 0)
+    SWAMP_DUMP_TEST_CHECK(strcmp(yaml, yamlAgain) == 0)
+
+    SWAMP_DUMP_TEST_CHECK(swampDumpToYamlString(fixture.value, fixture.type, 0, yaml, 32) == 0)
+
+    if (lineEnds(swampDumpTestCoolYaml, fixture.type, fixture.memory) < 0 ||
+        lineEnds(longNameCoolYaml, fixture.type, fixture.memory) < 0) {
+        return -1;
+    }
+
+    return indentationErrors(fixture.type, fixture.memory);
+}